@@ -0,0 +1,345 @@
+/*
+  Kernel benchmark of the phase-field solver on the mesh of a pressurized
+  case (input/pressurized-*.prm): the case is set up as in
+  eaglefrac-pressurized (global and local prerefinement, initial defects,
+  pressure at the first time step) and the following kernels are timed
+  on the initial state:
+    residual  - assembly of the nonlinear residual
+    jacobian  - assembly of the Jacobian, including the AMG setup
+    active_set- active set computation
+    solve     - linear solve of one Newton step
+    jacobian_double, solve_double,
+    jacobian_single, solve_single
+              - the same with the AMG and with the single precision
+                block preconditioners ("Preconditioner precision"):
+                jacobian_* includes the preconditioner setup. A
+                solve_single that stalls falls back to double for the
+                remaining repetitions, see the iterations column
+  Each kernel runs n_repetitions times; the fastest repetition is
+  reported (time of the slowest process). Output is one CSV line per
+  kernel on stdout:
+    kernel,processes,threads,cells,dofs,seconds,cells_per_s,dofs_per_s,iterations
+  Usage: benchmark-kernels <file.prm> [-refine N] [-repeat N] [-threads N]
+    -refine: additional global refinement steps (default 0)
+ */
+#include <deal.II/base/multithread_info.h>
+#include <deal.II/base/utilities.h>
+#include <deal.II/grid/grid_in.h>
+#include <deal.II/numerics/vector_tools.h>
+
+#include <algorithm>    // std::min
+#include <chrono>
+#include <cmath>        // std::pow
+#include <fstream>
+#include <iostream>
+#include <limits>       // std::numeric_limits
+#include <list>
+#include <string>
+
+#include <PhaseFieldSolver.hpp>
+#include <PhaseFieldPressurizedData.hpp>
+#include <InitialValues.hpp>
+#include <Mesher.hpp>
+
+
+namespace Benchmark
+{
+  using namespace dealii;
+
+  template <int dim>
+  class KernelBenchmark
+  {
+  public:
+    KernelBenchmark(const std::string &input_file_name_);
+    void run(const int          n_refinement_steps,
+             const unsigned int n_repetitions,
+             const unsigned int n_threads);
+
+  private:
+    void setup();
+    void setup_pressure();
+    void impose_displacement();
+    template <typename Kernel>
+    void time_kernel(const std::string  &name,
+                     const unsigned int  n_repetitions,
+                     Kernel              kernel);
+
+    MPI_Comm mpi_communicator;
+    parallel::distributed::Triangulation<dim> triangulation;
+    DoFHandler<dim>                           pressure_dof_handler;
+    FESystem<dim>                             pressure_fe;
+    // solver messages go to a null stream
+    ConditionalOStream pcout;
+    TimerOutput        computing_timer;
+    InputData::PhaseFieldPressurizedData<dim> data;
+    PhaseField::PhaseFieldSolver<dim>         phase_field_solver;
+    std::string input_file_name;
+
+    TrilinosWrappers::MPI::BlockVector pressure_owned_solution,
+                                       pressure_relevant_solution;
+    std::pair<double,double> time_steps;
+  };
+
+
+  template <int dim>
+  KernelBenchmark<dim>::KernelBenchmark(const std::string &input_file_name_)
+  :
+  mpi_communicator(MPI_COMM_WORLD),
+  triangulation(mpi_communicator,
+                typename Triangulation<dim>::MeshSmoothing
+                (Triangulation<dim>::smoothing_on_refinement |
+                 Triangulation<dim>::smoothing_on_coarsening)),
+  pressure_dof_handler(triangulation),
+  pressure_fe(FE_Q<dim>(1), 1),
+  pcout(std::cout, false),
+  computing_timer(mpi_communicator, pcout,
+                  TimerOutput::never,
+                  TimerOutput::wall_times),
+  data(pcout),
+  phase_field_solver(mpi_communicator,
+                     triangulation, data,
+                     pcout, computing_timer),
+  input_file_name(input_file_name_)
+  {}
+
+
+  template <int dim>
+  void KernelBenchmark<dim>::setup_pressure()
+  {
+    pressure_dof_handler.distribute_dofs(pressure_fe);
+    IndexSet locally_relevant_pressure_dofs;
+    DoFTools::extract_locally_relevant_dofs(pressure_dof_handler,
+                                            locally_relevant_pressure_dofs);
+    std::vector<IndexSet>
+      owned_partitioning(1, pressure_dof_handler.locally_owned_dofs()),
+      relevant_partitioning(1, locally_relevant_pressure_dofs);
+    pressure_relevant_solution.reinit(relevant_partitioning, mpi_communicator);
+    pressure_owned_solution.reinit(owned_partitioning, mpi_communicator);
+  }  // eom
+
+
+  template <int dim>
+  void KernelBenchmark<dim>::impose_displacement()
+  {
+    // boundary values at the first time step
+    const double time = time_steps.first;
+    std::vector<double> displacement_values(data.displacement_boundary_values);
+    std::vector<double>
+      displacement_point_values(data.displacement_points.size());
+    for (unsigned int i=0; i<displacement_point_values.size(); ++i)
+      displacement_point_values[i] = data.displacement_point_velocities[i]*time;
+
+    phase_field_solver.impose_displacement(data.displacement_boundary_labels,
+                                           data.displacement_boundary_components,
+                                           displacement_values,
+                                           data.displacement_points,
+                                           data.displacement_point_components,
+                                           displacement_point_values,
+                                           data.constraint_point_phase_field);
+  }  // eom
+
+
+  template <int dim>
+  void KernelBenchmark<dim>::setup()
+  {
+    GridIn<dim> gridin;
+    gridin.attach_triangulation(triangulation);
+    std::ifstream f(data.mesh_file_name.c_str());
+    AssertThrow(f, ExcMessage("Can't read mesh file " + data.mesh_file_name));
+    gridin.read_msh(f);
+
+    double minimum_mesh_size =
+      Mesher::compute_minimum_mesh_size(triangulation, mpi_communicator);
+    const int max_refinement_level =
+      data.initial_refinement_level + data.n_adaptive_steps;
+    minimum_mesh_size /= std::pow(2, max_refinement_level);
+    data.compute_mesh_dependent_parameters(minimum_mesh_size);
+
+    triangulation.refine_global(data.initial_refinement_level);
+    for (int ref_step=0; ref_step<data.n_adaptive_steps; ++ref_step)
+      Mesher::refine_region(triangulation,
+                            data.local_prerefinement_region,
+                            1);
+    phase_field_solver.setup_dofs();
+    setup_pressure();
+
+    const FEValuesExtractors::Scalar pressure_extractor(0);
+    phase_field_solver.set_coupling(pressure_dof_handler,
+                                    pressure_fe,
+                                    pressure_extractor);
+    phase_field_solver.decompose_stress = 2;
+
+    VectorTools::interpolate
+      (phase_field_solver.dof_handler,
+       InitialValues::Defects<dim>(data.defect_coordinates,
+                                   2*minimum_mesh_size),
+       phase_field_solver.solution);
+
+    const double time_step = data.get_time_step(0);
+    time_steps = std::make_pair(time_step, time_step);
+    phase_field_solver.update_old_solution();
+    phase_field_solver.use_old_time_step_phi = true;
+
+    pressure_owned_solution = data.pressure_function.value(Point<1>(time_step));
+    pressure_relevant_solution = pressure_owned_solution;
+
+    impose_displacement();
+    phase_field_solver.relevant_solution = phase_field_solver.solution;
+  }  // eom
+
+
+  template <int dim>
+  template <typename Kernel>
+  void KernelBenchmark<dim>::time_kernel(const std::string  &name,
+                                         const unsigned int  n_repetitions,
+                                         Kernel              kernel)
+  {
+    double best = std::numeric_limits<double>::max();
+    unsigned int iterations = 0;
+    for (unsigned int r=0; r<n_repetitions; ++r)
+    {
+      MPI_Barrier(mpi_communicator);
+      const auto start = std::chrono::steady_clock::now();
+      iterations = kernel();
+      const double local_seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now()
+                                      - start).count();
+      best = std::min(best, Utilities::MPI::max(local_seconds,
+                                                mpi_communicator));
+    }
+
+    const double n_cells = triangulation.n_global_active_cells();
+    const double n_dofs = phase_field_solver.dof_handler.n_dofs();
+    if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
+      std::cout << name << ","
+                << Utilities::MPI::n_mpi_processes(mpi_communicator) << ","
+                << MultithreadInfo::n_threads() << ","
+                << n_cells << ","
+                << n_dofs << ","
+                << best << ","
+                << n_cells/best << ","
+                << n_dofs/best << ","
+                << iterations
+                << std::endl;
+  }  // eom
+
+
+  template <int dim>
+  void KernelBenchmark<dim>::run(const int          n_refinement_steps,
+                                 const unsigned int n_repetitions,
+                                 const unsigned int n_threads)
+  {
+    data.read_input_file(input_file_name);
+    if (n_threads > 0)
+      data.n_threads = n_threads;
+    MultithreadInfo::set_thread_limit(data.n_threads);
+    data.initial_refinement_level += n_refinement_steps;
+    setup();
+
+    if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
+      std::cout << "kernel,processes,threads,cells,dofs,seconds,"
+                << "cells_per_s,dofs_per_s,iterations" << std::endl;
+
+    time_kernel("residual", n_repetitions, [&]() -> unsigned int
+    {
+      phase_field_solver.assemble_coupled_system(phase_field_solver.solution,
+                                                 pressure_relevant_solution,
+                                                 time_steps,
+                                                 /*include_pressure = */ true,
+                                                 /*assemble_matrix = */ false);
+      return 0;
+    });
+    time_kernel("active_set", n_repetitions, [&]() -> unsigned int
+    {
+      phase_field_solver.compute_active_set(phase_field_solver.solution);
+      return phase_field_solver.active_set_size();
+    });
+    time_kernel("jacobian", n_repetitions, [&]() -> unsigned int
+    {
+      phase_field_solver.assemble_coupled_system(phase_field_solver.solution,
+                                                 pressure_relevant_solution,
+                                                 time_steps,
+                                                 /*include_pressure = */ true,
+                                                 /*assemble_matrix = */ true);
+      return 0;
+    });
+    // the system of the last Jacobian assembly
+    time_kernel("solve", n_repetitions, [&]() -> unsigned int
+    {
+      // GMRES starts from the update: same initial guess every time
+      phase_field_solver.solution_update = 0;
+      return phase_field_solver.solve();
+    });
+
+    // both preconditioner precisions on the same Jacobian
+    const bool precisions[] = {false, true};
+    for (const bool single : precisions)
+    {
+      const std::string suffix = single ? "_single" : "_double";
+      time_kernel("jacobian" + suffix, n_repetitions, [&]() -> unsigned int
+      {
+        phase_field_solver.set_preconditioner_precision(single);
+        phase_field_solver.assemble_coupled_system(phase_field_solver.solution,
+                                                   pressure_relevant_solution,
+                                                   time_steps,
+                                                   /*include_pressure = */ true,
+                                                   /*assemble_matrix = */ true);
+        return 0;
+      });
+      time_kernel("solve" + suffix, n_repetitions, [&]() -> unsigned int
+      {
+        phase_field_solver.solution_update = 0;
+        return phase_field_solver.solve();
+      });
+    }
+  }  // eom
+
+}  // end of namespace
+
+
+int main(int argc, char *argv[])
+{
+  try
+  {
+    using namespace dealii;
+    Utilities::MPI::MPI_InitFinalize mpi_initialization(argc, argv, 1);
+
+    std::string input_file_name;
+    int n_refinement_steps = 0;
+    unsigned int n_repetitions = 3, n_threads = 0;
+    std::list<std::string> args(argv + 1, argv + argc);
+    while (args.size())
+    {
+      const std::string arg = args.front();
+      args.pop_front();
+      if ((arg == "-refine" || arg == "-repeat" || arg == "-threads") &&
+          args.size())
+      {
+        const int value = Utilities::string_to_int(args.front());
+        args.pop_front();
+        if (arg == "-refine")
+          n_refinement_steps = value;
+        else if (arg == "-repeat")
+          n_repetitions = std::max(value, 1);
+        else
+          n_threads = value;
+      }
+      else
+        input_file_name = arg;
+    }
+    AssertThrow(!input_file_name.empty(),
+                ExcMessage("Usage: benchmark-kernels <file.prm> "
+                           "[-refine N] [-repeat N] [-threads N]"));
+
+    Benchmark::KernelBenchmark<2> benchmark(input_file_name);
+    benchmark.run(n_refinement_steps, n_repetitions, n_threads);
+    return 0;
+  }
+  catch (std::exception &exc)
+  {
+    std::cerr << "Exception on processing: " << std::endl
+              << exc.what() << std::endl
+              << "Aborting!" << std::endl;
+    return 1;
+  }
+}
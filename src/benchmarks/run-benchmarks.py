@@ -0,0 +1,275 @@
+#!/usr/bin/env python3
+"""
+Benchmark suite: scaled variants of the input/ cases and the kernel
+micro-benchmarks, run for a list of process counts.
+
+Each case is run in small/medium/large variants (0, 1, 2 extra global
+refinement steps) with the end time cut to a few time steps. The runs
+write their performance.csv (see PerformanceLog.hpp), from which the
+script reports
+  throughput      - cell updates (active cells x Newton steps) and dof
+                    updates per second of the solid phase
+  strong scaling  - speedup and efficiency of each variant over the
+                    process counts
+  weak scaling    - variant i on processes[i] (4x cells per level in 2d)
+All results are also written to <output>/results.csv and kernels.csv,
+which can be kept as the baseline of later runs (--baseline).
+
+Usage (from the build directory, or through `make bench`):
+  run-benchmarks.py --build-dir . --source-dir .. [--processes 1,2,4]
+                    [--sizes small,medium] [--cases sneddon,one_frac]
+                    [--baseline old/results.csv]
+"""
+import argparse
+import csv
+import os
+import re
+import shutil
+import subprocess
+import sys
+import time
+
+# driver, input file, end time of the benchmark runs (None = as in the file)
+CASES = {
+    "sneddon":             ("eaglefrac-pressurized",
+                            "input/pressurized-sneddon.prm", None),
+    "pressurized_one_frac": ("eaglefrac-pressurized",
+                            "input/pressurized-one_frac.prm", "0.05"),
+    "one_frac":            ("eaglefrac-fluid",
+                            "input/fluid-one_frac.prm", "0.5"),
+    # the solid driver is not built by default
+    "three_point_bending": ("eaglefrac-solid",
+                            "input/solid-three_point_bending.prm", "5e-4"),
+}
+SIZES = {"small": 0, "medium": 1, "large": 2}
+
+
+def make_input(source_dir, case, size, output_dir):
+    """scaled copy of the input file, returns its path"""
+    _, input_file, t_max = CASES[case]
+    with open(os.path.join(source_dir, input_file)) as f:
+        text = f.read()
+
+    def refine(match):
+        return match.group(1) + str(int(match.group(2)) + SIZES[size])
+    text = re.sub(r"(set Initial global refinement steps\s*=\s*)(\d+)",
+                  refine, text)
+    # mesh files are given relative to the source directory
+    text = re.sub(r"(set Mesh file\s*=\s*)(\S+)",
+                  lambda m: m.group(1) + os.path.join(source_dir, m.group(2)),
+                  text)
+    if t_max is not None:
+        text = re.sub(r"(set T max\s*=\s*)(\S+)",
+                      lambda m: m.group(1) + t_max, text)
+
+    name = "%s-%s.prm" % (case, size)
+    path = os.path.join(output_dir, name)
+    with open(path, "w") as f:
+        f.write(text)
+    return path
+
+
+def mpi_command(mpirun, processes, command):
+    if processes == 1 and not mpirun:
+        return command
+    return mpirun.split() + [str(processes)] + command
+
+
+def read_performance(path):
+    """totals of a performance.csv"""
+    totals = {"steps": 0, "solid_time": 0.0, "cell_updates": 0.0,
+              "dof_updates": 0.0, "cells": 0, "dofs": 0}
+    with open(path) as f:
+        for row in csv.DictReader(f):
+            newton = float(row["newton_steps"])
+            totals["steps"] += 1
+            totals["solid_time"] += float(row["solid_max"])
+            totals["cell_updates"] += newton*float(row["active_cells"])
+            totals["dof_updates"] += newton*float(row["solid_dofs"])
+            totals["cells"] = int(float(row["active_cells"]))
+            totals["dofs"] = int(float(row["solid_dofs"]))
+    return totals
+
+
+def run_case(args, case, size, processes):
+    driver = os.path.join(args.build_dir, CASES[case][0])
+    if not os.path.exists(driver):
+        print("  %s not built, skipping %s" % (CASES[case][0], case))
+        return None
+    run_dir = os.path.join(args.output, "%s-%s-np%d" % (case, size, processes))
+    if os.path.isdir(run_dir):
+        shutil.rmtree(run_dir)
+    os.makedirs(run_dir)
+    input_file = make_input(args.source_dir, case, size, run_dir)
+
+    command = mpi_command(args.mpirun, processes,
+                          [driver, input_file, "-threads", str(args.threads)])
+    start = time.time()
+    with open(os.path.join(run_dir, "log.txt"), "w") as log:
+        status = subprocess.call(command, cwd=run_dir, stdout=log,
+                                 stderr=subprocess.STDOUT)
+    wall_time = time.time() - start
+    if status != 0:
+        print("  %s failed, see %s/log.txt" % (" ".join(command), run_dir))
+        return None
+
+    case_name = os.path.splitext(os.path.basename(input_file))[0]
+    totals = read_performance(os.path.join(run_dir, case_name,
+                                           "performance.csv"))
+    totals.update({"case": case, "size": size, "processes": processes,
+                   "wall_time": wall_time})
+    return totals
+
+
+def run_kernels(args, case, size, processes, writer):
+    benchmark = os.path.join(args.build_dir, "benchmark-kernels")
+    if not os.path.exists(benchmark) or CASES[case][0] != "eaglefrac-pressurized":
+        return
+    run_dir = os.path.join(args.output, "%s-%s-np%d" % (case, size, processes))
+    if not os.path.isdir(run_dir):
+        os.makedirs(run_dir)
+    input_file = make_input(args.source_dir, case, size, run_dir)
+    command = mpi_command(args.mpirun, processes,
+                          [benchmark, input_file, "-threads", str(args.threads)])
+    try:
+        output = subprocess.check_output(command, cwd=run_dir,
+                                         universal_newlines=True)
+    except subprocess.CalledProcessError:
+        print("  %s failed" % " ".join(command))
+        return
+    lines = [l for l in output.splitlines() if l.count(",") == 8]
+    for row in csv.DictReader(lines):
+        row.update({"case": case, "size": size})
+        writer.writerow(row)
+        print("  %-10s %-12s np=%-3d %12.4g s %12.4g cells/s %12.4g dofs/s"
+              % (row["kernel"], case + "-" + size, processes,
+                 float(row["seconds"]), float(row["cells_per_s"]),
+                 float(row["dofs_per_s"])))
+
+
+def print_tables(results, processes, sizes, baseline):
+    print("\nThroughput (solid phase)")
+    print("%-28s %4s %10s %10s %10s %14s %14s %8s" %
+          ("case", "np", "cells", "dofs", "wall [s]", "cells/s", "dofs/s",
+           "vs base"))
+    for r in results:
+        cells_per_s = r["cell_updates"]/max(r["solid_time"], 1e-300)
+        dofs_per_s = r["dof_updates"]/max(r["solid_time"], 1e-300)
+        key = (r["case"], r["size"], str(r["processes"]))
+        ratio = ""
+        if key in baseline and baseline[key] > 0:
+            ratio = "%.2fx" % (baseline[key]/r["wall_time"])
+        print("%-28s %4d %10d %10d %10.2f %14.4g %14.4g %8s" %
+              (r["case"] + "-" + r["size"], r["processes"], r["cells"],
+               r["dofs"], r["wall_time"], cells_per_s, dofs_per_s, ratio))
+
+    by_key = dict(((r["case"], r["size"], r["processes"]), r) for r in results)
+    cases = sorted(set(r["case"] for r in results))
+
+    print("\nStrong scaling (wall time, speedup, efficiency)")
+    for case in cases:
+        for size in sizes:
+            base = by_key.get((case, size, processes[0]))
+            if base is None:
+                continue
+            line = "%-28s" % (case + "-" + size)
+            for p in processes:
+                r = by_key.get((case, size, p))
+                if r is None:
+                    line += "  np=%d: -" % p
+                    continue
+                speedup = base["wall_time"]/r["wall_time"]
+                line += "  np=%d: %.2fs %.2fx %3.0f%%" % \
+                    (p, r["wall_time"], speedup,
+                     100*speedup*processes[0]/p)
+            print(line)
+
+    print("\nWeak scaling (size i on processes[i])")
+    for case in cases:
+        base = by_key.get((case, sizes[0], processes[0]))
+        if base is None:
+            continue
+        line = "%-28s" % case
+        for size, p in zip(sizes, processes):
+            r = by_key.get((case, size, p))
+            if r is None:
+                continue
+            line += "  %s np=%d: %.2fs %3.0f%%" % \
+                (size, p, r["wall_time"], 100*base["wall_time"]/r["wall_time"])
+        print(line)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--build-dir", default=".")
+    parser.add_argument("--source-dir", default="..")
+    parser.add_argument("--output", default=None,
+                        help="result directory (default <build-dir>/bench)")
+    parser.add_argument("--processes", default="1,2,4")
+    parser.add_argument("--sizes", default="small,medium,large")
+    parser.add_argument("--cases", default="sneddon,one_frac,three_point_bending")
+    parser.add_argument("--threads", type=int, default=1)
+    parser.add_argument("--mpirun", default="mpirun -np")
+    parser.add_argument("--baseline", default=None,
+                        help="results.csv of an earlier run")
+    parser.add_argument("--no-kernels", action="store_true")
+    args = parser.parse_args()
+
+    args.build_dir = os.path.abspath(args.build_dir)
+    args.source_dir = os.path.abspath(args.source_dir)
+    args.output = os.path.abspath(args.output or
+                                  os.path.join(args.build_dir, "bench"))
+    if not os.path.isdir(args.output):
+        os.makedirs(args.output)
+    processes = [int(p) for p in args.processes.split(",")]
+    sizes = args.sizes.split(",")
+    cases = args.cases.split(",")
+    for case in cases:
+        if case not in CASES:
+            sys.exit("unknown case %s, choose from %s" %
+                     (case, ", ".join(sorted(CASES))))
+
+    baseline = {}
+    if args.baseline:
+        with open(args.baseline) as f:
+            for row in csv.DictReader(f):
+                baseline[(row["case"], row["size"], row["processes"])] = \
+                    float(row["wall_time"])
+
+    split_benchmark = os.path.join(args.build_dir, "benchmark-split-policies")
+    if not args.no_kernels and os.path.exists(split_benchmark):
+        print("Stress split kernels")
+        subprocess.call([split_benchmark])
+
+    results = []
+    kernel_file = open(os.path.join(args.output, "kernels.csv"), "w")
+    kernel_writer = csv.DictWriter(kernel_file,
+                                   ["case", "size", "kernel", "processes",
+                                    "threads", "cells", "dofs", "seconds",
+                                    "cells_per_s", "dofs_per_s", "iterations"])
+    kernel_writer.writeheader()
+    for case in cases:
+        for size in sizes:
+            for p in processes:
+                print("%s-%s on %d processes" % (case, size, p))
+                if not args.no_kernels:
+                    run_kernels(args, case, size, p, kernel_writer)
+                r = run_case(args, case, size, p)
+                if r is not None:
+                    results.append(r)
+    kernel_file.close()
+
+    fields = ["case", "size", "processes", "wall_time", "steps", "cells",
+              "dofs", "solid_time", "cell_updates", "dof_updates"]
+    with open(os.path.join(args.output, "results.csv"), "w") as f:
+        writer = csv.DictWriter(f, fields)
+        writer.writeheader()
+        for r in results:
+            writer.writerow(dict((k, r[k]) for k in fields))
+
+    print_tables(results, processes, sizes, baseline)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,122 @@
+/*
+  Micro-benchmark of the stress split policies of the phase-field assembly.
+  For a set of random cells (2d, Q1 displacement, QGauss(3)) it times the
+  split stresses in all quadrature points plus the stress derivatives of
+  all displacement shape functions, i.e. the split work of assembling the
+  Jacobian of one cell.
+  Usage: benchmark-split-policies [n_cells]
+ */
+#include <deal.II/base/tensor.h>
+
+#include <chrono>
+#include <cstdlib>      // std::atoi, std::rand
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <SplitPolicies.hpp>
+
+
+namespace Benchmark
+{
+  using namespace dealii;
+
+  const int          dim = 2;
+  const unsigned int n_q_points = 9;
+  const unsigned int n_u_dofs = 8;
+  const double       lame_constant = 1e10, shear_modulus = 1e10;
+
+  double random_value()
+  {
+    return 2.0*std::rand()/RAND_MAX - 1.0;
+  }  // eom
+
+
+  Tensor<2,dim> random_strain()
+  {
+    Tensor<2,dim> eps;
+    eps[0][0] = 1e-3*random_value();
+    eps[1][1] = 1e-3*random_value();
+    eps[0][1] = eps[1][0] = 1e-3*random_value();
+    return eps;
+  }  // eom
+
+
+  template <typename Policy>
+  void run(const std::string                  &name,
+           const std::vector< Tensor<2,dim> > &strains,
+           const std::vector< Tensor<2,dim> > &eps_u)
+  {
+    ConstitutiveModel::EnergySpectralDecomposition<dim> decomposition;
+    ConstitutiveModel::BatchedSpectralSplit<dim>        batched_split;
+    std::vector< Tensor<2,dim> > cell_strains(n_q_points),
+                                 stress_plus(n_q_points),
+                                 stress_minus(n_q_points);
+    Tensor<2,dim> sigma_u_plus, sigma_u_minus;
+    const unsigned int n_cells = strains.size()/n_q_points;
+    double checksum = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned int c=0; c<n_cells; ++c)
+    {
+      for (unsigned int q=0; q<n_q_points; ++q)
+        cell_strains[q] = strains[c*n_q_points + q];
+
+      if (Policy::batched)
+        batched_split.evaluate(cell_strains, lame_constant, shear_modulus,
+                               stress_plus, stress_minus);
+      else
+        for (unsigned int q=0; q<n_q_points; ++q)
+          Policy::stress(decomposition, cell_strains[q],
+                         lame_constant, shear_modulus,
+                         stress_plus[q], stress_minus[q]);
+
+      for (unsigned int q=0; q<n_q_points; ++q)
+      {
+        checksum += stress_plus[q][0][0] + stress_minus[q][1][1];
+        for (unsigned int k=0; k<n_u_dofs; ++k)
+        {
+          Policy::derivative(decomposition, batched_split, q,
+                             cell_strains[q], eps_u[k],
+                             lame_constant, shear_modulus,
+                             sigma_u_plus, sigma_u_minus);
+          checksum += sigma_u_plus[0][1] + sigma_u_minus[0][0];
+        }
+      }
+    }  // end cell loop
+    const auto stop = std::chrono::steady_clock::now();
+
+    const double seconds = std::chrono::duration<double>(stop - start).count();
+    std::cout << std::setw(10) << name
+              << std::setw(14) << 1e9*seconds/n_cells << " ns/cell"
+              << std::setw(14) << n_cells/seconds << " cells/s"
+              << "   (checksum " << checksum << ")"
+              << std::endl;
+  }  // eom
+}  // end of namespace
+
+
+int main(int argc, char *argv[])
+{
+  using namespace Benchmark;
+  const unsigned int n_cells = (argc > 1) ? std::atoi(argv[1]) : 100000;
+
+  std::srand(1);
+  std::vector< Tensor<2,dim> > strains(n_cells*n_q_points);
+  for (auto & eps : strains)
+    eps = random_strain();
+  // symmetric gradients of vector-valued shape functions
+  std::vector< Tensor<2,dim> > eps_u(n_u_dofs);
+  for (auto & eps : eps_u)
+    eps = random_strain();
+
+  std::cout << "Split policies, " << n_cells << " cells, "
+            << n_q_points << " q points, "
+            << n_u_dofs << " displacement dofs per cell" << std::endl;
+  run< ConstitutiveModel::NoSplit<dim> >("none", strains, eps_u);
+  run< ConstitutiveModel::SimpleSplit<dim> >("simple", strains, eps_u);
+  run< ConstitutiveModel::SpectralSplit<dim> >("spectral", strains, eps_u);
+
+  return 0;
+}
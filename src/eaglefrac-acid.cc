@@ -1,4 +1,5 @@
 #include <deal.II/base/utilities.h>
+#include <deal.II/base/multithread_info.h>
 #include <deal.II/grid/grid_generator.h>
 #include <deal.II/base/function.h>
 #include <deal.II/base/point.h>
@@ -7,6 +8,8 @@
 #include <deal.II/grid/grid_in.h>
 #include <deal.II/numerics/vector_tools.h>
 
+#include <algorithm>    // std::max_element
+#include <cmath>        // std::ceil
 #include <limits>       // std::numeric_limits
 
 #include <boost/filesystem.hpp>
@@ -19,11 +22,19 @@
 // TemperatureSolver.cpp
 
 #include <PressureSolver.hpp>
+#include <DofUtilities.hpp>
+#include <Checkpoint.hpp>
 #include <Postprocessing.hpp>
+#include <PostprocessingPipeline.hpp>
 #include <InitialValues.hpp>
 #include <Mesher.hpp>
+#include <LoadBalancer.hpp>
+#include <OutputWriter.hpp>
+#include <PerformanceLog.hpp>
+#include <TimeStepController.hpp>
+#include <FixedPointAccelerator.hpp>
+#include <FieldCache.hpp>
 #include <Well.hpp>
-#include <FEFunction.hpp>
 
 
 namespace EagleFrac
@@ -37,7 +48,8 @@ namespace EagleFrac
     SinglePhaseModel(const std::string &input_file_name_);
     ~SinglePhaseModel();
 
-    void run();
+    void run(const unsigned int n_threads = 0,
+             const bool         restart = false);
 
   private:
     void create_mesh();
@@ -47,18 +59,15 @@ namespace EagleFrac
     void output_results(int time_step_number, double time); //const;
     void refine_mesh();
     void execute_postprocessing(const double time);
+    unsigned int n_temperature_subcycles(const double temperature_change_rate,
+                                         const double time_step) const;
     void exectute_adaptive_refinement();
-    void prepare_output_directories();
+    void prepare_output_directories(const bool restart = false);
+    std::string checkpoint_prefix() const;
+    void save_checkpoint(const Checkpoint::TimeState &state);
+    Checkpoint::TimeState load_checkpoint();
 		void print_header();
     void compute_fracture_toughness();
-		double 	compute_fss_error(
-			const TrilinosWrappers::MPI::BlockVector &solid_solution,
-			const TrilinosWrappers::MPI::BlockVector &pressure_solution,
-			const TrilinosWrappers::MPI::BlockVector &old_iter_solid_solution,
-			const TrilinosWrappers::MPI::BlockVector &old_iter_pressure_solution);
-		double 	compute_fss_error(
-			const TrilinosWrappers::MPI::BlockVector &pressure_solution,
-			const TrilinosWrappers::MPI::BlockVector &old_iter_pressure_solution);
 
 
     MPI_Comm mpi_communicator;
@@ -73,13 +82,19 @@ namespace EagleFrac
 		FluidSolvers::PressureSolver<dim> pressure_solver;
     FluidSolvers::TemperatureSolver<dim> temperature_solver;
 
-    Vector<double>  fracture_toughness;
-
     std::string input_file_name, case_name;
 
 		// this object contains time records for output
 		// this allows having a real time value in Paraview
 		std::vector< std::pair<double,std::string> > times_and_names;
+		Output::Writer output_writer;
+    Mesher::LoadBalancer<dim> load_balancer;
+    Output::PerformanceLog performance_log;
+    TimeStepping::TimeStepController time_step_controller;
+    Postprocessing::Pipeline<dim> postprocessor;
+    FluidSolvers::FixedPointAccelerator fss_accelerator;
+    // fields of the current FSS iterate shared by the solvers
+    Assembly::FieldCache<dim> field_cache;
 
   };
 
@@ -109,7 +124,11 @@ namespace EagleFrac
     temperature_solver(mpi_communicator, triangulation, data,
                        phase_field_solver.dof_handler, phase_field_solver.fe,
                        pcout, computing_timer),
-    input_file_name(input_file_name_)
+    input_file_name(input_file_name_),
+    output_writer(mpi_communicator),
+    load_balancer(triangulation, mpi_communicator),
+    performance_log(mpi_communicator),
+    field_cache(triangulation, QGauss<dim>(phase_field_solver.fe.degree + 2))
   {}
 
 
@@ -152,7 +171,14 @@ namespace EagleFrac
   template <int dim>
   void SinglePhaseModel<dim>::exectute_adaptive_refinement()
   {
+    field_cache.clear();
+    postprocessor.clear_mesh_data();
     phase_field_solver.relevant_solution = phase_field_solver.solution;
+    // weighted partition of the new mesh; without refinement flags
+    // execute_coarsening_and_refinement only repartitions
+    load_balancer.update_weights(phase_field_solver.dof_handler,
+                                 phase_field_solver.relevant_solution,
+                                 data.phi_refinement_value);
     std::vector<const TrilinosWrappers::MPI::BlockVector *> tmp(3);
     tmp[0] = &phase_field_solver.relevant_solution;
     tmp[1] = &phase_field_solver.old_solution;
@@ -216,11 +242,89 @@ namespace EagleFrac
 		pressure_solver.relevant_solution = pressure_solver.solution;
 
     temperature_solver.relevant_solution = temperature_solver.solution;
+    compute_fracture_toughness();
+  }  // eom
+
+
+  template <int dim>
+  std::string SinglePhaseModel<dim>::checkpoint_prefix() const
+  {
+    return "./" + case_name + "/restart";
   }  // eom
 
 
   template <int dim>
-  void SinglePhaseModel<dim>::prepare_output_directories()
+  void SinglePhaseModel<dim>::
+  save_checkpoint(const Checkpoint::TimeState &state)
+  {
+    computing_timer.enter_section("Write checkpoint");
+    phase_field_solver.relevant_solution = phase_field_solver.solution;
+
+    std::vector<const DoFHandler<dim>*> dof_handlers(3);
+    dof_handlers[0] = &phase_field_solver.dof_handler;
+    dof_handlers[1] = &pressure_solver.get_dof_handler();
+    dof_handlers[2] = &temperature_solver.get_dof_handler();
+
+    std::vector< std::vector<const TrilinosWrappers::MPI::BlockVector*> >
+      vectors(3);
+    vectors[0].push_back(&phase_field_solver.relevant_solution);
+    vectors[0].push_back(&phase_field_solver.old_solution);
+    vectors[0].push_back(&phase_field_solver.old_old_solution);
+    vectors[1].push_back(&pressure_solver.relevant_solution);
+    vectors[1].push_back(&pressure_solver.old_solution);
+    vectors[2].push_back(&temperature_solver.relevant_solution);
+
+    Checkpoint::save(checkpoint_prefix(), state, triangulation,
+                     dof_handlers, vectors, mpi_communicator);
+    pcout << "Checkpoint written at step " << state.time_step_number << std::endl;
+    computing_timer.exit_section();
+  }  // eom
+
+
+  template <int dim>
+  Checkpoint::TimeState SinglePhaseModel<dim>::load_checkpoint()
+  {
+    // replaces the global and local prerefinement
+    const Checkpoint::TimeState state =
+      Checkpoint::load_mesh(checkpoint_prefix(), triangulation);
+    setup_dofs();
+
+    TrilinosWrappers::MPI::BlockVector
+      tmp_owned1(phase_field_solver.owned_partitioning, mpi_communicator),
+      tmp_owned2(phase_field_solver.owned_partitioning, mpi_communicator),
+      tmp_pressure_owned(pressure_solver.owned_partitioning, mpi_communicator);
+
+    std::vector<const DoFHandler<dim>*> dof_handlers(3);
+    dof_handlers[0] = &phase_field_solver.dof_handler;
+    dof_handlers[1] = &pressure_solver.get_dof_handler();
+    dof_handlers[2] = &temperature_solver.get_dof_handler();
+
+    std::vector< std::vector<TrilinosWrappers::MPI::BlockVector*> > vectors(3);
+    vectors[0].push_back(&phase_field_solver.solution);
+    vectors[0].push_back(&tmp_owned1);
+    vectors[0].push_back(&tmp_owned2);
+    vectors[1].push_back(&pressure_solver.solution);
+    vectors[1].push_back(&tmp_pressure_owned);
+    vectors[2].push_back(&temperature_solver.solution);
+
+    Checkpoint::load_vectors(dof_handlers, vectors);
+
+    phase_field_solver.old_solution = tmp_owned1;
+    phase_field_solver.old_old_solution = tmp_owned2;
+    phase_field_solver.relevant_solution = phase_field_solver.solution;
+		pressure_solver.old_solution = tmp_pressure_owned;
+		pressure_solver.relevant_solution = pressure_solver.solution;
+    temperature_solver.relevant_solution = temperature_solver.solution;
+
+    times_and_names = state.times_and_names;
+    pcout << "Restarting from step " << state.time_step_number
+          << ", time " << state.time << std::endl;
+    return state;
+  }  // eom
+
+
+  template <int dim>
+  void SinglePhaseModel<dim>::prepare_output_directories(const bool restart)
   {
     size_t path_index = input_file_name.find_last_of("/");
 
@@ -234,7 +338,13 @@ namespace EagleFrac
 
     if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
     {
-      if (!boost::filesystem::is_directory(output_directory_path))
+      if (restart)
+      { // keep the output and the checkpoint of the previous run
+        AssertThrow(boost::filesystem::is_directory(output_directory_path),
+                    ExcMessage("No output folder to restart from"));
+        pcout << "Restart: keeping folder " << case_name << std::endl;
+      }
+      else if (!boost::filesystem::is_directory(output_directory_path))
       {
           pcout << "Output folder not found\n"
                 << "Creating directory: ";
@@ -251,8 +361,10 @@ namespace EagleFrac
 
 			// create directory for vtu's
 			boost::filesystem::path vtu_path("./" + case_name + "/vtu");
-			boost::filesystem::create_directory(vtu_path);
+			if (!boost::filesystem::is_directory(vtu_path))
+			  boost::filesystem::create_directory(vtu_path);
     }  // end mpi==0
+    MPI_Barrier(mpi_communicator);
   }  // eom
 
 
@@ -265,13 +377,9 @@ namespace EagleFrac
 		pressure_solver.setup_dofs();
     temperature_solver.setup_dofs();
 
-    // fracture_toughness.reinit(temperature_solver.owned_partitioning,
-    //                           mpi_communicator);
-    fracture_toughness.reinit(triangulation.n_active_cells());
 		// auto & pressure_dof_handler = pressure_solver.get_dof_handler();
-		for (unsigned int w=0; w<data.wells.size(); ++w)
-			data.wells[w]->locate(pressure_solver.get_dof_handler(),
-                            mpi_communicator);
+		RHS::locate_wells(data.wells, phase_field_solver.point_locator,
+		                  mpi_communicator);
 
   	computing_timer.exit_section();
 	} // eom
@@ -297,20 +405,72 @@ namespace EagleFrac
 
 
   template <int dim>
-  void SinglePhaseModel<dim>::run()
+  unsigned int SinglePhaseModel<dim>::
+  n_temperature_subcycles(const double temperature_change_rate,
+                          const double time_step) const
+  {
+    // fixed ratio
+    if (data.temperature_subcycle_tolerance == 0)
+      return data.temperature_subcycles;
+    // keep the relative temperature change of a substep below the tolerance
+    const double n = temperature_change_rate*time_step/data.temperature_subcycle_tolerance;
+    if (!(n < data.temperature_subcycles))
+      return data.temperature_subcycles;
+    return std::max(1u, static_cast<unsigned int>(std::ceil(n)));
+  }  // eom
+
+
+  template <int dim>
+  void SinglePhaseModel<dim>::run(const unsigned int n_threads,
+                                  const bool         restart)
   {
     data.read_input_file(input_file_name);
+    // command line overrides the input file
+    if (n_threads > 0)
+      data.n_threads = n_threads;
+    MultithreadInfo::set_thread_limit(data.n_threads);
+    pcout << "Threads per process " << MultithreadInfo::n_threads() << std::endl;
+    load_balancer.set_parameters(data.fracture_cell_weight,
+                                 data.load_imbalance_tolerance,
+                                 data.load_balancing_interval);
+    time_step_controller.set_parameters(data.target_newton_steps,
+                                        data.target_newton_contraction,
+                                        data.time_step_growth_factor,
+                                        data.time_step_cut_factor,
+                                        data.extrapolate_initial_guess);
+    fss_accelerator.set_parameters(data.fss_acceleration,
+                                   data.fss_acceleration_depth,
+                                   data.fss_relaxation);
     read_mesh();
 
 		auto & pressure_dof_handler = pressure_solver.get_dof_handler();
 		auto & pressure_fe = pressure_solver.get_fe();
-		auto & temperature_dof_handler = temperature_solver.get_dof_handler();
 		// point phase_field_solver to pressure objects
   	const FEValuesExtractors::Scalar pressure_extractor(0);
 		phase_field_solver.set_coupling(pressure_dof_handler,
 																		pressure_fe,
 																		pressure_extractor);
-    prepare_output_directories();
+		phase_field_solver.set_field_cache(field_cache);
+		pressure_solver.set_field_cache(field_cache);
+		temperature_solver.set_field_cache(field_cache);
+    prepare_output_directories(restart);
+    output_writer.set_parameters("./" + case_name, data.output_format,
+                                 data.output_interval, data.output_time_interval,
+                                 data.output_fields, data.asynchronous_output,
+                                 data.output_compression);
+    // per-step timings and solver statistics
+    const char *sections[] = {"solid", "pressure", "temperature",
+                              "adaptivity", "output"};
+    for (const char *section : sections)
+      performance_log.add_section(section);
+    const char *counters[] = {"step_attempts", "fss_steps", "newton_steps",
+                              "solid_linear_iterations", "pressure_iterations",
+                              "temperature_iterations", "temperature_substeps",
+                              "skipped_solid_solves", "active_set",
+                              "active_cells", "solid_dofs", "pressure_dofs"};
+    for (const char *counter : counters)
+      performance_log.add_counter(counter);
+    performance_log.set_file("./" + case_name + "/performance.csv", restart);
 
     // compute_runtime_parameters
     double minimum_mesh_size = Mesher::compute_minimum_mesh_size(triangulation,
@@ -327,42 +487,59 @@ namespace EagleFrac
 
     pcout << "min mesh size " << minimum_mesh_size << std::endl;
 
-    // local prerefinement
-    triangulation.refine_global(data.initial_refinement_level);
-		setup_dofs();
+    double time = 0;
+    double time_step = data.get_time_step(time);
+    double old_time_step = time_step;
+    int time_step_number = 0;
 
-		for (int ref_step=0; ref_step<data.n_adaptive_steps; ++ref_step)
-		{
-			pcout << "Local_prerefinement" << std::endl;
-	    Mesher::refine_region(triangulation,
-	                          data.local_prerefinement_region,
-	                          1);
-	    setup_dofs();
-		}
-
-    // Initial values
-    phase_field_solver.solution.block(0) = 0;
-    phase_field_solver.solution.block(1) = 1;
-		VectorTools::interpolate(
-			phase_field_solver.dof_handler,
-			 InitialValues::Defects<dim>(data.defect_coordinates,
-																	  // idk why e/2, it just works better
-																	 //  data.regularization_parameter_epsilon/2),
-																	//  2*minimum_mesh_size),
-																	 minimum_mesh_size),
-		   phase_field_solver.solution
-		 );
-
-		phase_field_solver.old_solution = phase_field_solver.solution;
-		pressure_solver.solution = data.init_pressure;
-    // phase_field_solver.old_solution.block(1) = phase_field_solver.solution.block(1);
-    temperature_solver.solution = 0.0;
-    temperature_solver.relevant_solution = temperature_solver.solution;
+    if (restart)
+    {
+      const Checkpoint::TimeState state = load_checkpoint();
+      time = state.time;
+      time_step = state.time_step;
+      old_time_step = state.old_time_step;
+      time_step_number = state.time_step_number;
+      time_step_controller.restore(state.controlled_time_step);
+      // the well schedule is a function of time
+			data.update_well_controlls(time);
+    }
+    else
+    {
+      // local prerefinement
+      triangulation.refine_global(data.initial_refinement_level);
+			setup_dofs();
 
-    data.get_fracture_toughness =
-      new Functions::FEFunction<dim>(temperature_dof_handler,
-                                     temperature_solver.relevant_solution,
-                                     &mapping);
+			for (int ref_step=0; ref_step<data.n_adaptive_steps; ++ref_step)
+			{
+				pcout << "Local_prerefinement" << std::endl;
+		    Mesher::refine_region(triangulation,
+		                          data.local_prerefinement_region,
+		                          1);
+		    setup_dofs();
+			}
+
+      // Initial values
+      phase_field_solver.solution.block(0) = 0;
+      phase_field_solver.solution.block(1) = 1;
+			VectorTools::interpolate(
+				phase_field_solver.dof_handler,
+				 InitialValues::Defects<dim>(data.defect_coordinates,
+																		  // idk why e/2, it just works better
+																		 //  data.regularization_parameter_epsilon/2),
+																		//  2*minimum_mesh_size),
+																		 minimum_mesh_size),
+			   phase_field_solver.solution
+			 );
+
+			phase_field_solver.old_solution = phase_field_solver.solution;
+			pressure_solver.solution = data.init_pressure;
+      // phase_field_solver.old_solution.block(1) = phase_field_solver.solution.block(1);
+      temperature_solver.solution = 0.0;
+      temperature_solver.relevant_solution = temperature_solver.solution;
+    }  // end initial values
+
+    // toughness depends on the temperature
+    compute_fracture_toughness();
 
     // // test fefunction
     // typename dofhandler<dim>::active_cell_iterator
@@ -374,24 +551,27 @@ namespace EagleFrac
 
     // return;
 
-    double time = 0;
-    double time_step = data.get_time_step(time);
-    double old_time_step = time_step;
-    int time_step_number = 0;
-
     // temperature_solver.assemble_system(time_step);
 		//
     while(time < data.t_max)
     {
-      time_step = data.get_time_step(time);
+      time_step = time_step_controller.next_time_step(data.get_time_step(time));
       time += time_step;
       time_step_number++;
 
       phase_field_solver.update_old_solution();
+      time_step_controller.initial_guess(phase_field_solver.solution,
+                                         phase_field_solver.old_solution,
+                                         phase_field_solver.old_old_solution,
+                                         time_step, old_time_step);
 			pressure_solver.old_solution = pressure_solver.solution;
       phase_field_solver.use_old_time_step_phi = true;
 
     redo_time_step:
+      performance_log.add("step_attempts", 1);
+      time_step_controller.begin_attempt();
+      // Newton steps of this attempt (wasted if it fails)
+      unsigned int attempt_newton_steps = 0;
 			// std::cout.precision(1.0/std::static_cast<double>(time_step));
 			pcout  << std::endl
 						<< "_______________________________________________" << std::endl
@@ -413,7 +593,6 @@ namespace EagleFrac
 
       std::pair<double,double> time_steps = std::make_pair(time_step, old_time_step);
 
-      IndexSet old_active_set(phase_field_solver.active_set);
 
 			TrilinosWrappers::MPI::BlockVector pressure_old_iter =
 				pressure_solver.relevant_solution;
@@ -421,22 +600,41 @@ namespace EagleFrac
 			// 	phase_field_solver.relevant_solution;
 
 			double fss_error = std::numeric_limits<double>::max();
+			fss_accelerator.reset();
+			pressure_solver.forcing_term.reset();
+			// max norm of the phi change in the last phase-field solve
+			double last_phi_change = std::numeric_limits<double>::max();
+			TrilinosWrappers::MPI::BlockVector solid_before;
 			unsigned int fss_step = 0;
+			bool pressure_converged = true;
 		  while (fss_step < 30)
 			{
 				pcout << "-----------------------------------------------" << std::endl;
 				pcout << "FSS iteration " << fss_step << std::endl;
+				performance_log.add("fss_steps", 1);
 				// if (time_step_number > 1 || fss_step > 0)
 
+				// pressure of this iterate in the solid q points
+				field_cache.update_pressure(pressure_dof_handler,
+				                            pressure_solver.relevant_solution);
+
 				print_header();
+				performance_log.start("solid");
 	      int pds_step = 0;  // solid system iteration number
 	      const double newton_tolerance = data.newton_tolerance;
+	      phase_field_solver.forcing_term.reset();
+	      // check the residual before solving if phi has settled
+	      const bool try_skip = (data.phase_field_skip_threshold > 0 &&
+	                             fss_step > 0 &&
+	                             last_phi_change < data.phase_field_skip_threshold);
+	      if (data.phase_field_skip_threshold > 0)
+	        solid_before = phase_field_solver.solution;
 	      while (pds_step < data.max_newton_iter)
 	      {
 					pcout << pds_step << "\t";
 
 	        double error = std::numeric_limits<double>::max();
-	        if (pds_step > 0)
+	        if (pds_step > 0 || try_skip)
 	        {
 						// compute residual
 				    phase_field_solver.assemble_coupled_system(phase_field_solver.solution,
@@ -447,6 +645,7 @@ namespace EagleFrac
 	          phase_field_solver.compute_active_set(phase_field_solver.solution);
 	          phase_field_solver.all_constraints.set_zero(phase_field_solver.residual);
 	          error = phase_field_solver.residual_norm();
+	          time_step_controller.newton_residual(error);
 
 						// print active set and error
 	          pcout << phase_field_solver.active_set_size() << "\t";
@@ -455,15 +654,19 @@ namespace EagleFrac
 	          std::cout.unsetf(std::ios_base::scientific);
 
 	          // break condition
-	          if (phase_field_solver.active_set_changed(old_active_set) &&
+	          if (phase_field_solver.active_set_changes() == 0 &&
 	              error < newton_tolerance)
 	          {
-	            pcout << "PDS Converged!" << std::endl;
+	            if (pds_step == 0)
+	            {
+	              pcout << "PDS skipped" << std::endl;
+	              performance_log.add("skipped_solid_solves", 1);
+	            }
+	            else
+	              pcout << "PDS Converged!" << std::endl;
       				// phase_field_solver.truncate_phase_field();
 	            break;
 	          }
-
-	          old_active_set = phase_field_solver.active_set;
 	        }  // end first newton step condition
 
 					std::pair<unsigned int, unsigned int> newton_step_results;
@@ -476,33 +679,58 @@ namespace EagleFrac
 					catch (SolverControl::NoConvergence e)
 					{
 					  computing_timer.exit_section();
+					  const double new_time_step =
+					    time_step_controller.reject(time_step,
+					                                attempt_newton_steps + pds_step);
 						pcout << "linear solver didn't converge!"
-						      << "Adjusting time step to " << time_step/10
+						      << "Adjusting time step to " << new_time_step
 									<< std::endl;
 		        time -= time_step;
-		        time_step /= 10;
+		        time_step = new_time_step;
 		        time += time_step;
-		        phase_field_solver.solution = phase_field_solver.old_solution;
+		        time_step_controller.initial_guess(phase_field_solver.solution,
+		                                           phase_field_solver.old_solution,
+		                                           phase_field_solver.old_old_solution,
+		                                           time_step, old_time_step);
 		        phase_field_solver.use_old_time_step_phi = true;
 						pressure_solver.solution = pressure_solver.old_solution;
+            if (time_step < data.minimum_time_step)
+            {
+              pcout << "Time step too small: aborting" << std::endl;
+              std::cout.unsetf(std::ios_base::scientific);
+              throw SolverControl::NoConvergence(-1, -1);
+            }
 		        goto redo_time_step;
 					}
-					phase_field_solver.relevant_solution = phase_field_solver.solution;
+					phase_field_solver.update_relevant_solution();
 
 					pcout << newton_step_results.first << "\t";
 					pcout << newton_step_results.second << "\t";
+					performance_log.add("solid_linear_iterations",
+					                    newton_step_results.first);
 
 	        pds_step++;
 
 	        pcout << std::endl;
 	      }  // End pds iter
+	      performance_log.stop("solid");
+	      performance_log.add("newton_steps", pds_step);
+	      time_step_controller.end_solve(pds_step);
+	      attempt_newton_steps += pds_step;
+	      if (data.phase_field_skip_threshold > 0)
+	      {
+	        solid_before -= phase_field_solver.solution;
+	        last_phi_change = solid_before.block(1).linfty_norm();
+	      }
 
 	      // cut the time step if no convergence
 	      if (pds_step == data.max_newton_iter)
 	      {
+	        const double new_time_step =
+	          time_step_controller.reject(time_step, attempt_newton_steps);
 	        pcout << "Time step didn't converge: reducing to dt = "
-	              << time_step/10 << std::endl;
-	        if (time_step/10 < data.minimum_time_step)
+	              << new_time_step << std::endl;
+	        if (new_time_step < data.minimum_time_step)
 	        {
 	          pcout << "Time step too small: aborting" << std::endl;
 	          std::cout.unsetf(std::ios_base::scientific);
@@ -510,9 +738,12 @@ namespace EagleFrac
 	        }
 
 	        time -= time_step;
-	        time_step /= 10;
+	        time_step = new_time_step;
 	        time += time_step;
-	        phase_field_solver.solution = phase_field_solver.old_solution;
+	        time_step_controller.initial_guess(phase_field_solver.solution,
+	                                           phase_field_solver.old_solution,
+	                                           phase_field_solver.old_old_solution,
+	                                           time_step, old_time_step);
 					pressure_solver.solution = pressure_solver.old_solution;
 	        phase_field_solver.use_old_time_step_phi = true;
 	        goto redo_time_step;
@@ -520,40 +751,61 @@ namespace EagleFrac
 
 	      // do adaptive refinement if needed
 	      if (data.n_adaptive_steps > 0)
-	        if (Mesher::prepare_phase_field_refinement(phase_field_solver,
-	                                                   data.phi_refinement_value,
-	                                                   max_refinement_level))
+	      {
+	        performance_log.start("adaptivity");
+	        const bool redo =
+	          Mesher::adapt_phase_field_mesh
+	            (phase_field_solver, data, max_refinement_level, pcout,
+	             [&]()
+	             {
+	               exectute_adaptive_refinement();
+	               // continue from the last FSS iterate on the new mesh
+	               pressure_old_iter = pressure_solver.relevant_solution;
+	               fss_accelerator.reset();
+	               pressure_solver.forcing_term.reset();
+	             });
+	        performance_log.stop("adaptivity");
+	        if (redo)
 	        {
-	          pcout << std::endl
-	               << "Adapting mesh"
-	               << std::endl
-								 << "Redo time step"
-	               << std::endl;
-	          exectute_adaptive_refinement();
+	          pcout << "Redo time step" << std::endl;
 	          goto redo_time_step;
-	        } // end adaptive refinement
+	        }
+	      }  // end adaptive refinement
 
 				// if (time_step_number > 1)
 				{ // Solve for pressure
 					pcout << "Pressure solver: ";
-					phase_field_solver.relevant_solution = phase_field_solver.solution;
+					performance_log.start("pressure");
+					phase_field_solver.update_relevant_solution();
+					field_cache.update_solid(phase_field_solver.dof_handler,
+					                         phase_field_solver.relevant_solution,
+					                         phase_field_solver.old_solution);
 					pressure_solver.assemble_system(phase_field_solver.relevant_solution,
 																					phase_field_solver.old_solution,
 																					time_step);
-					const unsigned int n_pressure_iter = pressure_solver.solve();
+					unsigned int n_pressure_iter = 0;
+					try
+					{
+						n_pressure_iter = pressure_solver.solve();
+					}
+					catch (SolverControl::NoConvergence e)
+					{
+						computing_timer.exit_section();
+						pressure_converged = false;
+					}
 					pressure_solver.relevant_solution = pressure_solver.solution;
 					pcout << n_pressure_iter << std::endl;
+					performance_log.add("pressure_iterations", n_pressure_iter);
+					performance_log.stop("pressure");
+					if (!pressure_converged)
+					{
+						pcout << "pressure solver didn't converge!" << std::endl;
+						break;
+					}
 				}
 
 				fss_error = pressure_solver.solution_increment_norm
 					(pressure_solver.relevant_solution, pressure_old_iter);
-				// alternative error that adds error in displacement and phase-field
-				// but only computes vector norm (not the FEM L2 norm)
-				// fss_error = compute_fss_error(
-				// 	phase_field_solver.relevant_solution, pressure_solver.relevant_solution,
-				// 	solid_tmp, pressure_old_iter);
-				// solid_tmp = phase_field_solver.solution;
-				pressure_old_iter = pressure_solver.solution;
 	      // output_results(fss_step);
 
 				pcout << "FSS error: " << fss_error << std::endl;
@@ -564,26 +816,105 @@ namespace EagleFrac
 					break;
 				}
 
+				// accelerated pressure iterate
+				fss_accelerator.update(pressure_old_iter, pressure_solver.solution);
+				if (data.fss_acceleration == "aitken")
+					pcout << "FSS relaxation: " << fss_accelerator.get_relaxation()
+					      << std::endl;
+				pressure_solver.relevant_solution = pressure_solver.solution;
+				pressure_old_iter = pressure_solver.solution;
+
 				fss_step++;
 
 	      phase_field_solver.use_old_time_step_phi = false;
 		    // //   phase_field_solver.use_old_time_step_phi = true;
 			}  // end fss iteration
 
+      // cut the time step if the splitting didn't converge
+      if (fss_step == 30 || !pressure_converged)
+      {
+        const double new_time_step =
+          time_step_controller.reject(time_step, attempt_newton_steps);
+        pcout << "FSS didn't converge: reducing to dt = "
+              << new_time_step << std::endl;
+        if (new_time_step < data.minimum_time_step)
+        {
+          pcout << "Time step too small: aborting" << std::endl;
+          std::cout.unsetf(std::ios_base::scientific);
+          throw SolverControl::NoConvergence(-1, -1);
+        }
+
+        time -= time_step;
+        time_step = new_time_step;
+        time += time_step;
+        time_step_controller.initial_guess(phase_field_solver.solution,
+                                           phase_field_solver.old_solution,
+                                           phase_field_solver.old_old_solution,
+                                           time_step, old_time_step);
+        pressure_solver.solution = pressure_solver.old_solution;
+        pressure_solver.relevant_solution = pressure_solver.solution;
+        phase_field_solver.relevant_solution = phase_field_solver.solution;
+        phase_field_solver.use_old_time_step_phi = true;
+        goto redo_time_step;
+      }
+      time_step_controller.accept(time_step);
+
       // phase_field_solver.truncate_phase_field();
-      temperature_solver.impose_temperature_values
-        (phase_field_solver.relevant_solution);
-      temperature_solver.assemble_system(time_step);
-      temperature_solver.solve();
-      temperature_solver.relevant_solution = temperature_solver.solution;
+      performance_log.start("temperature");
+      {
+        const unsigned int n_substeps =
+          n_temperature_subcycles(temperature_solver.change_rate(), time_step);
+        const unsigned int n_temperature_iter =
+          temperature_solver.advance(phase_field_solver.relevant_solution,
+                                     time_step, n_substeps);
+        performance_log.add("temperature_iterations", n_temperature_iter);
+        performance_log.add("temperature_substeps", n_substeps);
+      }
+      compute_fracture_toughness();
+      performance_log.stop("temperature");
 
+      performance_log.start("output");
       output_results(time_step_number, time);
 			execute_postprocessing(time);
+      performance_log.stop("output");
 
       old_time_step = time_step;
 
+      if (load_balancer.need_rebalance(time_step_number,
+                                       phase_field_solver.local_assembly_time()))
+      {
+        pcout << "Rebalancing, load imbalance "
+              << load_balancer.get_imbalance() << std::endl;
+        performance_log.start("adaptivity");
+        exectute_adaptive_refinement();
+        performance_log.stop("adaptivity");
+      }
+
+      performance_log.set("active_set", phase_field_solver.active_set_size());
+      performance_log.set("active_cells", triangulation.n_global_active_cells());
+      performance_log.set("solid_dofs", phase_field_solver.dof_handler.n_dofs());
+      performance_log.set("pressure_dofs",
+                          pressure_solver.get_dof_handler().n_dofs());
+      performance_log.end_step(time_step_number, time, time_step);
+
+      if (data.checkpoint_interval > 0 &&
+          time_step_number % data.checkpoint_interval == 0)
+      {
+        Checkpoint::TimeState state;
+        state.time = time;
+        state.time_step = time_step;
+        state.old_time_step = old_time_step;
+        state.time_step_number = time_step_number;
+        state.times_and_names = times_and_names;
+        state.controlled_time_step = time_step_controller.proposed_time_step();
+        save_checkpoint(state);
+      }
+
       if (time >= data.t_max) break;
     }  // end time loop
+    time_step_controller.print_statistics(pcout);
+    phase_field_solver.forcing_term.print_statistics(pcout, "Solid solver");
+    pressure_solver.forcing_term.print_statistics(pcout, "Pressure solver");
 
     pcout << std::fixed;
     // show timer table in default format
@@ -591,164 +922,44 @@ namespace EagleFrac
   }  // EOM
 
 
-	template <int dim>
-  double SinglePhaseModel<dim>::
-	compute_fss_error(
-		const TrilinosWrappers::MPI::BlockVector &solid_solution,
-		const TrilinosWrappers::MPI::BlockVector &pressure_solution,
-		const TrilinosWrappers::MPI::BlockVector &old_iter_solid_solution,
-		const TrilinosWrappers::MPI::BlockVector &old_iter_pressure_solution)
-	{
-
-		auto & solid_df = phase_field_solver.dof_handler;
-		auto & pressure_df = pressure_solver.get_dof_handler();
-
-		auto & pressure_hanging_nodes = pressure_solver.get_constraint_matrix();
-		auto & solid_hanging_nodes = phase_field_solver.hanging_nodes_constraints;
-
-		auto & pressure_fe = pressure_solver.get_fe();
-		auto & solid_fe    = phase_field_solver.fe;
-  	const unsigned int solid_dofs_per_cell    = solid_fe.dofs_per_cell;
-  	const unsigned int pressure_dofs_per_cell = pressure_fe.dofs_per_cell;
-
-  	std::vector<types::global_dof_index>
-			local_dof_indices_solid(solid_dofs_per_cell),
-			local_dof_indices_pressure(pressure_dofs_per_cell);
-
-  	std::vector<bool> solid_dof_touched(solid_df.n_dofs(), false);
-  	std::vector<bool> pressure_dof_touched(pressure_df.n_dofs(), false);
-
-	  typename DoFHandler<dim>::active_cell_iterator
-	    solid_cell = solid_df.begin_active(),
-	    pressure_cell = pressure_df.begin_active(),
-	    endc = solid_df.end();
-
-		// double error = 0;
-		double u_error = 0;
-		double phi_error = 0;
-		double p_error = 0;
-
-  	for (; solid_cell != endc; ++solid_cell, ++pressure_cell)
-    	if (!solid_cell->is_artificial())
-			{
-      	solid_cell->get_dof_indices(local_dof_indices_solid);
-      	pressure_cell->get_dof_indices(local_dof_indices_pressure);
-
-				for (unsigned int i=0; i<solid_dofs_per_cell; ++i)
-				{
-						const unsigned int index = local_dof_indices_solid[i];
-        		const int component = solid_fe.system_to_component_index(i).first;
-						// pcout << "Constrained "
-						// 			<< solid_hanging_nodes.is_constrained(index)
-						// 			<< " touched "
-						// 			<< solid_dof_touched[index]
-						// 			<< std::endl;
-						if(solid_dof_touched[index] == false &&
-							 !solid_hanging_nodes.is_constrained(index))
-				  	{
-							solid_dof_touched[index] = true;
-							// error +=
-							double e =
-								std::pow(solid_solution[index] - old_iter_solid_solution[index], 2);
-							if (component == dim)
-								phi_error += e;
-							else
-								u_error += e;
-				 		}
-				}  // end dof loop
-
-				for (unsigned int i=0; i<pressure_dofs_per_cell; ++i)
-				{
-					const unsigned int index = 	local_dof_indices_pressure[i];
-					if(pressure_dof_touched[index] == false &&
-						 !pressure_hanging_nodes.is_constrained(index))
-					{
-						pressure_dof_touched[index] = true;
-						p_error +=
-							std::pow(pressure_solution[index] - old_iter_pressure_solution[index], 2);
-					}
-				}  // end dof loop
-
-			}  // end cell loop
-
-		phi_error = Utilities::MPI::sum(phi_error, mpi_communicator);
-		u_error = Utilities::MPI::sum(u_error, mpi_communicator);
-		p_error = Utilities::MPI::sum(p_error, mpi_communicator);
-		double error = std::max(phi_error, u_error);
-		error = std::max(error, p_error);
-		error = std::sqrt(error);
-		return error;
-	}  // eom
-
-
-	template <int dim>
-  double SinglePhaseModel<dim>::
-	compute_fss_error(
-		const TrilinosWrappers::MPI::BlockVector &pressure_solution,
-		const TrilinosWrappers::MPI::BlockVector &old_iter_pressure_solution)
-	{
-
-		auto & pressure_df = pressure_solver.get_dof_handler();
-		auto & pressure_hanging_nodes = pressure_solver.get_constraint_matrix();
-		auto & pressure_fe = pressure_solver.get_fe();
-  	const unsigned int pressure_dofs_per_cell = pressure_fe.dofs_per_cell;
-
-  	std::vector<types::global_dof_index>
-			local_dof_indices_pressure(pressure_dofs_per_cell);
-
-  	std::vector<bool> pressure_dof_touched(pressure_df.n_dofs(), false);
-
-	  typename DoFHandler<dim>::active_cell_iterator
-	    pressure_cell = pressure_df.begin_active(),
-	    endc = pressure_df.end();
-
-		double error = 0;
-		// double mean_pressure = 0;
-		// unsigned int n_avg_points = 0;
-
-  	for (; pressure_cell!=endc; ++pressure_cell)
-    	if (!pressure_cell->is_artificial())
-			{
-      	pressure_cell->get_dof_indices(local_dof_indices_pressure);
-
-				for (unsigned int i=0; i<pressure_dofs_per_cell; ++i)
-				{
-					const unsigned int index = local_dof_indices_pressure[i];
-					if(pressure_dof_touched[index] == false &&
-						 !pressure_hanging_nodes.is_constrained(index))
-					{
-						pressure_dof_touched[index] = true;
-						error +=
-							std::pow(pressure_solution(index) - old_iter_pressure_solution(index), 2);
-					}
-				}  // end dof loop
-			}  // end cell loop
-
-		error = Utilities::MPI::sum(error, mpi_communicator);
-		error = std::sqrt(error);
-		return error;
-	}  // eom
 
   template <int dim>
   void SinglePhaseModel<dim>::execute_postprocessing(const double time)
   {
-    // just some commands so no compiler warnings
+    // register the quantities in the order of the functions
+    if (postprocessor.n_quantities() == 0)
+      for (unsigned int i=0; i<data.postprocessing_function_names.size(); i++)
+      {
+        unsigned int l = data.postprocessing_function_names[i].size();
+        if (data.postprocessing_function_names[i].compare(0, l, "well_pressure") == 0)
+        {
+          const unsigned int n_wells = data.wells.size();
+          std::vector< Point<dim> > points(n_wells);
+          for (unsigned int w=0; w<n_wells; ++w)
+            points[w] = data.wells[w]->true_location;
+          postprocessor.add_point_values(pressure_solver.get_dof_handler(),
+                                         pressure_solver.relevant_solution,
+                                         /* comp = */ 0, points);
+        }
+        if (data.postprocessing_function_names[i].compare(0, l, "boundary_load") == 0)
+          postprocessor.add_boundary_load
+            (boost::get<int>(data.postprocessing_function_args[i][0]));
+      }
+    if (postprocessor.n_quantities() == 0)
+      return;
+
+    // all quantities in one pass
+    postprocessor.evaluate(phase_field_solver, data);
+
+    unsigned int handle = 0;
     for (unsigned int i=0; i<data.postprocessing_function_names.size(); i++)
     {
       unsigned int l = data.postprocessing_function_names[i].size();
       if (data.postprocessing_function_names[i].compare(0, l, "well_pressure") == 0)
 			{
-				auto & pressure_dof_handler = pressure_solver.get_dof_handler();
-				// get well points
 				const unsigned int n_wells = data.wells.size();
-				std::vector< Point<dim> > points(n_wells);
-				for (unsigned int w=0; w<n_wells; ++w)
-					points[w] = data.wells[w]->true_location;
-
-				Vector<double> pressure_values =
-					Postprocessing::get_point_values(
-						pressure_dof_handler, pressure_solver.relevant_solution,
-						/* comp = */ 0, points, mpi_communicator);
+				const Vector<double> pressure_values =
+					postprocessor.get_point_values(handle++);
 
 	      // Sum write output
         if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
@@ -766,9 +977,7 @@ namespace EagleFrac
       {
         int boundary_id =
             boost::get<int>(data.postprocessing_function_args[i][0]);
-        Tensor<1,dim> load =
-          Postprocessing::compute_boundary_load(phase_field_solver,
-                                                data, boundary_id);
+        const Tensor<1,dim> load = postprocessor.get_boundary_load(handle++);
         // Sum write output
         if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
         {
@@ -791,24 +1000,32 @@ namespace EagleFrac
   template <int dim>
   void SinglePhaseModel<dim>::compute_fracture_toughness()
   {
+    /*
+      Toughness of a cell is a function of the temperature in its
+      center, which for linear elements is the mean of the cell's dof
+      values. It is written straight into the cell properties that the
+      phase-field assembly reads.
+     */
     const auto & dof_handler = temperature_solver.get_dof_handler();
-    // const auto & fe = dof_handler.get_fe();
+    const auto & fe = dof_handler.get_fe();
+    std::vector<types::global_dof_index> local_dof_indices(fe.dofs_per_cell);
 
     typename DoFHandler<dim>::active_cell_iterator
 		  cell = dof_handler.begin_active(),
 		  endc = dof_handler.end();
 
-    // fracture_toughness = 0;
-    unsigned int idx = 0;
-
     for (; cell!=endc; ++cell)
     {
       if (!cell->is_artificial())
       {
-        fracture_toughness[idx] =
-          data.get_fracture_toughness->value(cell->center());
+        cell->get_dof_indices(local_dof_indices);
+        double temperature = 0;
+        for (unsigned int i=0; i<fe.dofs_per_cell; ++i)
+          temperature += temperature_solver.relevant_solution[local_dof_indices[i]];
+        temperature /= fe.dofs_per_cell;
+        data.cell_properties.set_fracture_toughness(cell->active_cell_index(),
+                                                    mapping(temperature));
       }
-      idx++;
     }  // end cell loop
   } // eom
 
@@ -816,6 +1033,9 @@ namespace EagleFrac
   template <int dim>
   void SinglePhaseModel<dim>::output_results(int time_step_number, double time)
   {
+    if (!output_writer.need_output(time_step_number, time))
+      return;
+
     // Add data vectors to output
     std::vector<std::string> solution_names(dim, "displacement");
     solution_names.push_back("phase_field");
@@ -828,81 +1048,50 @@ namespace EagleFrac
     DataOut<dim> data_out;
     phase_field_solver.relevant_solution = phase_field_solver.solution;
     data_out.attach_dof_handler(phase_field_solver.dof_handler);
-    data_out.add_data_vector(phase_field_solver.relevant_solution,
-                             solution_names,
-                             DataOut<dim>::type_dof_data,
-                             data_component_interpretation);
+    if (output_writer.write_field("solution"))
+      data_out.add_data_vector(phase_field_solver.relevant_solution,
+                               solution_names,
+                               DataOut<dim>::type_dof_data,
+                               data_component_interpretation);
     // add active set
-    data_out.add_data_vector(phase_field_solver.active_set, "active_set");
+    if (output_writer.write_field("active_set"))
+      data_out.add_data_vector(phase_field_solver.active_set, "active_set");
     // data_out.add_data_vector(phase_field_solver.residual, "residual");
     // Add domain ids
-    Vector<float> subdomain(triangulation.n_active_cells());
-    for (unsigned int i=0; i<subdomain.size(); ++i)
-      subdomain(i) = triangulation.locally_owned_subdomain();
-    data_out.add_data_vector(subdomain, "subdomain");
+    Vector<float> subdomain;
+    if (output_writer.write_field("subdomain"))
+    {
+      subdomain.reinit(triangulation.n_active_cells());
+      for (unsigned int i=0; i<subdomain.size(); ++i)
+        subdomain(i) = triangulation.locally_owned_subdomain();
+      data_out.add_data_vector(subdomain, "subdomain");
+    }
 		// Add pressure
 		auto & pressure_dof_handler = pressure_solver.get_dof_handler();
-		data_out.add_data_vector(pressure_dof_handler,
-														 pressure_solver.relevant_solution,
-														 "pressure");
+		if (output_writer.write_field("pressure"))
+			data_out.add_data_vector(pressure_dof_handler,
+															 pressure_solver.relevant_solution,
+															 "pressure");
     // Add temperature and fracture toughness
-    compute_fracture_toughness();
 		auto & temperature_dof_handler = temperature_solver.get_dof_handler();
-		data_out.add_data_vector(temperature_dof_handler,
-														 temperature_solver.relevant_solution,
-														 "temp");
-		data_out.add_data_vector(fracture_toughness, "Gc");
+		if (output_writer.write_field("temperature"))
+			data_out.add_data_vector(temperature_dof_handler,
+															 temperature_solver.relevant_solution,
+															 "temp");
+		if (output_writer.write_field("toughness"))
+			data_out.add_data_vector(data.cell_properties.fracture_toughness_values(),
+			                         "Gc");
 
     data_out.build_patches();
-
-    int n_time_step_digits = 3,
-        n_processor_digits = 3;
-
-    // Write output from local processors
-    const std::string filename = ("./" + case_name + "/vtu/solution-" +
-                                  Utilities::int_to_string(time_step_number,
-                                                           n_time_step_digits) +
-                                  "." +
-                                  Utilities::int_to_string
-                                  (triangulation.locally_owned_subdomain(),
-                                   n_processor_digits));
-    std::ofstream output ((filename + ".vtu").c_str());
-    data_out.write_vtu(output);
-
-    // Write master pbtu and pvd files
-    if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
-      {
-        std::vector<std::string> filenames;
-        for (unsigned int i=0;
-             i<Utilities::MPI::n_mpi_processes(mpi_communicator);
-             ++i)
-          filenames.push_back("solution-" +
-                              Utilities::int_to_string(time_step_number,
-                                                       n_time_step_digits) +
-                              "." +
-                              Utilities::int_to_string(i, n_processor_digits) +
-                              ".vtu");
-        std::string pvtu_filename =
-				  "solution-" +
-          Utilities::int_to_string(time_step_number, n_time_step_digits) +
-          ".pvtu";
-        std::ofstream
-          master_output(("./" + case_name + "/vtu/" + pvtu_filename).c_str());
-        data_out.write_pvtu_record(master_output, filenames);
-
-				// write pvd file
-				const std::string pvd_filename = "solution.pvd";
-				times_and_names.push_back
-					(std::pair<double,std::string> (time, "./vtu/" + pvtu_filename) );
-				std::ofstream pvd_master(("./" + case_name + "/" + pvd_filename).c_str());
-				data_out.write_pvd_record(pvd_master, times_and_names);
-      }  // end master output
+    output_writer.write(data_out, time_step_number, time, times_and_names);
   } // EOM
 
 }  // end of namespace
 
 
-std::string parse_command_line(int argc, char *const *argv) {
+std::string parse_command_line(int argc, char *const *argv,
+                               unsigned int &n_threads,
+                               bool         &restart) {
   std::string filename;
   if (argc < 2) {
     std::cout << "specify the file name" << std::endl;
@@ -915,6 +1104,23 @@ std::string parse_command_line(int argc, char *const *argv) {
 
   int arg_number = 1;
   while (args.size()){
+    if (args.front() == std::string("-threads"))
+    {  // -threads N: number of threads per MPI process
+      args.pop_front();
+      if (args.size() == 0) {
+        std::cout << "specify the number of threads after -threads" << std::endl;
+        exit(1);
+      }
+      n_threads = Utilities::string_to_int(args.front());
+      args.pop_front();
+      continue;
+    }
+    if (args.front() == std::string("-restart"))
+    {  // continue from the last checkpoint of this case
+      args.pop_front();
+      restart = true;
+      continue;
+    }
     if (arg_number == 1)
       filename = args.front();
     args.pop_front();
@@ -930,9 +1136,11 @@ int main(int argc, char *argv[])
   {
     using namespace dealii;
     Utilities::MPI::MPI_InitFinalize mpi_initialization(argc, argv, 1);
-    std::string input_file_name = parse_command_line(argc, argv);
+    unsigned int n_threads = 0;
+    bool restart = false;
+    std::string input_file_name = parse_command_line(argc, argv, n_threads, restart);
     EagleFrac::SinglePhaseModel<2> problem(input_file_name);
-    problem.run();
+    problem.run(n_threads, restart);
     return 0;
   }
   catch (std::exception &exc)
@@ -1,4 +1,5 @@
 #include <deal.II/base/utilities.h>
+#include <deal.II/base/multithread_info.h>
 #include <deal.II/grid/grid_generator.h>
 #include <deal.II/base/function.h>
 #include <deal.II/base/point.h>
@@ -16,9 +17,15 @@
 #include <PhaseFieldSolver.hpp>
 #include <WidthSolver.hpp>
 #include <Postprocessing.hpp>
+#include <PostprocessingPipeline.hpp>
 #include <PhaseFieldPressurizedData.hpp>
 #include <InitialValues.hpp>
 #include <Mesher.hpp>
+#include <LoadBalancer.hpp>
+#include <OutputWriter.hpp>
+#include <PerformanceLog.hpp>
+#include <TimeStepController.hpp>
+#include <Checkpoint.hpp>
 
 
 namespace EagleFrac
@@ -32,7 +39,8 @@ namespace EagleFrac
     PDSSolid(const std::string &input_file_name_);
     ~PDSSolid();
 
-    void run();
+    void run(const unsigned int n_threads = 0,
+             const bool         restart = false);
 
   private:
     void create_mesh();
@@ -44,7 +52,10 @@ namespace EagleFrac
     void execute_postprocessing(const unsigned int time_step_number,
 																const double time);
     void exectute_adaptive_refinement();
-    void prepare_output_directories();
+    void prepare_output_directories(const bool restart = false);
+    std::string checkpoint_prefix() const;
+    void save_checkpoint(const Checkpoint::TimeState &state);
+    Checkpoint::TimeState load_checkpoint();
 		void print_header();
 		void impose_pressure_values(const double max_value);
 		void compute_Gc_vector();
@@ -69,6 +80,11 @@ namespace EagleFrac
 		TrilinosWrappers::MPI::BlockVector pressure_relevant_solution;
 
 		std::vector< std::pair<double,std::string> > times_and_names;
+		Output::Writer output_writer;
+    Mesher::LoadBalancer<dim> load_balancer;
+    Output::PerformanceLog performance_log;
+    TimeStepping::TimeStepController time_step_controller;
+    Postprocessing::Pipeline<dim> postprocessor;
     std::vector< Vector<double> > stresses;
   };
 
@@ -98,7 +114,10 @@ namespace EagleFrac
                  data,
                  phase_field_solver.dof_handler,
                  pcout, computing_timer),
-    input_file_name(input_file_name_)
+    input_file_name(input_file_name_),
+    output_writer(mpi_communicator),
+    load_balancer(triangulation, mpi_communicator),
+    performance_log(mpi_communicator)
   {}
 
 
@@ -147,7 +166,13 @@ namespace EagleFrac
   template <int dim>
   void PDSSolid<dim>::exectute_adaptive_refinement()
   {
+    postprocessor.clear_mesh_data();
     phase_field_solver.relevant_solution = phase_field_solver.solution;
+    // weighted partition of the new mesh; without refinement flags
+    // execute_coarsening_and_refinement only repartitions
+    load_balancer.update_weights(phase_field_solver.dof_handler,
+                                 phase_field_solver.relevant_solution,
+                                 data.phi_refinement_value);
     std::vector<const TrilinosWrappers::MPI::BlockVector *> tmp(3);
     tmp[0] = &phase_field_solver.relevant_solution;
     tmp[1] = &phase_field_solver.old_solution;
@@ -178,7 +203,75 @@ namespace EagleFrac
 
 
   template <int dim>
-  void PDSSolid<dim>::prepare_output_directories()
+  std::string PDSSolid<dim>::checkpoint_prefix() const
+  {
+    return "./" + case_name + "/restart";
+  }  // eom
+
+
+  template <int dim>
+  void PDSSolid<dim>::save_checkpoint(const Checkpoint::TimeState &state)
+  {
+    computing_timer.enter_section("Write checkpoint");
+    phase_field_solver.relevant_solution = phase_field_solver.solution;
+
+    // the pressure is given by a function of time and is not stored
+    std::vector<const DoFHandler<dim>*> dof_handlers(2);
+    dof_handlers[0] = &phase_field_solver.dof_handler;
+    dof_handlers[1] = &width_solver.get_dof_handler();
+
+    std::vector< std::vector<const TrilinosWrappers::MPI::BlockVector*> >
+      vectors(2);
+    vectors[0].push_back(&phase_field_solver.relevant_solution);
+    vectors[0].push_back(&phase_field_solver.old_solution);
+    vectors[0].push_back(&phase_field_solver.old_old_solution);
+    vectors[1].push_back(&width_solver.relevant_solution);
+
+    Checkpoint::save(checkpoint_prefix(), state, triangulation,
+                     dof_handlers, vectors, mpi_communicator);
+    pcout << "Checkpoint written at step " << state.time_step_number << std::endl;
+    computing_timer.exit_section();
+  }  // eom
+
+
+  template <int dim>
+  Checkpoint::TimeState PDSSolid<dim>::load_checkpoint()
+  {
+    // replaces the global and local prerefinement
+    const Checkpoint::TimeState state =
+      Checkpoint::load_mesh(checkpoint_prefix(), triangulation);
+    setup_dofs();
+
+    TrilinosWrappers::MPI::BlockVector
+      tmp_owned1(phase_field_solver.owned_partitioning, mpi_communicator),
+      tmp_owned2(phase_field_solver.owned_partitioning, mpi_communicator);
+
+    std::vector<const DoFHandler<dim>*> dof_handlers(2);
+    dof_handlers[0] = &phase_field_solver.dof_handler;
+    dof_handlers[1] = &width_solver.get_dof_handler();
+
+    std::vector< std::vector<TrilinosWrappers::MPI::BlockVector*> > vectors(2);
+    vectors[0].push_back(&phase_field_solver.solution);
+    vectors[0].push_back(&tmp_owned1);
+    vectors[0].push_back(&tmp_owned2);
+    vectors[1].push_back(&width_solver.solution);
+
+    Checkpoint::load_vectors(dof_handlers, vectors);
+
+    phase_field_solver.old_solution = tmp_owned1;
+    phase_field_solver.old_old_solution = tmp_owned2;
+    phase_field_solver.relevant_solution = phase_field_solver.solution;
+    width_solver.relevant_solution = width_solver.solution;
+
+    times_and_names = state.times_and_names;
+    pcout << "Restarting from step " << state.time_step_number
+          << ", time " << state.time << std::endl;
+    return state;
+  }  // eom
+
+
+  template <int dim>
+  void PDSSolid<dim>::prepare_output_directories(const bool restart)
   {
     size_t path_index = input_file_name.find_last_of("/");
 
@@ -192,7 +285,13 @@ namespace EagleFrac
 
     if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
     {
-      if (!boost::filesystem::is_directory(output_directory_path))
+      if (restart)
+      { // keep the output and the checkpoint of the previous run
+        AssertThrow(boost::filesystem::is_directory(output_directory_path),
+                    ExcMessage("No output folder to restart from"));
+        pcout << "Restart: keeping folder " << case_name << std::endl;
+      }
+      else if (!boost::filesystem::is_directory(output_directory_path))
       {
           pcout << "Output folder not found\n"
                 << "Creating directory: ";
@@ -209,8 +308,10 @@ namespace EagleFrac
 
 			// create directory for vtu's
 			boost::filesystem::path vtu_path("./" + case_name + "/vtu");
-			boost::filesystem::create_directory(vtu_path);
+			if (!boost::filesystem::is_directory(vtu_path))
+			  boost::filesystem::create_directory(vtu_path);
     } // end mpi==0
+    MPI_Barrier(mpi_communicator);
   }  // eom
 
 
@@ -338,7 +439,7 @@ namespace EagleFrac
 		std::vector<double> phi_values(n_q_points);
 		// Vector<double>      local_pressure_vector(dofs_per_cell);
 
-		phase_field_solver.relevant_solution = phase_field_solver.solution;
+		phase_field_solver.update_relevant_solution();
 
 	  typename DoFHandler<dim>::active_cell_iterator
 		  pressure_cell = pressure_dof_handler.begin_active(),
@@ -376,14 +477,42 @@ namespace EagleFrac
 
 
   template <int dim>
-  void PDSSolid<dim>::run()
+  void PDSSolid<dim>::run(const unsigned int n_threads,
+                          const bool         restart)
   {
     data.read_input_file(input_file_name);
+    // command line overrides the input file
+    if (n_threads > 0)
+      data.n_threads = n_threads;
+    MultithreadInfo::set_thread_limit(data.n_threads);
+    pcout << "Threads per process " << MultithreadInfo::n_threads() << std::endl;
+    load_balancer.set_parameters(data.fracture_cell_weight,
+                                 data.load_imbalance_tolerance,
+                                 data.load_balancing_interval);
+    time_step_controller.set_parameters(data.target_newton_steps,
+                                        data.target_newton_contraction,
+                                        data.time_step_growth_factor,
+                                        data.time_step_cut_factor,
+                                        data.extrapolate_initial_guess);
     read_mesh();
     data.print_parameters();
 
     // return;
-    prepare_output_directories();
+    prepare_output_directories(restart);
+    output_writer.set_parameters("./" + case_name, data.output_format,
+                                 data.output_interval, data.output_time_interval,
+                                 data.output_fields, data.asynchronous_output,
+                                 data.output_compression);
+    // per-step timings and solver statistics
+    const char *sections[] = {"solid", "width", "adaptivity", "output"};
+    for (const char *section : sections)
+      performance_log.add_section(section);
+    const char *counters[] = {"step_attempts", "newton_steps",
+                              "solid_linear_iterations", "width_iterations",
+                              "active_set", "active_cells", "solid_dofs"};
+    for (const char *counter : counters)
+      performance_log.add_counter(counter);
+    performance_log.set_file("./" + case_name + "/performance.csv", restart);
 
     // compute_runtime_parameters
     double minimum_mesh_size = Mesher::compute_minimum_mesh_size(triangulation,
@@ -396,19 +525,36 @@ namespace EagleFrac
     data.compute_mesh_dependent_parameters(minimum_mesh_size);
     pcout << "min mesh size " << minimum_mesh_size << std::endl;
 
-    // Global refinetement
-    triangulation.refine_global(data.initial_refinement_level);
-		setup_dofs();
+    double time = 0;
+    double time_step = data.get_time_step(time);
+    double old_time_step = time_step;
+    int time_step_number = 0;
 
-    // local prerefinement
-		for (int ref_step=0; ref_step<data.n_adaptive_steps; ++ref_step)
-      {
-        pcout << "Local_prerefinement" << std::endl;
-        Mesher::refine_region(triangulation,
-                              data.local_prerefinement_region,
-                              1);
-        setup_dofs();
-      }
+    if (restart)
+    {
+      const Checkpoint::TimeState state = load_checkpoint();
+      time = state.time;
+      time_step = state.time_step;
+      old_time_step = state.old_time_step;
+      time_step_number = state.time_step_number;
+      time_step_controller.restore(state.controlled_time_step);
+    }
+    else
+    {
+      // Global refinetement
+      triangulation.refine_global(data.initial_refinement_level);
+			setup_dofs();
+
+      // local prerefinement
+			for (int ref_step=0; ref_step<data.n_adaptive_steps; ++ref_step)
+        {
+          pcout << "Local_prerefinement" << std::endl;
+          Mesher::refine_region(triangulation,
+                                data.local_prerefinement_region,
+                                1);
+          setup_dofs();
+        }
+    }
 
 		// point phase_field_solver to pressure objects
   	const FEValuesExtractors::Scalar pressure_extractor(0);
@@ -418,34 +564,36 @@ namespace EagleFrac
 		phase_field_solver.decompose_stress = 2;
 
     // Initial values
-		VectorTools::interpolate
-			(phase_field_solver.dof_handler,
-			 InitialValues::Defects<dim>(data.defect_coordinates,
-																	 // data.regularization_parameter_epsilon/2),
-																	 2*minimum_mesh_size),
-																	 // 4*minimum_mesh_size),
-																	 // data.regularization_parameter_epsilon),
-			 phase_field_solver.solution);
+    if (!restart)
+			VectorTools::interpolate
+				(phase_field_solver.dof_handler,
+				 InitialValues::Defects<dim>(data.defect_coordinates,
+																		 // data.regularization_parameter_epsilon/2),
+																		 2*minimum_mesh_size),
+																		 // 4*minimum_mesh_size),
+																		 // data.regularization_parameter_epsilon),
+				 phase_field_solver.solution);
 
     // phase_field_solver.solution.block(1) = 1;
     // phase_field_solver.solution.block(0) = 0;
     // phase_field_solver.old_solution.block(1) = phase_field_solver.solution.block(1);
 
-    double time = 0;
-    double time_step = data.get_time_step(time);
-    double old_time_step = time_step;
-    int time_step_number = 0;
-
     while(time < data.t_max)
     {
-      time_step = data.get_time_step(time);
+      time_step = time_step_controller.next_time_step(data.get_time_step(time));
       time += time_step;
       time_step_number++;
 
       phase_field_solver.update_old_solution();
+      time_step_controller.initial_guess(phase_field_solver.solution,
+                                         phase_field_solver.old_solution,
+                                         phase_field_solver.old_old_solution,
+                                         time_step, old_time_step);
 
 
     redo_time_step:
+      performance_log.add("step_attempts", 1);
+      time_step_controller.begin_attempt();
       pcout << std::endl
             << "Time: "
             << std::defaultfloat << time
@@ -463,11 +611,12 @@ namespace EagleFrac
       impose_displacement_on_solution(time);
       std::pair<double,double> time_steps = std::make_pair(time_step, old_time_step);
 
-      IndexSet old_active_set(phase_field_solver.active_set);
 
 			print_header();
+      performance_log.start("solid");
       int newton_step = 0;
       const double newton_tolerance = data.newton_tolerance;
+      phase_field_solver.forcing_term.reset();
       while (newton_step < data.max_newton_iter)
       {
 				pcout << newton_step << "\t";
@@ -484,6 +633,7 @@ namespace EagleFrac
           phase_field_solver.compute_active_set(phase_field_solver.solution);
           phase_field_solver.all_constraints.set_zero(phase_field_solver.residual);
           error = phase_field_solver.residual_norm();
+          time_step_controller.newton_residual(error);
 
 					// print active set and error
           pcout << phase_field_solver.active_set_size()
@@ -493,36 +643,40 @@ namespace EagleFrac
           std::cout.unsetf(std::ios_base::scientific);
 
           // break condition
-          if (phase_field_solver.active_set_changed(old_active_set) &&
+          if (phase_field_solver.active_set_changes() == 0 &&
               error < newton_tolerance)
           {
             pcout << "Converged!" << std::endl;
             break;
           }
-
-          old_active_set = phase_field_solver.active_set;
         }  // end first newton step condition
 
 				std::pair<unsigned int, unsigned int> newton_step_results =
 					phase_field_solver.solve_coupled_newton_step(
 						pressure_relevant_solution, time_steps);
-				phase_field_solver.relevant_solution =
-					phase_field_solver.solution;
+				phase_field_solver.update_relevant_solution();
 
 				pcout << newton_step_results.first << "\t";
 				pcout << newton_step_results.second << "\t";
+				performance_log.add("solid_linear_iterations",
+				                    newton_step_results.first);
         // output_results(newton_step);
         newton_step++;
 
         pcout << std::endl;
       }  // End Newton iter
+      performance_log.stop("solid");
+      performance_log.add("newton_steps", newton_step);
+      time_step_controller.end_solve(newton_step);
 
       // cut the time step if no convergence
       if (newton_step == data.max_newton_iter)
       {
+        const double new_time_step =
+          time_step_controller.reject(time_step, newton_step);
         pcout << "Time step didn't converge: reducing to dt = "
-              << time_step/10 << std::endl;
-        if (time_step/10 < data.minimum_time_step)
+              << new_time_step << std::endl;
+        if (new_time_step < data.minimum_time_step)
         {
           pcout << "Time step too small: aborting" << std::endl;
           std::cout.unsetf(std::ios_base::scientific);
@@ -530,41 +684,50 @@ namespace EagleFrac
         }
 
         time -= time_step;
-        time_step /= 10.0;
+        time_step = new_time_step;
         time += time_step;
-        phase_field_solver.solution = phase_field_solver.old_solution;
+        time_step_controller.initial_guess(phase_field_solver.solution,
+                                           phase_field_solver.old_solution,
+                                           phase_field_solver.old_old_solution,
+                                           time_step, old_time_step);
         phase_field_solver.use_old_time_step_phi = true;
         goto redo_time_step;
       }  // end cut time step
 
       // do adaptive refinement if needed
       if (data.n_adaptive_steps > 0)
-        if (Mesher::prepare_phase_field_refinement(phase_field_solver,
-                                                   data.phi_refinement_value,
-                                                   max_refinement_level))
+      {
+        performance_log.start("adaptivity");
+        const bool redo =
+          Mesher::adapt_phase_field_mesh(phase_field_solver, data,
+                                         max_refinement_level, pcout,
+                                         [this]{exectute_adaptive_refinement();});
+        performance_log.stop("adaptivity");
+        if (redo)
         {
-          pcout << std::endl
-               << "Adapting mesh"
-               << std::endl
-							 << "Redo time step"
-               << std::endl;
-          exectute_adaptive_refinement();
+          pcout << "Redo time step" << std::endl;
           goto redo_time_step;
         }
+      }  // end adaptive refinement
 
       { // Solve for width
-				phase_field_solver.relevant_solution =
-					phase_field_solver.solution;
+        performance_log.start("width");
+				phase_field_solver.update_relevant_solution();
         // width_solver.compute_level_set(phase_field_solver.relevant_solution);
         width_solver.assemble_system(phase_field_solver.relevant_solution);
         const unsigned int n_solver_steps = width_solver.solve_system();
         pcout << "Width Solver: " << n_solver_steps << " steps" << std::endl;
         width_solver.relevant_solution = width_solver.solution;
+        performance_log.add("width_iterations", n_solver_steps);
+        performance_log.stop("width");
       }
+      time_step_controller.accept(time_step);
 
       // phase_field_solver.truncate_phase_field();
+      performance_log.start("output");
       output_results(time_step_number, time);
       execute_postprocessing(time_step_number, time);
+      performance_log.stop("output");
       // return;
 
       // phase_field_solver.use_old_time_step_phi = false;
@@ -572,8 +735,38 @@ namespace EagleFrac
 
       old_time_step = time_step;
 
+      if (load_balancer.need_rebalance(time_step_number,
+                                       phase_field_solver.local_assembly_time()))
+      {
+        pcout << "Rebalancing, load imbalance "
+              << load_balancer.get_imbalance() << std::endl;
+        performance_log.start("adaptivity");
+        exectute_adaptive_refinement();
+        performance_log.stop("adaptivity");
+      }
+
+      performance_log.set("active_set", phase_field_solver.active_set_size());
+      performance_log.set("active_cells", triangulation.n_global_active_cells());
+      performance_log.set("solid_dofs", phase_field_solver.dof_handler.n_dofs());
+      performance_log.end_step(time_step_number, time, time_step);
+
+      if (data.checkpoint_interval > 0 &&
+          time_step_number % data.checkpoint_interval == 0)
+      {
+        Checkpoint::TimeState state;
+        state.time = time;
+        state.time_step = time_step;
+        state.old_time_step = old_time_step;
+        state.time_step_number = time_step_number;
+        state.times_and_names = times_and_names;
+        state.controlled_time_step = time_step_controller.proposed_time_step();
+        save_checkpoint(state);
+      }
+
       if (time >= data.t_max) break;
     }  // end time loop
+    time_step_controller.print_statistics(pcout);
+    phase_field_solver.forcing_term.print_statistics(pcout, "Solid solver");
 
     // pcout << std::fixed;
     // show timer table in default format
@@ -585,7 +778,38 @@ namespace EagleFrac
   void PDSSolid<dim>::execute_postprocessing(const unsigned int time_step_number,
 																						 const double time)
   {
-    // just some commands so no compiler warnings
+    // register the quantities in the order of the functions
+    if (postprocessor.n_quantities() == 0)
+      for (unsigned int i=0; i<data.postprocessing_function_names.size(); i++)
+      {
+        unsigned int l = data.postprocessing_function_names[i].size();
+        if (data.postprocessing_function_names[i].compare(0, l, "boundary_load") == 0)
+          postprocessor.add_boundary_load
+            (boost::get<int>(data.postprocessing_function_args[i][0]));
+        else if
+          (data.postprocessing_function_names[i].compare(0, l, "COD") == 0)
+        {
+          const double start =
+            boost::get<double>(data.postprocessing_function_args[i][0]);
+          const double end =
+            boost::get<double>(data.postprocessing_function_args[i][1]);
+          const unsigned int n_lines =
+            boost::get<int>(data.postprocessing_function_args[i][2]);
+          const unsigned int direction =
+            boost::get<int>(data.postprocessing_function_args[i][3]);
+          std::vector<double> lines(n_lines);
+          for (unsigned int k=0; k<n_lines; ++k)
+            lines[k] = start + (end-start)/(n_lines-1)*k;
+          postprocessor.add_cod(lines, direction);
+        }
+      }
+    if (postprocessor.n_quantities() == 0)
+      return;
+
+    // all quantities in one pass
+    postprocessor.evaluate(phase_field_solver, data);
+
+    unsigned int handle = 0;
     for (unsigned int i=0; i<data.postprocessing_function_names.size(); i++)
     {
       unsigned int l = data.postprocessing_function_names[i].size();
@@ -593,9 +817,7 @@ namespace EagleFrac
       {
         int boundary_id =
             boost::get<int>(data.postprocessing_function_args[i][0]);
-        Tensor<1,dim> load =
-          Postprocessing::compute_boundary_load(phase_field_solver,
-                                                data, boundary_id);
+        const Tensor<1,dim> load = postprocessor.get_boundary_load(handle++);
         // Sum write output
         if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
         {
@@ -619,14 +841,7 @@ namespace EagleFrac
 					boost::get<double>(data.postprocessing_function_args[i][1]);
 				const unsigned int n_lines =
 					boost::get<int>(data.postprocessing_function_args[i][2]);
-				const unsigned int direction =
-					boost::get<int>(data.postprocessing_function_args[i][3]);
-				std::vector<double> lines(n_lines);
-				for (unsigned int k=0; k<n_lines; ++k)
-					lines[k] = start + (end-start)/(n_lines-1)*k;
-
-				Vector<double> cod_values = Postprocessing::compute_cod
-					(phase_field_solver, lines, mpi_communicator, direction);
+				const Vector<double> cod_values = postprocessor.get_cod(handle++);
 
         if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
         {
@@ -636,7 +851,8 @@ namespace EagleFrac
                   ".txt",
                   std::ios_base::app);
 					for (unsigned int k=0; k<n_lines; ++k)
-						ff << lines[k] << "\t" << cod_values[k] << std::endl;
+						ff << start + (end-start)/(n_lines-1)*k << "\t"
+						   << cod_values[k] << std::endl;
         }  // end process==0
 			}  // end COD function
     }  // end loop over postprocessing functions
@@ -646,6 +862,9 @@ namespace EagleFrac
   template <int dim>
   void PDSSolid<dim>::output_results(int time_step_number, double time)
   {
+    if (!output_writer.need_output(time_step_number, time))
+      return;
+
     // Add data vectors to output
     std::vector<std::string> solution_names(dim, "displacement");
     solution_names.push_back("phase_field");
@@ -658,85 +877,55 @@ namespace EagleFrac
     DataOut<dim> data_out;
     phase_field_solver.relevant_solution = phase_field_solver.solution;
     data_out.attach_dof_handler(phase_field_solver.dof_handler);
-    data_out.add_data_vector(phase_field_solver.relevant_solution,
-                             solution_names,
-                             DataOut<dim>::type_dof_data,
-                             data_component_interpretation);
+    if (output_writer.write_field("solution"))
+      data_out.add_data_vector(phase_field_solver.relevant_solution,
+                               solution_names,
+                               DataOut<dim>::type_dof_data,
+                               data_component_interpretation);
     // add active set
-    data_out.add_data_vector(phase_field_solver.active_set, "active_set");
+    if (output_writer.write_field("active_set"))
+      data_out.add_data_vector(phase_field_solver.active_set, "active_set");
     // data_out.add_data_vector(phase_field_solver.residual, "residual");
     // Add domain ids
-    Vector<float> subdomain(triangulation.n_active_cells());
-    for (unsigned int i=0; i<subdomain.size(); ++i)
-      subdomain(i) = triangulation.locally_owned_subdomain();
-    data_out.add_data_vector(subdomain, "subdomain");
+    Vector<float> subdomain;
+    if (output_writer.write_field("subdomain"))
+    {
+      subdomain.reinit(triangulation.n_active_cells());
+      for (unsigned int i=0; i<subdomain.size(); ++i)
+        subdomain(i) = triangulation.locally_owned_subdomain();
+      data_out.add_data_vector(subdomain, "subdomain");
+    }
 		// Add pressure
-		data_out.add_data_vector(pressure_dof_handler,
-														 pressure_relevant_solution,
-														 "pressure");
+		if (output_writer.write_field("pressure"))
+			data_out.add_data_vector(pressure_dof_handler,
+															 pressure_relevant_solution,
+															 "pressure");
 
     // compute stresses
-    phase_field_solver.get_stresses(stresses);
-    data_out.add_data_vector(stresses[0], "sigma_xx");
-    data_out.add_data_vector(stresses[1], "sigma_yy");
+    if (output_writer.write_field("stresses"))
+    {
+      phase_field_solver.get_stresses(stresses);
+      data_out.add_data_vector(stresses[0], "sigma_xx");
+      data_out.add_data_vector(stresses[1], "sigma_yy");
+    }
 
     // Add width
 		auto & width_dof_handler = width_solver.get_dof_handler();
-		data_out.add_data_vector(width_dof_handler,
-														 width_solver.relevant_solution,
-														 "width");
+		if (output_writer.write_field("width"))
+			data_out.add_data_vector(width_dof_handler,
+															 width_solver.relevant_solution,
+															 "width");
     // data_out.add_data_vector(width_solver.material_ids, "ID");
 
     data_out.build_patches();
-
-    int n_time_step_digits = 3,
-        n_processor_digits = 3;
-
-    // Write output from local processors
-    const std::string filename = ("./" + case_name + "/vtu/solution-" +
-                                  Utilities::int_to_string(time_step_number,
-                                                           n_time_step_digits) +
-                                  "." +
-                                  Utilities::int_to_string
-                                  (triangulation.locally_owned_subdomain(),
-                                   n_processor_digits));
-    std::ofstream output ((filename + ".vtu").c_str());
-    data_out.write_vtu(output);
-
-    // Write master file
-    if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
-    {
-      std::vector<std::string> filenames;
-      for (unsigned int i=0;
-           i<Utilities::MPI::n_mpi_processes(mpi_communicator);
-           ++i)
-        filenames.push_back("solution-" +
-                            Utilities::int_to_string(time_step_number,
-                                                     n_time_step_digits) +
-                            "." +
-                            Utilities::int_to_string (i,
-                                                      n_processor_digits) +
-                            ".vtu");
-      std::string pvtu_filename =
-			  "solution-" +
-        Utilities::int_to_string(time_step_number, n_time_step_digits) +
-        ".pvtu";
-      std::ofstream
-        master_output(("./" + case_name + "/vtu/" + pvtu_filename).c_str());
-      data_out.write_pvtu_record(master_output, filenames);
-
-			// write pvd file
-			const std::string pvd_filename = "solution.pvd";
-			times_and_names.push_back
-				(std::pair<double,std::string> (time, "./vtu/" + pvtu_filename) );
-			std::ofstream pvd_master(("./" + case_name + "/" + pvd_filename).c_str());
-			data_out.write_pvd_record(pvd_master, times_and_names);
-    }  // end master output
+    output_writer.write(data_out, time_step_number, time, times_and_names);
   } // EOM
 }  // end of namespace
 
 
-std::string parse_command_line(int argc, char *const *argv) {
+std::string parse_command_line(int argc, char *const *argv,
+                               unsigned int &n_threads,
+                               bool         &restart) {
   std::string filename;
   if (argc < 2) {
     std::cout << "specify the file name" << std::endl;
@@ -750,6 +939,23 @@ std::string parse_command_line(int argc, char *const *argv) {
   int arg_number = 1;
   while (args.size()){
     // std::cout << args.front() << std::endl;
+    if (args.front() == std::string("-threads"))
+    {  // -threads N: number of threads per MPI process
+      args.pop_front();
+      if (args.size() == 0) {
+        std::cout << "specify the number of threads after -threads" << std::endl;
+        exit(1);
+      }
+      n_threads = Utilities::string_to_int(args.front());
+      args.pop_front();
+      continue;
+    }
+    if (args.front() == std::string("-restart"))
+    {  // continue from the last checkpoint of this case
+      args.pop_front();
+      restart = true;
+      continue;
+    }
     if (arg_number == 1)
       filename = args.front();
     args.pop_front();
@@ -765,9 +971,11 @@ int main(int argc, char *argv[])
   {
     using namespace dealii;
     Utilities::MPI::MPI_InitFinalize mpi_initialization(argc, argv, 1);
-    std::string input_file_name = parse_command_line(argc, argv);
+    unsigned int n_threads = 0;
+    bool restart = false;
+    std::string input_file_name = parse_command_line(argc, argv, n_threads, restart);
     EagleFrac::PDSSolid<2> problem(input_file_name);
-    problem.run();
+    problem.run(n_threads, restart);
     return 0;
   }
   catch (std::exception &exc)
@@ -1,4 +1,5 @@
 #include <deal.II/base/utilities.h>
+#include <deal.II/base/multithread_info.h>
 #include <deal.II/grid/grid_generator.h>
 #include <deal.II/numerics/data_out.h>
 #include <deal.II/distributed/solution_transfer.h>
@@ -12,8 +13,13 @@
 // Custom modules
 #include <PhaseFieldSolver.hpp>
 #include <Postprocessing.hpp>
+#include <PostprocessingPipeline.hpp>
 #include <InputData.hpp>
 #include <Mesher.hpp>
+#include <LoadBalancer.hpp>
+#include <OutputWriter.hpp>
+#include <PerformanceLog.hpp>
+#include <TimeStepController.hpp>
 
 
 namespace EagleFrac
@@ -28,7 +34,7 @@ namespace EagleFrac
     PDSSolid(const std::string &input_file_name_);
     ~PDSSolid();
 
-    void run();
+    void run(const unsigned int n_threads = 0);
 
   private:
     void create_mesh();
@@ -53,6 +59,11 @@ namespace EagleFrac
     std::string input_file_name, case_name;
 
 		std::vector< std::pair<double,std::string> > times_and_names;
+		Output::Writer output_writer;
+    Mesher::LoadBalancer<dim> load_balancer;
+    Output::PerformanceLog performance_log;
+    TimeStepping::TimeStepController time_step_controller;
+    Postprocessing::Pipeline<dim> postprocessor;
     std::vector< Vector<double> > stresses;
   };
 
@@ -75,7 +86,10 @@ namespace EagleFrac
     phase_field_solver(mpi_communicator,
                        triangulation, data,
                        pcout, computing_timer),
-    input_file_name(input_file_name_)
+    input_file_name(input_file_name_),
+    output_writer(mpi_communicator),
+    load_balancer(triangulation, mpi_communicator),
+    performance_log(mpi_communicator)
   {}
 
 
@@ -139,7 +153,13 @@ namespace EagleFrac
   template <int dim>
   void PDSSolid<dim>::exectute_adaptive_refinement()
   {
+    postprocessor.clear_mesh_data();
     phase_field_solver.relevant_solution = phase_field_solver.solution;
+    // weighted partition of the new mesh; without refinement flags
+    // execute_coarsening_and_refinement only repartitions
+    load_balancer.update_weights(phase_field_solver.dof_handler,
+                                 phase_field_solver.relevant_solution,
+                                 data.phi_refinement_value);
     std::vector<const TrilinosWrappers::MPI::BlockVector *> tmp(3);
     tmp[0] = &phase_field_solver.relevant_solution;
     tmp[1] = &phase_field_solver.old_solution;
@@ -206,12 +226,39 @@ namespace EagleFrac
   }  // eom
 
   template <int dim>
-  void PDSSolid<dim>::run()
+  void PDSSolid<dim>::run(const unsigned int n_threads)
   {
     data.read_input_file(input_file_name);
+    // command line overrides the input file
+    if (n_threads > 0)
+      data.n_threads = n_threads;
+    MultithreadInfo::set_thread_limit(data.n_threads);
+    pcout << "Threads per process " << MultithreadInfo::n_threads() << std::endl;
+    load_balancer.set_parameters(data.fracture_cell_weight,
+                                 data.load_imbalance_tolerance,
+                                 data.load_balancing_interval);
+    time_step_controller.set_parameters(data.target_newton_steps,
+                                        data.target_newton_contraction,
+                                        data.time_step_growth_factor,
+                                        data.time_step_cut_factor,
+                                        data.extrapolate_initial_guess);
     read_mesh();
 
     prepare_output_directories();
+    output_writer.set_parameters("./" + case_name, data.output_format,
+                                 data.output_interval, data.output_time_interval,
+                                 data.output_fields, data.asynchronous_output,
+                                 data.output_compression);
+    // per-step timings and solver statistics
+    const char *sections[] = {"solid", "adaptivity", "output"};
+    for (const char *section : sections)
+      performance_log.add_section(section);
+    const char *counters[] = {"step_attempts", "newton_steps",
+                              "solid_linear_iterations", "active_set",
+                              "active_cells", "solid_dofs"};
+    for (const char *counter : counters)
+      performance_log.add_counter(counter);
+    performance_log.set_file("./" + case_name + "/performance.csv", false);
 
     // compute_runtime_parameters
     double minimum_mesh_size = Mesher::compute_minimum_mesh_size(triangulation,
@@ -251,13 +298,19 @@ namespace EagleFrac
 
     while(time < data.t_max)
     {
-      time_step = data.get_time_step(time);
+      time_step = time_step_controller.next_time_step(data.get_time_step(time));
       time += time_step;
       time_step_number++;
 
       phase_field_solver.update_old_solution();
+      time_step_controller.initial_guess(phase_field_solver.solution,
+                                         phase_field_solver.old_solution,
+                                         phase_field_solver.old_old_solution,
+                                         time_step, old_time_step);
 
     redo_time_step:
+      performance_log.add("step_attempts", 1);
+      time_step_controller.begin_attempt();
       pcout << std::endl
             << "Time: "
             << std::defaultfloat << time
@@ -277,7 +330,6 @@ namespace EagleFrac
       std::pair<double,double> time_steps = std::make_pair(time_step, old_time_step);
     	impose_displacement_on_solution(time);
 
-      IndexSet old_active_set(phase_field_solver.active_set);
 
 			pcout << "Iter #" << "\t"
 			      << "ASet" << "\t"
@@ -285,8 +337,10 @@ namespace EagleFrac
 			      << "GMRES" << "\t"
 			      << "Search" << "\t"
 						<< std::endl;
+      performance_log.start("solid");
       int newton_step = 0;
       const double newton_tolerance = data.newton_tolerance;
+      phase_field_solver.forcing_term.reset();
       while (newton_step < data.max_newton_iter)
       {
         // pcout << "Newton iteration: " << newton_step << "\t";
@@ -302,6 +356,7 @@ namespace EagleFrac
           phase_field_solver.compute_active_set(phase_field_solver.solution);
           phase_field_solver.all_constraints.set_zero(phase_field_solver.residual);
           error = phase_field_solver.residual_norm();
+          time_step_controller.newton_residual(error);
 
       	  pcout << phase_field_solver.active_set_size()
 								<< "\t";
@@ -310,14 +365,12 @@ namespace EagleFrac
           std::cout.unsetf(std::ios_base::scientific);
 
           // break condition
-          if (phase_field_solver.active_set_changed(old_active_set) &&
+          if (phase_field_solver.active_set_changes() == 0 &&
               error < newton_tolerance)
           {
             pcout << "Converged!" << std::endl;
             break;
           }
-
-          old_active_set = phase_field_solver.active_set;
         }  // end first newton step condition
 
 				std::pair<unsigned int, unsigned int> newton_step_results;
@@ -329,39 +382,51 @@ namespace EagleFrac
 				catch (SolverControl::NoConvergence e)
 				{
 					computing_timer.exit_section();
+					const double new_time_step =
+					  time_step_controller.reject(time_step, newton_step);
 					pcout << "linear solver didn't converge!"
 								<< std::endl
-								<< "Adjusting time step to " << time_step/10
+								<< "Adjusting time step to " << new_time_step
 								<< std::endl;
 					time -= time_step;
-					time_step /= 10;
-	        if (time_step/10 < data.minimum_time_step)
+					time_step = new_time_step;
+	        if (time_step < data.minimum_time_step)
 	        {
 	          pcout << "Time step too small: aborting" << std::endl;
 	          std::cout.unsetf(std::ios_base::scientific);
 	          throw SolverControl::NoConvergence(0, 0);
 	        }
 					time += time_step;
-					phase_field_solver.solution = phase_field_solver.old_solution;
+					time_step_controller.initial_guess(phase_field_solver.solution,
+					                                   phase_field_solver.old_solution,
+					                                   phase_field_solver.old_old_solution,
+					                                   time_step, old_time_step);
 					phase_field_solver.use_old_time_step_phi = true;
 					goto redo_time_step;
 				}
 
 				pcout << newton_step_results.first << "\t";
 				pcout << newton_step_results.second << "\t";
+				performance_log.add("solid_linear_iterations",
+				                    newton_step_results.first);
 
         // output_results(newton_step);
 				// pcout << "here" << std::endl;
 				newton_step++;
         pcout << std::endl;
       }  // End Newton iter
+      performance_log.stop("solid");
+      performance_log.add("newton_steps", newton_step);
+      time_step_controller.end_solve(newton_step);
 
       // cut the time step if no convergence
       if (newton_step == data.max_newton_iter)
       {
+        const double new_time_step =
+          time_step_controller.reject(time_step, newton_step);
         pcout << "Time step didn't converge: reducing to dt = "
-              << time_step/10 << std::endl;
-        if (time_step/10 < data.minimum_time_step)
+              << new_time_step << std::endl;
+        if (new_time_step < data.minimum_time_step)
         {
           pcout << "Time step too small: aborting" << std::endl;
           std::cout.unsetf(std::ios_base::scientific);
@@ -369,37 +434,63 @@ namespace EagleFrac
         }
 
         time -= time_step;
-        time_step /= 10.0;
+        time_step = new_time_step;
         time += time_step;
-        phase_field_solver.solution = phase_field_solver.old_solution;
+        time_step_controller.initial_guess(phase_field_solver.solution,
+                                           phase_field_solver.old_solution,
+                                           phase_field_solver.old_old_solution,
+                                           time_step, old_time_step);
         phase_field_solver.use_old_time_step_phi = true;
         goto redo_time_step;
       }
 
       // do adaptive refinement if needed
       if (data.n_adaptive_steps > 0)
-        if (Mesher::prepare_phase_field_refinement(phase_field_solver,
-                                                   data.phi_refinement_value,
-                                                   max_refinement_level))
+      {
+        performance_log.start("adaptivity");
+        const bool redo =
+          Mesher::adapt_phase_field_mesh(phase_field_solver, data,
+                                         max_refinement_level, pcout,
+                                         [this]{exectute_adaptive_refinement();});
+        performance_log.stop("adaptivity");
+        if (redo)
         {
-          pcout << std::endl
-               << "Adapting mesh"
-               << std::endl;
-          exectute_adaptive_refinement();
+          pcout << "Redo time step" << std::endl;
           goto redo_time_step;
         }
+      }  // end adaptive refinement
+      time_step_controller.accept(time_step);
 
       // phase_field_solver.truncate_phase_field();
+      performance_log.start("output");
       output_results(time_step_number, time);
       execute_postprocessing(time);
+      performance_log.stop("output");
       // return;
 
       phase_field_solver.use_old_time_step_phi = true;
 
       old_time_step = time_step;
 
+      if (load_balancer.need_rebalance(time_step_number,
+                                       phase_field_solver.local_assembly_time()))
+      {
+        pcout << "Rebalancing, load imbalance "
+              << load_balancer.get_imbalance() << std::endl;
+        performance_log.start("adaptivity");
+        exectute_adaptive_refinement();
+        performance_log.stop("adaptivity");
+      }
+
+      performance_log.set("active_set", phase_field_solver.active_set_size());
+      performance_log.set("active_cells", triangulation.n_global_active_cells());
+      performance_log.set("solid_dofs", phase_field_solver.dof_handler.n_dofs());
+      performance_log.end_step(time_step_number, time, time_step);
+
       if (time >= data.t_max) break;
     }  // end time loop
+    time_step_controller.print_statistics(pcout);
+    phase_field_solver.forcing_term.print_statistics(pcout, "Solid solver");
 
     // pcout << std::fixed;
     // show timer table in default format
@@ -410,7 +501,22 @@ namespace EagleFrac
   template <int dim>
   void PDSSolid<dim>::execute_postprocessing(const double time)
   {
-    // just some commands so no compiler warnings
+    // register the quantities in the order of the functions
+    if (postprocessor.n_quantities() == 0)
+      for (unsigned int i=0; i<data.postprocessing_function_names.size(); i++)
+      {
+        unsigned int l = data.postprocessing_function_names[i].size();
+        if (data.postprocessing_function_names[i].compare(0, l, "boundary_load") == 0)
+          postprocessor.add_boundary_load
+            (boost::get<int>(data.postprocessing_function_args[i][0]));
+      }
+    if (postprocessor.n_quantities() == 0)
+      return;
+
+    // all quantities in one pass
+    postprocessor.evaluate(phase_field_solver, data);
+
+    unsigned int handle = 0;
     for (unsigned int i=0; i<data.postprocessing_function_names.size(); i++)
     {
       unsigned int l = data.postprocessing_function_names[i].size();
@@ -418,9 +524,7 @@ namespace EagleFrac
       {
         int boundary_id =
             boost::get<int>(data.postprocessing_function_args[i][0]);
-        Tensor<1,dim> load =
-          Postprocessing::compute_boundary_load(phase_field_solver,
-                                                data, boundary_id);
+        const Tensor<1,dim> load = postprocessor.get_boundary_load(handle++);
         // Sum write output
         if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
         {
@@ -443,6 +547,9 @@ namespace EagleFrac
   template <int dim>
   void PDSSolid<dim>::output_results(int time_step_number, double time) // const
   {
+    if (!output_writer.need_output(time_step_number, time))
+      return;
+
     // Add data vectors to output
     std::vector<std::string> solution_names(dim, "displacement");
     solution_names.push_back("phase_field");
@@ -455,81 +562,45 @@ namespace EagleFrac
     DataOut<dim> data_out;
     phase_field_solver.relevant_solution = phase_field_solver.solution;
     data_out.attach_dof_handler(phase_field_solver.dof_handler);
-    data_out.add_data_vector(phase_field_solver.relevant_solution,
-                             solution_names,
-                             DataOut<dim>::type_dof_data,
-                             data_component_interpretation);
+    if (output_writer.write_field("solution"))
+      data_out.add_data_vector(phase_field_solver.relevant_solution,
+                               solution_names,
+                               DataOut<dim>::type_dof_data,
+                               data_component_interpretation);
     // add active set
-    data_out.add_data_vector(phase_field_solver.active_set, "active_set");
+    if (output_writer.write_field("active_set"))
+      data_out.add_data_vector(phase_field_solver.active_set, "active_set");
     // Add domain ids
-    Vector<float> subdomain(triangulation.n_active_cells());
-    for (unsigned int i=0; i<subdomain.size(); ++i)
-      subdomain(i) = triangulation.locally_owned_subdomain();
-    data_out.add_data_vector(subdomain, "subdomain");
+    Vector<float> subdomain;
+    if (output_writer.write_field("subdomain"))
+    {
+      subdomain.reinit(triangulation.n_active_cells());
+      for (unsigned int i=0; i<subdomain.size(); ++i)
+        subdomain(i) = triangulation.locally_owned_subdomain();
+      data_out.add_data_vector(subdomain, "subdomain");
+    }
 
 		// fracture toughness if not uniform
-		Vector<double> gc_vector;
-		if (!data.uniform_fracture_toughness)
-		{
-			gc_vector.reinit(triangulation.n_active_cells());
-			data.get_property_vector(*data.get_fracture_toughness,
-															 triangulation, gc_vector);
-	  	data_out.add_data_vector(gc_vector, "toughness");
-		}
+		if (!data.uniform_fracture_toughness &&
+		    output_writer.write_field("toughness"))
+	  	data_out.add_data_vector(data.cell_properties.fracture_toughness_values(),
+	  	                         "toughness");
 
-    phase_field_solver.get_stresses(stresses);
-    data_out.add_data_vector(stresses[0], "sigma_xx");
-    data_out.add_data_vector(stresses[1], "sigma_yy");
+    if (output_writer.write_field("stresses"))
+    {
+      phase_field_solver.get_stresses(stresses);
+      data_out.add_data_vector(stresses[0], "sigma_xx");
+      data_out.add_data_vector(stresses[1], "sigma_yy");
+    }
 
     data_out.build_patches();
-
-    int n_time_step_digits = 3,
-        n_processor_digits = 3;
-
-    // Write output from local processors
-    const std::string filename = ("./" + case_name + "/vtu/solution-" +
-                                  Utilities::int_to_string(time_step_number,
-                                                           n_time_step_digits) +
-                                  "." +
-                                  Utilities::int_to_string
-                                  (triangulation.locally_owned_subdomain(),
-                                   n_processor_digits));
-    std::ofstream output ((filename + ".vtu").c_str());
-    data_out.write_vtu(output);
-
-    // Write master file
-    if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
-      {
-        std::vector<std::string> filenames;
-        for (unsigned int i=0;
-             i<Utilities::MPI::n_mpi_processes(mpi_communicator);
-             ++i)
-          filenames.push_back("solution-" +
-                              Utilities::int_to_string(time_step_number,
-                                                       n_time_step_digits) +
-                              "." +
-                              Utilities::int_to_string (i, n_processor_digits) +
-                              ".vtu");
-        std::string pvtu_filename =
-				  "solution-" +
-          Utilities::int_to_string(time_step_number, n_time_step_digits) +
-          ".pvtu";
-        std::ofstream
-          master_output(("./" + case_name + "/vtu/" + pvtu_filename).c_str());
-        data_out.write_pvtu_record(master_output, filenames);
-
-				// write pvd file
-				const std::string pvd_filename = "solution.pvd";
-				times_and_names.push_back
-					(std::pair<double,std::string> (time, "./vtu/" + pvtu_filename) );
-				std::ofstream pvd_master(("./" + case_name + "/" + pvd_filename).c_str());
-				data_out.write_pvd_record(pvd_master, times_and_names);
-      }  // end master output
+    output_writer.write(data_out, time_step_number, time, times_and_names);
   } // EOM
 }  // end of namespace
 
 
-std::string parse_command_line(int argc, char *const *argv) {
+std::string parse_command_line(int argc, char *const *argv,
+                               unsigned int &n_threads) {
   std::string filename;
   if (argc < 2) {
     std::cout << "specify the file name" << std::endl;
@@ -542,6 +613,17 @@ std::string parse_command_line(int argc, char *const *argv) {
 
   int arg_number = 1;
   while (args.size()){
+    if (args.front() == std::string("-threads"))
+    {  // -threads N: number of threads per MPI process
+      args.pop_front();
+      if (args.size() == 0) {
+        std::cout << "specify the number of threads after -threads" << std::endl;
+        exit(1);
+      }
+      n_threads = Utilities::string_to_int(args.front());
+      args.pop_front();
+      continue;
+    }
     if (arg_number == 1)
       filename = args.front();
     args.pop_front();
@@ -557,9 +639,10 @@ int main(int argc, char *argv[])
   {
     using namespace dealii;
     Utilities::MPI::MPI_InitFinalize mpi_initialization(argc, argv, 1);
-    std::string input_file_name = parse_command_line(argc, argv);
+    unsigned int n_threads = 0;
+    std::string input_file_name = parse_command_line(argc, argv, n_threads);
     EagleFrac::PDSSolid<2> problem(input_file_name);
-    problem.run();
+    problem.run(n_threads);
     return 0;
   }
   catch (std::exception &exc)
@@ -0,0 +1,315 @@
+#pragma once
+
+#include <deal.II/base/quadrature.h>
+#include <deal.II/base/tensor.h>
+#include <deal.II/distributed/tria.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/fe/fe_system.h>
+#include <deal.II/fe/fe_values.h>
+#include <deal.II/lac/vector.h>
+
+#include <vector>
+#include <cstring>     // std::memcmp
+
+
+namespace PhaseField
+{
+  using namespace dealii;
+
+  /*
+    This class stores the data that PhaseFieldSolver::assemble_coupled_system
+    needs in every call but which only depends on the mesh:
+    JxW values and gradients of the scalar base shape functions in quadrature
+    points. Material constants are read from PhaseFieldData::cell_properties.
+    It also keeps the strain and the split stress tensors in quadrature points
+    together with the displacement dof values they were computed from, so
+    the split is only recomputed in cells where the displacement changed.
+
+    All cell arrays are flat and indexed with cell->active_cell_index().
+    The cache is cleared in setup_dofs, i.e., after every mesh change.
+   */
+  template <int dim>
+  class AssemblyCache
+  {
+  public:
+    AssemblyCache();
+
+    void clear();
+    bool is_initialized() const;
+    void reinit(const DoFHandler<dim> &dof_handler,
+                const Quadrature<dim> &quadrature);
+
+    // drop stored strains and stresses (e.g. when the split model changes)
+    void invalidate_stress_state(const int stress_split);
+    int  get_stress_split() const;
+
+    // true if the stress state in the cell was computed from
+    // the same displacement values as in local_solution
+    bool stress_state_valid(const unsigned int    cell_index,
+                            const Vector<double> &local_solution) const;
+    void store_stress_state_key(const unsigned int    cell_index,
+                                const Vector<double> &local_solution);
+
+    // Geometry
+    unsigned int n_quadrature_points() const;
+    unsigned int system_component(const unsigned int k) const;
+    double shape_value(const unsigned int k, const unsigned int q) const;
+    const Tensor<1,dim> & shape_grad(const unsigned int cell_index,
+                                     const unsigned int k,
+                                     const unsigned int q) const;
+    double JxW(const unsigned int cell_index, const unsigned int q) const;
+
+    // Stress state
+    Tensor<2,dim> & strain(const unsigned int cell_index, const unsigned int q);
+    Tensor<2,dim> & stress_plus(const unsigned int cell_index, const unsigned int q);
+    Tensor<2,dim> & stress_minus(const unsigned int cell_index, const unsigned int q);
+
+  private:
+    bool         initialized;
+    int          stress_split;
+    unsigned int n_q_points, n_base_dofs, dofs_per_cell, n_u_dofs;
+
+    // system dof -> (component, index of base shape function)
+    std::vector<unsigned int>    component, base_index;
+    // reference values of the base shape functions [q][base]
+    std::vector<double>          base_values;
+    // [cell][q] and [cell][q][base]
+    std::vector<double>          jxw_values;
+    std::vector< Tensor<1,dim> > base_gradients;
+    // [cell][q]
+    std::vector< Tensor<2,dim> > strain_values, stress_plus_values,
+                                 stress_minus_values;
+    // displacement dof values the state was computed from [cell][u dof]
+    std::vector<double>          state_key;
+    // not std::vector<bool>: cells are written concurrently
+    std::vector<unsigned char>   state_valid;
+  };
+
+
+  template <int dim>
+  AssemblyCache<dim>::AssemblyCache()
+  :
+  initialized(false),
+  stress_split(-1),
+  n_q_points(0),
+  n_base_dofs(0),
+  dofs_per_cell(0),
+  n_u_dofs(0)
+  {}  // eom
+
+
+  template <int dim>
+  void AssemblyCache<dim>::clear()
+  {
+    initialized = false;
+    stress_split = -1;
+    component.clear();
+    base_index.clear();
+    base_values.clear();
+    jxw_values.clear();
+    base_gradients.clear();
+    strain_values.clear();
+    stress_plus_values.clear();
+    stress_minus_values.clear();
+    state_key.clear();
+    state_valid.clear();
+  }  // eom
+
+
+  template <int dim>
+  bool AssemblyCache<dim>::is_initialized() const
+  {
+    return initialized;
+  }  // eom
+
+
+  template <int dim>
+  void AssemblyCache<dim>::
+  reinit(const DoFHandler<dim> &dof_handler,
+         const Quadrature<dim> &quadrature)
+  {
+    clear();
+
+    const FiniteElement<dim> &fe = dof_handler.get_fe();
+    // displacement and phase-field are discretized with the same element
+    const FiniteElement<dim> &base_fe = fe.base_element(0);
+    AssertThrow(fe.n_base_elements() == 2 &&
+                base_fe.dofs_per_cell == fe.base_element(1).dofs_per_cell,
+                ExcMessage("AssemblyCache expects equal displacement "
+                           "and phase-field elements"));
+
+    n_q_points = quadrature.size();
+    n_base_dofs = base_fe.dofs_per_cell;
+    dofs_per_cell = fe.dofs_per_cell;
+    n_u_dofs = dim*n_base_dofs;
+
+    component.resize(dofs_per_cell);
+    base_index.resize(dofs_per_cell);
+    for (unsigned int k=0; k<dofs_per_cell; ++k)
+    {
+      component[k] = fe.system_to_component_index(k).first;
+      base_index[k] = fe.system_to_component_index(k).second;
+    }
+
+    const unsigned int n_cells = dof_handler.get_triangulation().n_active_cells();
+    jxw_values.resize(n_cells*n_q_points);
+    base_gradients.resize(n_cells*n_q_points*n_base_dofs);
+    strain_values.resize(n_cells*n_q_points);
+    stress_plus_values.resize(n_cells*n_q_points);
+    stress_minus_values.resize(n_cells*n_q_points);
+    state_key.resize(n_cells*n_u_dofs);
+    state_valid.resize(n_cells, 0);
+
+    FEValues<dim> fe_values(base_fe, quadrature,
+                            update_values | update_gradients |
+                            update_JxW_values);
+
+    bool reference_values_stored = false;
+    base_values.resize(n_q_points*n_base_dofs);
+
+    typename DoFHandler<dim>::active_cell_iterator
+      cell = dof_handler.begin_active(),
+      endc = dof_handler.end();
+
+    for (; cell!=endc; ++cell)
+      if (cell->is_locally_owned())
+      {
+        const unsigned int c = cell->active_cell_index();
+        fe_values.reinit(typename Triangulation<dim>::cell_iterator(cell));
+
+        if (!reference_values_stored)
+        {  // shape values don't depend on the cell
+          for (unsigned int q=0; q<n_q_points; ++q)
+            for (unsigned int b=0; b<n_base_dofs; ++b)
+              base_values[q*n_base_dofs + b] = fe_values.shape_value(b, q);
+          reference_values_stored = true;
+        }
+
+        for (unsigned int q=0; q<n_q_points; ++q)
+        {
+          jxw_values[c*n_q_points + q] = fe_values.JxW(q);
+          for (unsigned int b=0; b<n_base_dofs; ++b)
+            base_gradients[(c*n_q_points + q)*n_base_dofs + b] =
+              fe_values.shape_grad(b, q);
+        }
+      }  // end cell loop
+
+    initialized = true;
+  }  // eom
+
+
+  template <int dim>
+  void AssemblyCache<dim>::invalidate_stress_state(const int stress_split_)
+  {
+    stress_split = stress_split_;
+    std::fill(state_valid.begin(), state_valid.end(), 0);
+  }  // eom
+
+
+  template <int dim>
+  int AssemblyCache<dim>::get_stress_split() const
+  {
+    return stress_split;
+  }  // eom
+
+
+  template <int dim>
+  bool AssemblyCache<dim>::
+  stress_state_valid(const unsigned int    cell_index,
+                     const Vector<double> &local_solution) const
+  {
+    if (!state_valid[cell_index])
+      return false;
+
+    const double *key = &state_key[cell_index*n_u_dofs];
+    unsigned int i = 0;
+    for (unsigned int k=0; k<dofs_per_cell; ++k)
+      if (component[k] < dim)
+      {
+        // compare bitwise: we only want to skip exactly repeated states
+        if (std::memcmp(&key[i], &local_solution[k], sizeof(double)) != 0)
+          return false;
+        ++i;
+      }
+    return true;
+  }  // eom
+
+
+  template <int dim>
+  void AssemblyCache<dim>::
+  store_stress_state_key(const unsigned int    cell_index,
+                         const Vector<double> &local_solution)
+  {
+    double *key = &state_key[cell_index*n_u_dofs];
+    unsigned int i = 0;
+    for (unsigned int k=0; k<dofs_per_cell; ++k)
+      if (component[k] < dim)
+        key[i++] = local_solution[k];
+    state_valid[cell_index] = 1;
+  }  // eom
+
+
+  template <int dim> inline
+  unsigned int AssemblyCache<dim>::n_quadrature_points() const
+  {
+    return n_q_points;
+  }  // eom
+
+
+  template <int dim> inline
+  unsigned int AssemblyCache<dim>::system_component(const unsigned int k) const
+  {
+    return component[k];
+  }  // eom
+
+
+  template <int dim> inline
+  double AssemblyCache<dim>::shape_value(const unsigned int k,
+                                         const unsigned int q) const
+  {
+    return base_values[q*n_base_dofs + base_index[k]];
+  }  // eom
+
+
+  template <int dim> inline
+  const Tensor<1,dim> &
+  AssemblyCache<dim>::shape_grad(const unsigned int cell_index,
+                                 const unsigned int k,
+                                 const unsigned int q) const
+  {
+    return base_gradients[(cell_index*n_q_points + q)*n_base_dofs + base_index[k]];
+  }  // eom
+
+
+  template <int dim> inline
+  double AssemblyCache<dim>::JxW(const unsigned int cell_index,
+                                 const unsigned int q) const
+  {
+    return jxw_values[cell_index*n_q_points + q];
+  }  // eom
+
+
+  template <int dim> inline
+  Tensor<2,dim> & AssemblyCache<dim>::strain(const unsigned int cell_index,
+                                             const unsigned int q)
+  {
+    return strain_values[cell_index*n_q_points + q];
+  }  // eom
+
+
+  template <int dim> inline
+  Tensor<2,dim> & AssemblyCache<dim>::stress_plus(const unsigned int cell_index,
+                                                  const unsigned int q)
+  {
+    return stress_plus_values[cell_index*n_q_points + q];
+  }  // eom
+
+
+  template <int dim> inline
+  Tensor<2,dim> & AssemblyCache<dim>::stress_minus(const unsigned int cell_index,
+                                                   const unsigned int q)
+  {
+    return stress_minus_values[cell_index*n_q_points + q];
+  }  // eom
+
+}  // end of namespace
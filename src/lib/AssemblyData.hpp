@@ -0,0 +1,120 @@
+#pragma once
+
+#include <deal.II/base/quadrature.h>
+#include <deal.II/base/types.h>
+#include <deal.II/base/work_stream.h>
+#include <deal.II/base/multithread_info.h>
+#include <deal.II/fe/fe_values.h>
+#include <deal.II/grid/filtered_iterator.h>
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <vector>
+
+
+/*
+  Common pieces of the threaded (WorkStream) cell loops.
+  Each solver defines its own scratch data (FEValues objects and
+  containers for solution and shape function values); the copy data that
+  carries the local matrix and rhs to the serialized local-to-global copier
+  is the same for all of them.
+ */
+namespace Assembly
+{
+  using namespace dealii;
+
+  struct CopyData
+  {
+    CopyData(const unsigned int dofs_per_cell,
+             const bool         with_matrix = true);
+
+    FullMatrix<double>                   local_matrix;
+    Vector<double>                       local_rhs;
+    std::vector<types::global_dof_index> local_dof_indices;
+  };
+
+
+  inline
+  CopyData::CopyData(const unsigned int dofs_per_cell,
+                     const bool         with_matrix)
+  :
+  local_matrix((with_matrix) ? dofs_per_cell : 0,
+               (with_matrix) ? dofs_per_cell : 0),
+  local_rhs(dofs_per_cell),
+  local_dof_indices(dofs_per_cell)
+  {}  // eom
+
+
+  /*
+    Scratch data for simple cell loops that only need one FEValues object
+   */
+  template <int dim>
+  struct FEValuesScratch
+  {
+    FEValuesScratch(const FiniteElement<dim> &fe,
+                    const Quadrature<dim>    &quadrature,
+                    const UpdateFlags         update_flags);
+    FEValuesScratch(const FEValuesScratch &scratch);
+
+    FEValues<dim> fe_values;
+  };
+
+
+  template <int dim>
+  FEValuesScratch<dim>::FEValuesScratch(const FiniteElement<dim> &fe,
+                                        const Quadrature<dim>    &quadrature,
+                                        const UpdateFlags         update_flags)
+  :
+  fe_values(fe, quadrature, update_flags)
+  {}  // eom
+
+
+  template <int dim>
+  FEValuesScratch<dim>::FEValuesScratch(const FEValuesScratch &scratch)
+  :
+  fe_values(scratch.fe_values.get_fe(),
+            scratch.fe_values.get_quadrature(),
+            scratch.fe_values.get_update_flags())
+  {}  // eom
+
+
+  /*
+    Iterator range over the locally owned active cells of a dof handler
+    for WorkStream::run
+   */
+  template <typename DoFHandlerType>
+  inline
+  FilteredIterator<typename DoFHandlerType::active_cell_iterator>
+  begin_owned(const DoFHandlerType &dof_handler)
+  {
+    return FilteredIterator<typename DoFHandlerType::active_cell_iterator>
+      (IteratorFilters::LocallyOwnedCell(), dof_handler.begin_active());
+  }  // eom
+
+
+  template <typename DoFHandlerType>
+  inline
+  FilteredIterator<typename DoFHandlerType::active_cell_iterator>
+  end_owned(const DoFHandlerType &dof_handler)
+  {
+    return FilteredIterator<typename DoFHandlerType::active_cell_iterator>
+      (IteratorFilters::LocallyOwnedCell(), dof_handler.end());
+  }  // eom
+
+
+  /*
+    Cell of another dof handler on the same triangulation
+    (same cell, different dofs)
+   */
+  template <typename DoFHandlerType>
+  inline
+  typename DoFHandlerType::active_cell_iterator
+  same_cell(const typename DoFHandlerType::active_cell_iterator &cell,
+            const DoFHandlerType                                &other_dof_handler)
+  {
+    return typename DoFHandlerType::active_cell_iterator
+      (&cell->get_triangulation(), cell->level(), cell->index(),
+       &other_dof_handler);
+  }  // eom
+
+}  // end of namespace
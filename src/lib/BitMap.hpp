@@ -1,8 +1,20 @@
 #pragma once
 
-// #include <iostream>     // std::cout
 #include <fstream>
+#include <string>
+#include <utility>      // std::pair
+#include <vector>
+#include <algorithm>    // std::min, std::max
+#include <cstdint>
+#include <cstring>      // std::memcpy
 
+// mmap
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <deal.II/base/exceptions.h>
 #include <deal.II/base/tensor.h>
 #include <deal.II/base/function.h>
 
@@ -10,91 +22,246 @@
 namespace BitMap {
   using namespace dealii;
 
+  /*
+    Property maps (values in [0, 1] after normalization) on a uniform grid
+    of pixels (2d) or voxels (3d).
+    Supported files, recognized by the magic number:
+      P2   - ASCII PGM, 8 or 16 bit (read into memory as float)
+      P5   - binary PGM, 8 or 16 bit (big-endian), memory-mapped
+      EFBM - binary map, memory-mapped; a text header line
+               EFBM <nx> <ny> <nz> <uint8|uint16|float32>
+             followed by nx*ny*nz little-endian values. Integer values are
+             normalized with their maximum, float32 values are taken as is.
+    Rows are stored top to bottom (as in PGM), slices bottom to top.
+    The binary files are not copied: all processes on a node share the
+    pages of the file cache, and only the pages that cover the cells a
+    process evaluates are ever read from disk.
+   */
   class BitMapFile
   {
   public:
     BitMapFile(const std::string &name);
-    double get_value(const double x, const double y) const;
+    ~BitMapFile();
+    // bi/trilinear interpolation, coordinates scaled to [0, 1]
+    double get_value(const double x, const double y, const double z = 0) const;
 
   private:
-    std::vector<double> image_data;
-    double hx, hy;
-    double maxvalue = 255;
-    int nx, ny;
-    double get_pixel_value(const int i, const int j) const;
+    enum Encoding {uint8, uint16_big_endian, uint16_little_endian, float32};
+
+    BitMapFile(const BitMapFile &);
+    BitMapFile & operator=(const BitMapFile &);
+
+    void read_ascii_pgm(std::ifstream &f);
+    void map_file(const std::string &name, const std::streamoff offset);
+    double get_pixel_value(const int i, const int j, const int k) const;
+
+    std::vector<float>  image_data;  // ASCII files
+    const unsigned char *mapped_data;
+    void                *mapped_region;
+    size_t               mapped_size;
+    Encoding             encoding;
+    double hx, hy, hz;
+    double maxvalue;
+    int nx, ny, nz;
   };
 
 
-    BitMapFile::BitMapFile(const std::string &name)
+  inline
+  BitMapFile::BitMapFile(const std::string &name)
     :
-    image_data(0),
+    mapped_data(NULL),
+    mapped_region(NULL),
+    mapped_size(0),
+    encoding(float32),
     hx(0),
     hy(0),
+    hz(0),
+    maxvalue(255),
     nx(0),
-    ny(0)
+    ny(0),
+    nz(1)
   {
-    std::ifstream f(name.c_str());
+    std::ifstream f(name.c_str(), std::ios::binary);
     AssertThrow (f, ExcMessage (std::string("Can't read from file <") +
                                 name + ">!"));
 
-    std::string temp;
-    getline(f, temp);
-    f >> temp;
-    // if (temp[0]=='#')
-    if (temp.compare(0, 1, "#") == 0)
-      getline(f, temp);
+    std::string magic;
+    f >> magic;
+    if (magic == "P2" || magic == "P5")
+    {
+      // skip comment lines
+      f >> std::ws;
+      while (f.peek() == '#')
+      {
+        std::string comment;
+        getline(f, comment);
+        f >> std::ws;
+      }
+      f >> nx >> ny >> maxvalue;
+      AssertThrow(f && maxvalue > 0 && maxvalue <= 65535,
+                  ExcMessage("Invalid file format."));
+      // single whitespace before the pixel data
+      f.get();
 
-    f >> nx >> ny;
-    // std::cout << "nx " << nx << " ny " << ny << std::endl;
-    f >> maxvalue;
-    // std::cout << "max_pixel " << maxvalue << std::endl;
+      if (magic == "P2")
+        read_ascii_pgm(f);
+      else
+      {
+        encoding = (maxvalue < 256) ? uint8 : uint16_big_endian;
+        map_file(name, f.tellg());
+      }
+    }
+    else if (magic == "EFBM")
+    {
+      std::string type;
+      f >> nx >> ny >> nz >> type;
+      AssertThrow(f, ExcMessage("Invalid file format."));
+      f.get();
+      if (type == "uint8")
+      {
+        encoding = uint8;
+        maxvalue = 255;
+      }
+      else if (type == "uint16")
+      {
+        encoding = uint16_little_endian;
+        maxvalue = 65535;
+      }
+      else if (type == "float32")
+      {
+        encoding = float32;
+        maxvalue = 1;
+      }
+      else
+        AssertThrow(false, ExcMessage("Unknown value type " + type));
+      map_file(name, f.tellg());
+    }
+    else
+      AssertThrow(false, ExcMessage("Invalid file format."));
+
+    AssertThrow(nx > 1 && ny > 1 && nz > 0,
+                ExcMessage("Invalid file format."));
+    hx = 1.0 / (nx - 1);
+    hy = 1.0 / (ny - 1);
+    hz = (nz > 1) ? 1.0 / (nz - 1) : 1.0;
+  }  // eom
+
+
+  inline
+  BitMapFile::~BitMapFile()
+  {
+    if (mapped_region != NULL)
+      munmap(mapped_region, mapped_size);
+  }  // eom
 
-    AssertThrow(nx > 0 && ny > 0,  ExcMessage("Invalid file format."));
-    AssertThrow(maxvalue == 255.0, ExcMessage("Invalid file format."));
 
-    for (int k = 0; k < nx * ny; k++)
+  inline
+  void BitMapFile::read_ascii_pgm(std::ifstream &f)
+  {
+    image_data.resize(static_cast<size_t>(nx) * ny);
+    for (size_t k = 0; k < image_data.size(); k++)
       {
         unsigned int val;
         f >> val;
-        image_data.push_back(val / maxvalue);
-        AssertThrow(val <= maxvalue, ExcMessage("Invalid file format."));
+        AssertThrow(f && val <= maxvalue, ExcMessage("Invalid file format."));
+        image_data[k] = val / maxvalue;
       }
+  }  // eom
 
-    hx = 1.0 / (nx - 1);
-    hy = 1.0 / (ny - 1);
+
+  inline
+  void BitMapFile::map_file(const std::string     &name,
+                            const std::streamoff   offset)
+  {
+    AssertThrow(offset > 0, ExcMessage("Invalid file format."));
+    const size_t value_size = (encoding == uint8) ? 1 :
+                              (encoding == float32) ? 4 : 2;
+    const size_t data_size = static_cast<size_t>(nx) * ny * nz * value_size;
+
+    const int fd = open(name.c_str(), O_RDONLY);
+    AssertThrow(fd >= 0, ExcMessage("Can't open <" + name + ">"));
+    struct stat file_stat;
+    AssertThrow(fstat(fd, &file_stat) == 0 &&
+                static_cast<size_t>(file_stat.st_size) >= offset + data_size,
+                ExcMessage("File <" + name + "> is truncated"));
+
+    mapped_size = offset + data_size;
+    mapped_region = mmap(NULL, mapped_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    AssertThrow(mapped_region != MAP_FAILED,
+                ExcMessage("Can't map <" + name + ">"));
+    mapped_data = static_cast<const unsigned char*>(mapped_region) + offset;
   }  // eom
 
 
+  inline
   double BitMapFile::get_pixel_value(const int i,
-                                     const int j) const
+                                     const int j,
+                                     const int k) const
   {
-    assert(i >= 0 && i < nx);
-    assert(j >= 0 && j < ny);
-    return image_data[nx * (ny - 1 - j) + i];
+    Assert(i >= 0 && i < nx, ExcIndexRange(i, 0, nx));
+    Assert(j >= 0 && j < ny, ExcIndexRange(j, 0, ny));
+    Assert(k >= 0 && k < nz, ExcIndexRange(k, 0, nz));
+    const size_t index =
+      (static_cast<size_t>(k) * ny + (ny - 1 - j)) * nx + i;
+
+    if (mapped_data == NULL)
+      return image_data[index];
+
+    switch (encoding)
+    {
+      case uint8:
+        return mapped_data[index] / maxvalue;
+      case uint16_big_endian:
+        return (mapped_data[2*index] << 8 | mapped_data[2*index + 1]) / maxvalue;
+      case uint16_little_endian:
+        return (mapped_data[2*index + 1] << 8 | mapped_data[2*index]) / maxvalue;
+      case float32:
+      default:
+      {
+        // unaligned-safe read
+        float value;
+        std::memcpy(&value, mapped_data + 4*index, sizeof(float));
+        return value;
+      }
+    }
   }  // eom
 
+
+  inline
   double BitMapFile::get_value(const double x,
-                               const double y) const
+                               const double y,
+                               const double z) const
   {
     const int ix = std::min(std::max((int) (x / hx), 0), nx - 2);
     const int iy = std::min(std::max((int) (y / hy), 0), ny - 2);
-    // std::cout << "nx " << nx << std::endl;
-    // std::cout << "ny " << ny << std::endl;
-    // std::cout << "x " << x << std::endl;
-    // std::cout << "y " << y << std::endl;
-    // std::cout << "ix " << ix << std::endl;
-    // std::cout << "iy " << iy << std::endl;
-
-    const double xi  = std::min(std::max((x-ix*hx)/hx, 1.), 0.);
-    const double eta = std::min(std::max((y-iy*hy)/hy, 1.), 0.);
-
-    return ((1-xi)*(1-eta)*get_pixel_value(ix,iy)
-            +
-            xi*(1-eta)*get_pixel_value(ix+1,iy)
-            +
-            (1-xi)*eta*get_pixel_value(ix,iy+1)
-            +
-            xi*eta*get_pixel_value(ix+1,iy+1));
+
+    // local coordinates in the pixel, clamped to [0, 1]
+    const double xi  = std::max(std::min((x-ix*hx)/hx, 1.), 0.);
+    const double eta = std::max(std::min((y-iy*hy)/hy, 1.), 0.);
+
+    // single slice: bilinear
+    int iz = 0;
+    double zeta = 0;
+    if (nz > 1)
+    {
+      iz = std::min(std::max((int) (z / hz), 0), nz - 2);
+      zeta = std::max(std::min((z-iz*hz)/hz, 1.), 0.);
+    }
+
+    double value = 0;
+    for (int kz = 0; kz < ((nz > 1) ? 2 : 1); ++kz)
+    {
+      const double wz = (kz == 0) ? 1-zeta : zeta;
+      value += wz*((1-xi)*(1-eta)*get_pixel_value(ix,iy,iz+kz)
+                   +
+                   xi*(1-eta)*get_pixel_value(ix+1,iy,iz+kz)
+                   +
+                   (1-xi)*eta*get_pixel_value(ix,iy+1,iz+kz)
+                   +
+                   xi*eta*get_pixel_value(ix+1,iy+1,iz+kz));
+    }
+    return value;
   }  // eom
 
 
@@ -102,32 +269,33 @@ namespace BitMap {
   class BitMapFunction : public Function<dim>
   {
   public:
-    BitMapFunction(const std::string &filename,
-                   double x1_, double x2_,
-                   double y1_, double y2_,
+    // range: [min, max] of the map in each coordinate direction
+    BitMapFunction(const std::string                              &filename,
+                   const std::vector< std::pair<double,double> > &range_,
                    double minvalue_, double maxvalue_)
       :
       Function<dim>(1),
       f(filename),
-      x1(x1_), x2(x2_),
-      y1(y1_), y2(y2_),
+      range(range_),
       minvalue(minvalue_),
       maxvalue(maxvalue_)
-    {}
+    {
+      AssertThrow(range.size() >= dim, ExcDimensionMismatch(range.size(), dim));
+    }
 
     virtual
     double value (const Point<dim> &p,
                   const unsigned int /*component*/) const
     {
-      Assert(dim==2, ExcNotImplemented());
-      double x = (p(0)-x1)/(x2-x1);
-      double y = (p(1)-y1)/(y2-y1);
-      return minvalue + f.get_value(x,y)*(maxvalue-minvalue);
+      double x[3] = {0, 0, 0};
+      for (int d=0; d<dim; ++d)
+        x[d] = (p(d)-range[d].first)/(range[d].second-range[d].first);
+      return minvalue + f.get_value(x[0],x[1],x[2])*(maxvalue-minvalue);
     }
 
   private:
     BitMapFile f;
-    double x1,x2,y1,y2;
+    std::vector< std::pair<double,double> > range;
     double minvalue, maxvalue;
   };
 
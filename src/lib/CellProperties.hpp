@@ -0,0 +1,151 @@
+#pragma once
+
+#include <deal.II/base/function.h>
+#include <deal.II/base/exceptions.h>
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/tria_accessor.h>
+#include <deal.II/grid/tria_iterator.h>
+#include <deal.II/lac/vector.h>
+
+
+namespace InputData
+{
+  using namespace dealii;
+
+  /*
+    Material constants of the active cells, indexed with
+    cell->active_cell_index(). The property functions (bitmaps, FE fields,
+    constants) are evaluated once in the cell centers of the non-artificial
+    cells after each mesh change (PhaseFieldData::update_cell_properties)
+    instead of in every cell of every assembly.
+    On a refined mesh the values are evaluated again from the functions
+    in the new cell centers, which is what a piecewise constant transfer
+    of spatial fields would give on refinement and more accurate on
+    coarsening.
+    Solution-dependent toughness can be set cell by cell.
+   */
+  template <int dim>
+  class CellProperties
+  {
+  public:
+    void update(const Triangulation<dim> &triangulation,
+                const Function<dim>      &young_modulus_function,
+                const Function<dim>      &poisson_ratio_function,
+                const Function<dim>      &fracture_toughness_function);
+    void set_fracture_toughness(const unsigned int cell_index,
+                                const double       value);
+
+    unsigned int size() const;
+    double young_modulus(const unsigned int cell_index) const;
+    double poisson_ratio(const unsigned int cell_index) const;
+    double fracture_toughness(const unsigned int cell_index) const;
+    double lame_constant(const unsigned int cell_index) const;
+    double shear_modulus(const unsigned int cell_index) const;
+    double bulk_modulus(const unsigned int cell_index) const;
+    // cell vector for output
+    const Vector<double> & fracture_toughness_values() const;
+
+  private:
+    Vector<double> young, poisson, toughness, lame, shear;
+  };
+
+
+  template <int dim>
+  void CellProperties<dim>::
+  update(const Triangulation<dim> &triangulation,
+         const Function<dim>      &young_modulus_function,
+         const Function<dim>      &poisson_ratio_function,
+         const Function<dim>      &fracture_toughness_function)
+  {
+    const unsigned int n_cells = triangulation.n_active_cells();
+    young.reinit(n_cells);
+    poisson.reinit(n_cells);
+    toughness.reinit(n_cells);
+    lame.reinit(n_cells);
+    shear.reinit(n_cells);
+
+    typename Triangulation<dim>::active_cell_iterator
+      cell = triangulation.begin_active(),
+      endc = triangulation.end();
+
+    for (; cell!=endc; ++cell)
+      if (!cell->is_artificial())
+      {
+        const unsigned int c = cell->active_cell_index();
+        const Point<dim> center = cell->center();
+        const double E = young_modulus_function.value(center, 0);
+        const double nu = poisson_ratio_function.value(center, 0);
+        young[c] = E;
+        poisson[c] = nu;
+        toughness[c] = fracture_toughness_function.value(center, 0);
+        lame[c] = E*nu/((1.+nu)*(1.-2*nu));
+        shear[c] = 0.5*E/(1.+nu);
+      }  // end cell loop
+  }  // eom
+
+
+  template <int dim>
+  void CellProperties<dim>::set_fracture_toughness(const unsigned int cell_index,
+                                                   const double       value)
+  {
+    AssertIndexRange(cell_index, toughness.size());
+    toughness[cell_index] = value;
+  }  // eom
+
+
+  template <int dim> inline
+  unsigned int CellProperties<dim>::size() const
+  {
+    return young.size();
+  }  // eom
+
+
+  template <int dim> inline
+  double CellProperties<dim>::young_modulus(const unsigned int cell_index) const
+  {
+    return young[cell_index];
+  }  // eom
+
+
+  template <int dim> inline
+  double CellProperties<dim>::poisson_ratio(const unsigned int cell_index) const
+  {
+    return poisson[cell_index];
+  }  // eom
+
+
+  template <int dim> inline
+  double CellProperties<dim>::fracture_toughness(const unsigned int cell_index) const
+  {
+    return toughness[cell_index];
+  }  // eom
+
+
+  template <int dim> inline
+  double CellProperties<dim>::lame_constant(const unsigned int cell_index) const
+  {
+    return lame[cell_index];
+  }  // eom
+
+
+  template <int dim> inline
+  double CellProperties<dim>::shear_modulus(const unsigned int cell_index) const
+  {
+    return shear[cell_index];
+  }  // eom
+
+
+  template <int dim> inline
+  double CellProperties<dim>::bulk_modulus(const unsigned int cell_index) const
+  {
+    return young[cell_index]/3.0/(1.0-2.0*poisson[cell_index]);
+  }  // eom
+
+
+  template <int dim> inline
+  const Vector<double> & CellProperties<dim>::fracture_toughness_values() const
+  {
+    return toughness;
+  }  // eom
+
+}  // end of namespace
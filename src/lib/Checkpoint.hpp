@@ -0,0 +1,166 @@
+#pragma once
+
+#include <deal.II/base/exceptions.h>
+#include <deal.II/base/utilities.h>
+#include <deal.II/distributed/tria.h>
+#include <deal.II/distributed/solution_transfer.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/lac/trilinos_block_vector.h>
+
+#include <cstdio>       // std::rename
+#include <fstream>
+#include <memory>       // std::unique_ptr
+#include <string>
+#include <vector>
+
+
+/*
+  Checkpoint/restart of the time loop.
+  A checkpoint <prefix>.mesh (+ .info) holds the p4est forest together with
+  the dof values of the vectors attached with
+  parallel::distributed::SolutionTransfer, <prefix>.state holds the
+  scalar state of the time loop.
+  Files are written under a temporary name and renamed after all processes
+  are done, so an interrupted write never replaces the last good checkpoint.
+
+  Restart: read the coarse mesh, call load_mesh (this replaces the global
+  and local prerefinement), setup dofs, then call load_vectors with the
+  dof handlers and vectors in the same order as in save.
+ */
+namespace Checkpoint
+{
+  using namespace dealii;
+
+  struct TimeState
+  {
+    TimeState();
+
+    double time, time_step, old_time_step;
+    int    time_step_number;
+    // pvd records of the output written before the checkpoint
+    std::vector< std::pair<double,std::string> > times_and_names;
+    // step proposed by the time-step controller (0 = none)
+    double controlled_time_step;
+  };
+
+
+  inline
+  TimeState::TimeState()
+  :
+  time(0),
+  time_step(0),
+  old_time_step(0),
+  time_step_number(0),
+  controlled_time_step(0)
+  {}  // eom
+
+
+  inline
+  void write_time_state(const std::string &file_name,
+                        const TimeState   &state)
+  {
+    std::ofstream f(file_name.c_str());
+    AssertThrow(f, ExcMessage("Cannot open " + file_name));
+    f.precision(17);
+    f << state.time << "\t"
+      << state.time_step << "\t"
+      << state.old_time_step << "\t"
+      << state.time_step_number << std::endl;
+    f << state.times_and_names.size() << std::endl;
+    for (const auto & record : state.times_and_names)
+      f << record.first << "\t" << record.second << std::endl;
+    f << state.controlled_time_step << std::endl;
+  }  // eom
+
+
+  inline
+  TimeState read_time_state(const std::string &file_name)
+  {
+    std::ifstream f(file_name.c_str());
+    AssertThrow(f, ExcMessage("Cannot open checkpoint file " + file_name));
+    TimeState state;
+    f >> state.time >> state.time_step
+      >> state.old_time_step >> state.time_step_number;
+    unsigned int n_records = 0;
+    f >> n_records;
+    state.times_and_names.resize(n_records);
+    for (auto & record : state.times_and_names)
+      f >> record.first >> record.second;
+    AssertThrow(!f.fail(), ExcMessage("Corrupted checkpoint file " + file_name));
+    // older state files end after the records
+    if (!(f >> state.controlled_time_step))
+      state.controlled_time_step = 0;
+    return state;
+  }  // eom
+
+
+  template <int dim>
+  void
+  save(const std::string                                &prefix,
+       const TimeState                                  &state,
+       parallel::distributed::Triangulation<dim>        &triangulation,
+       const std::vector<const DoFHandler<dim>*>        &dof_handlers,
+       const std::vector< std::vector<const TrilinosWrappers::MPI::BlockVector*> >
+                                                        &ghosted_vectors,
+       MPI_Comm                                         &mpi_communicator)
+  {
+    AssertDimension(dof_handlers.size(), ghosted_vectors.size());
+    typedef parallel::distributed::SolutionTransfer
+      <dim, TrilinosWrappers::MPI::BlockVector> Transfer;
+
+    // the transfer objects must exist until the triangulation is saved
+    std::vector< std::unique_ptr<Transfer> > transfers;
+    for (unsigned int i=0; i<dof_handlers.size(); ++i)
+    {
+      transfers.emplace_back(new Transfer(*dof_handlers[i]));
+      transfers.back()->prepare_serialization(ghosted_vectors[i]);
+    }
+
+    const std::string tmp = prefix + ".tmp";
+    triangulation.save((tmp + ".mesh").c_str());
+
+    const bool root = (Utilities::MPI::this_mpi_process(mpi_communicator) == 0);
+    if (root)
+      write_time_state(tmp + ".state", state);
+
+    MPI_Barrier(mpi_communicator);
+    if (root)
+    {
+      std::rename((tmp + ".mesh").c_str(), (prefix + ".mesh").c_str());
+      std::rename((tmp + ".mesh.info").c_str(), (prefix + ".mesh.info").c_str());
+      std::rename((tmp + ".state").c_str(), (prefix + ".state").c_str());
+    }
+    MPI_Barrier(mpi_communicator);
+  }  // eom
+
+
+  template <int dim>
+  TimeState
+  load_mesh(const std::string                         &prefix,
+            parallel::distributed::Triangulation<dim> &triangulation)
+  {
+    // read the state first: it fails cleanly if there is no checkpoint
+    const TimeState state = read_time_state(prefix + ".state");
+    triangulation.load((prefix + ".mesh").c_str());
+    return state;
+  }  // eom
+
+
+  template <int dim>
+  void
+  load_vectors(const std::vector<const DoFHandler<dim>*>                      &dof_handlers,
+               const std::vector< std::vector<TrilinosWrappers::MPI::BlockVector*> > &owned_vectors)
+  {
+    AssertDimension(dof_handlers.size(), owned_vectors.size());
+    typedef parallel::distributed::SolutionTransfer
+      <dim, TrilinosWrappers::MPI::BlockVector> Transfer;
+
+    for (unsigned int i=0; i<dof_handlers.size(); ++i)
+    {
+      Transfer transfer(*dof_handlers[i]);
+      std::vector<TrilinosWrappers::MPI::BlockVector*> vectors = owned_vectors[i];
+      transfer.deserialize(vectors);
+    }
+  }  // eom
+
+}  // end of namespace
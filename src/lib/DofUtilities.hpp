@@ -0,0 +1,72 @@
+#pragma once
+
+#include <deal.II/base/index_set.h>
+#include <deal.II/base/types.h>
+#include <deal.II/lac/constraint_matrix.h>
+
+#include <vector>
+
+
+namespace DofUtilities
+{
+  using namespace dealii;
+
+  /*
+    Call f(block, index) once for every dof in a block partitioning
+    (e.g. owned_partitioning or relevant_partitioning of a solver) that is
+    not constrained; index is the global dof index.
+    Only the local index sets are walked, so no per-process storage of the
+    global problem size is needed (unlike marking dofs while looping
+    over the cells).
+    When the owned partitioning is passed, a sum over the processes counts
+    every dof exactly once.
+    The dofs are visited in increasing order within each block, so the
+    running number of the calls can be used as a local numbering as long as
+    the index set and the constraints don't change.
+   */
+  template <typename Function>
+  void
+  for_each_unconstrained_dof(const std::vector<IndexSet> &partitioning,
+                             const ConstraintMatrix      &constraints,
+                             Function                     f)
+  {
+    types::global_dof_index offset = 0;
+    for (unsigned int block=0; block<partitioning.size(); ++block)
+    {
+      for (IndexSet::ElementIterator it = partitioning[block].begin();
+           it != partitioning[block].end(); ++it)
+      {
+        const types::global_dof_index index = offset + *it;
+        if (!constraints.is_constrained(index))
+          f(block, index);
+      }
+      offset += partitioning[block].size();
+    }
+  }  // eom
+
+
+  /*
+    Same for a single block: partitioning[block] of a block-wise numbered
+    dof handler
+   */
+  template <typename Function>
+  void
+  for_each_unconstrained_dof(const std::vector<IndexSet> &partitioning,
+                             const unsigned int           block,
+                             const ConstraintMatrix      &constraints,
+                             Function                     f)
+  {
+    types::global_dof_index offset = 0;
+    for (unsigned int b=0; b<block; ++b)
+      offset += partitioning[b].size();
+
+    for (IndexSet::ElementIterator it = partitioning[block].begin();
+         it != partitioning[block].end(); ++it)
+    {
+      const types::global_dof_index index = offset + *it;
+      if (!constraints.is_constrained(index))
+        f(block, index);
+    }
+  }  // eom
+
+}  // end of namespace
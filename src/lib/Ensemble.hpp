@@ -0,0 +1,171 @@
+#pragma once
+
+#include <deal.II/base/exceptions.h>
+#include <deal.II/base/mpi.h>
+#include <deal.II/base/utilities.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+/*
+  Ensemble (parameter sweep) runs of one input file.
+  The members are read from a sweep file with one member per line:
+    name; Subsection/Entry = value; Subsection/Entry = value ...
+  (empty lines and lines starting with # are skipped). The processes of
+  MPI_COMM_WORLD are split into groups of a fixed size; group g runs the
+  members g, g + n_groups, ... one after another, so a group keeps its
+  communicator and the pre-refined mesh between its members. Every
+  group writes one summary file per member, and process 0 combines them
+  in the order of the sweep file after all groups are done.
+ */
+namespace Ensemble
+{
+  using namespace dealii;
+
+  struct Member
+  {
+    std::string              name;
+    std::vector<std::string> overrides;
+  };
+
+
+  // end results of a member run
+  struct Summary
+  {
+    Summary();
+
+    bool                     completed;
+    double                   wall_time, final_time;
+    int                      n_time_steps;
+    // last values of the postprocessing quantities
+    std::vector<std::string> labels;
+    std::vector<double>      values;
+  };
+
+
+  inline
+  Summary::Summary()
+  :
+  completed(false),
+  wall_time(0),
+  final_time(0),
+  n_time_steps(0)
+  {}  // eom
+
+
+  inline
+  std::string trim(const std::string &s)
+  {
+    const std::size_t first = s.find_first_not_of(" \t");
+    if (first == std::string::npos)
+      return "";
+    const std::size_t last = s.find_last_not_of(" \t\r");
+    return s.substr(first, last - first + 1);
+  }  // eom
+
+
+  inline
+  std::vector<Member> read_members(const std::string &file_name)
+  {
+    std::ifstream f(file_name.c_str());
+    AssertThrow(f, ExcMessage("Cannot open sweep file " + file_name));
+
+    std::vector<Member> members;
+    std::string line;
+    while (std::getline(f, line))
+    {
+      line = trim(line);
+      if (line.empty() || line[0] == '#')
+        continue;
+
+      std::istringstream fields(line);
+      std::string field;
+      Member member;
+      std::getline(fields, field, ';');
+      member.name = trim(field);
+      AssertThrow(member.name.find_first_of(" /\t") == std::string::npos,
+                  ExcMessage("Invalid member name '" + member.name + "'"));
+      while (std::getline(fields, field, ';'))
+        if (!trim(field).empty())
+          member.overrides.push_back(trim(field));
+      members.push_back(member);
+    }
+
+    AssertThrow(members.size() > 0,
+                ExcMessage("No members in sweep file " + file_name));
+    return members;
+  }  // eom
+
+
+  /*
+    Split MPI_COMM_WORLD into groups of group_size consecutive processes
+    (0 = one group). Returns the communicator of the group of this
+    process, to be freed by the caller.
+   */
+  inline
+  MPI_Comm split_communicator(const unsigned int group_size,
+                              unsigned int      &group,
+                              unsigned int      &n_groups)
+  {
+    const unsigned int n_processes =
+      Utilities::MPI::n_mpi_processes(MPI_COMM_WORLD);
+    const unsigned int size = (group_size == 0) ? n_processes : group_size;
+    AssertThrow(n_processes % size == 0,
+                ExcMessage("The number of processes must be a multiple "
+                           "of the group size"));
+    n_groups = n_processes/size;
+    group = Utilities::MPI::this_mpi_process(MPI_COMM_WORLD)/size;
+
+    MPI_Comm group_communicator;
+    const int ierr = MPI_Comm_split(MPI_COMM_WORLD, group,
+                                    Utilities::MPI::this_mpi_process(MPI_COMM_WORLD),
+                                    &group_communicator);
+    AssertThrow(ierr == MPI_SUCCESS, ExcMessage("MPI_Comm_split failed"));
+    return group_communicator;
+  }  // eom
+
+
+  inline
+  void write_member_summary(const std::string &file_name,
+                            const std::string &member_name,
+                            const Summary     &summary)
+  {
+    std::ofstream f(file_name.c_str());
+    AssertThrow(f, ExcMessage("Cannot open " + file_name));
+    f.precision(10);
+    f << member_name << "\t"
+      << (summary.completed ? "completed" : "failed") << "\t"
+      << summary.wall_time << "\t"
+      << summary.final_time << "\t"
+      << summary.n_time_steps;
+    for (unsigned int i=0; i<summary.labels.size(); ++i)
+      f << "\t" << summary.labels[i] << "=" << summary.values[i];
+    f << std::endl;
+  }  // eom
+
+
+  // one line per member in the order of the sweep file
+  inline
+  void combine_summaries(const std::string         &file_name,
+                         const std::vector<Member> &members,
+                         const std::string         &member_file_prefix)
+  {
+    std::ofstream f(file_name.c_str());
+    AssertThrow(f, ExcMessage("Cannot open " + file_name));
+    f << "# member\tstatus\twall_time\tfinal_time\ttime_steps\tquantities"
+      << std::endl;
+    for (const auto & member : members)
+    {
+      std::ifstream g((member_file_prefix + member.name + ".txt").c_str());
+      std::string line;
+      if (g && std::getline(g, line))
+        f << line << std::endl;
+      else
+        f << member.name << "\tmissing" << std::endl;
+    }
+  }  // eom
+
+}  // end of namespace
@@ -0,0 +1,394 @@
+#pragma once
+
+#include <deal.II/base/quadrature.h>
+#include <deal.II/base/tensor.h>
+#include <deal.II/distributed/tria.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/fe/fe_values.h>
+#include <deal.II/lac/trilinos_block_vector.h>
+
+#include <algorithm>    // std::max
+#include <vector>
+
+
+namespace Assembly
+{
+  using namespace dealii;
+
+  /*
+    Fields of the current nonlinear iterate in quadrature points, shared
+    by the solvers of the fixed-stress split instead of each of them walking
+    the solid, width and pressure dof handlers with its own FEValues and
+    gathering from the ghosted vectors:
+      solid    - phi, div u, div u_old      (update_solid)
+      width    - width, permeability        (update_width, after update_solid)
+      pressure - p, grad p                  (update_pressure)
+    The drivers update a group once after the solve that changes it; the
+    consumers (PressureSolver, PhaseFieldSolver, TemperatureSolver and the
+    permeability output) read a group only while it is valid and fall back
+    to their own gathers otherwise. The quadrature is the QGauss(degree+2)
+    rule of the solvers.
+
+    Arrays are flat, [cell][q] with cell->active_cell_index(), and are
+    filled on all non-artificial cells. clear() after mesh changes;
+    the next update resizes.
+   */
+  template <int dim>
+  class FieldCache
+  {
+  public:
+    FieldCache(const parallel::distributed::Triangulation<dim> &triangulation_,
+               const Quadrature<dim>                           &quadrature_);
+
+    void clear();
+    void update_solid(const DoFHandler<dim>                    &dof_handler_solid,
+                      const TrilinosWrappers::MPI::BlockVector &solution_solid,
+                      const TrilinosWrappers::MPI::BlockVector &old_solution_solid);
+    // perm_res: reservoir permeability (SinglePhaseData::perm_res)
+    void update_width(const DoFHandler<dim>                    &dof_handler_width,
+                      const TrilinosWrappers::MPI::BlockVector &solution_width,
+                      const double                              perm_res);
+    void update_pressure(const DoFHandler<dim>                    &dof_handler_pressure,
+                         const TrilinosWrappers::MPI::BlockVector &solution_pressure);
+
+    bool solid_valid() const;
+    bool width_valid() const;
+    bool pressure_valid() const;
+    unsigned int n_quadrature_points() const;
+
+    double phi(const unsigned int cell_index, const unsigned int q) const;
+    double div_u(const unsigned int cell_index, const unsigned int q) const;
+    double div_old_u(const unsigned int cell_index, const unsigned int q) const;
+    double width(const unsigned int cell_index, const unsigned int q) const;
+    // permeability (without viscosity) interpolated between fracture
+    // and reservoir
+    double permeability(const unsigned int cell_index, const unsigned int q) const;
+    double pressure(const unsigned int cell_index, const unsigned int q) const;
+    const Tensor<1,dim> & pressure_gradient(const unsigned int cell_index,
+                                            const unsigned int q) const;
+    // mean values over the reference cell
+    double cell_phi(const unsigned int cell_index) const;
+    double cell_permeability(const unsigned int cell_index) const;
+
+    // indicator of the fracture zone xi_f (xi_r = 1 - xi_f)
+    static double fracture_indicator(const double phi_value);
+    static double effective_permeability(const double phi_value,
+                                         const double width_value,
+                                         const double perm_res);
+
+  private:
+    void resize();
+    double cell_mean(const std::vector<double> &values,
+                     const unsigned int         cell_index) const;
+
+    const parallel::distributed::Triangulation<dim> &triangulation;
+    const Quadrature<dim>                            quadrature;
+    const unsigned int                               n_q_points;
+    unsigned int                                     n_cells;
+    bool                                             has_solid, has_width,
+                                                     has_pressure;
+    std::vector<double>         phi_values, div_u_values, div_old_u_values,
+                                width_values, permeability_values,
+                                pressure_values;
+    std::vector< Tensor<1,dim> > pressure_gradients;
+  };
+
+
+  template <int dim>
+  FieldCache<dim>::
+  FieldCache(const parallel::distributed::Triangulation<dim> &triangulation_,
+             const Quadrature<dim>                           &quadrature_)
+  :
+  triangulation(triangulation_),
+  quadrature(quadrature_),
+  n_q_points(quadrature_.size()),
+  n_cells(0),
+  has_solid(false),
+  has_width(false),
+  has_pressure(false)
+  {}  // eom
+
+
+  template <int dim>
+  void FieldCache<dim>::clear()
+  {
+    has_solid = false;
+    has_width = false;
+    has_pressure = false;
+  }  // eom
+
+
+  template <int dim>
+  void FieldCache<dim>::resize()
+  {
+    if (n_cells == triangulation.n_active_cells())
+      return;
+    n_cells = triangulation.n_active_cells();
+    phi_values.resize(n_cells*n_q_points);
+    div_u_values.resize(n_cells*n_q_points);
+    div_old_u_values.resize(n_cells*n_q_points);
+    width_values.resize(n_cells*n_q_points);
+    permeability_values.resize(n_cells*n_q_points);
+    pressure_values.resize(n_cells*n_q_points);
+    pressure_gradients.resize(n_cells*n_q_points);
+  }  // eom
+
+
+  template <int dim>
+  void FieldCache<dim>::
+  update_solid(const DoFHandler<dim>                    &dof_handler_solid,
+               const TrilinosWrappers::MPI::BlockVector &solution_solid,
+               const TrilinosWrappers::MPI::BlockVector &old_solution_solid)
+  {
+    resize();
+    const FEValuesExtractors::Vector displacement(0);
+    const FEValuesExtractors::Scalar phase_field(dim);
+    FEValues<dim> fe_values(dof_handler_solid.get_fe(), quadrature,
+                            update_values | update_gradients);
+    std::vector<double> phi(n_q_points), div_u(n_q_points),
+                        div_old_u(n_q_points);
+
+    typename DoFHandler<dim>::active_cell_iterator
+      cell = dof_handler_solid.begin_active(),
+      endc = dof_handler_solid.end();
+    for (; cell!=endc; ++cell)
+      if (!cell->is_artificial())
+      {
+        fe_values.reinit(cell);
+        fe_values[phase_field].get_function_values(solution_solid, phi);
+        fe_values[displacement].get_function_divergences(solution_solid, div_u);
+        fe_values[displacement].get_function_divergences(old_solution_solid,
+                                                         div_old_u);
+        const unsigned int offset = cell->active_cell_index()*n_q_points;
+        for (unsigned int q=0; q<n_q_points; ++q)
+        {
+          phi_values[offset + q] = phi[q];
+          div_u_values[offset + q] = div_u[q];
+          div_old_u_values[offset + q] = div_old_u[q];
+        }
+      }  // end cell loop
+
+    has_solid = true;
+    // permeability depends on phi
+    has_width = false;
+  }  // eom
+
+
+  template <int dim>
+  void FieldCache<dim>::
+  update_width(const DoFHandler<dim>                    &dof_handler_width,
+               const TrilinosWrappers::MPI::BlockVector &solution_width,
+               const double                              perm_res)
+  {
+    AssertThrow(has_solid,
+                ExcMessage("FieldCache: update_solid before update_width"));
+    FEValues<dim> fe_values(dof_handler_width.get_fe(), quadrature,
+                            update_values);
+    std::vector<double> w(n_q_points);
+
+    typename DoFHandler<dim>::active_cell_iterator
+      cell = dof_handler_width.begin_active(),
+      endc = dof_handler_width.end();
+    for (; cell!=endc; ++cell)
+      if (!cell->is_artificial())
+      {
+        fe_values.reinit(cell);
+        fe_values.get_function_values(solution_width, w);
+        const unsigned int offset = cell->active_cell_index()*n_q_points;
+        for (unsigned int q=0; q<n_q_points; ++q)
+        {
+          width_values[offset + q] = w[q];
+          permeability_values[offset + q] =
+            effective_permeability(phi_values[offset + q], w[q], perm_res);
+        }
+      }  // end cell loop
+
+    has_width = true;
+  }  // eom
+
+
+  template <int dim>
+  void FieldCache<dim>::
+  update_pressure(const DoFHandler<dim>                    &dof_handler_pressure,
+                  const TrilinosWrappers::MPI::BlockVector &solution_pressure)
+  {
+    resize();
+    const FEValuesExtractors::Scalar pressure_extractor(0);
+    FEValues<dim> fe_values(dof_handler_pressure.get_fe(), quadrature,
+                            update_values | update_gradients);
+    std::vector<double>          p(n_q_points);
+    std::vector< Tensor<1,dim> > grad_p(n_q_points);
+
+    typename DoFHandler<dim>::active_cell_iterator
+      cell = dof_handler_pressure.begin_active(),
+      endc = dof_handler_pressure.end();
+    for (; cell!=endc; ++cell)
+      if (!cell->is_artificial())
+      {
+        fe_values.reinit(cell);
+        fe_values[pressure_extractor].get_function_values(solution_pressure, p);
+        fe_values[pressure_extractor].get_function_gradients(solution_pressure,
+                                                             grad_p);
+        const unsigned int offset = cell->active_cell_index()*n_q_points;
+        for (unsigned int q=0; q<n_q_points; ++q)
+        {
+          pressure_values[offset + q] = p[q];
+          pressure_gradients[offset + q] = grad_p[q];
+        }
+      }  // end cell loop
+
+    has_pressure = true;
+  }  // eom
+
+
+  template <int dim>
+  inline
+  bool FieldCache<dim>::solid_valid() const
+  {
+    return has_solid;
+  }  // eom
+
+
+  template <int dim>
+  inline
+  bool FieldCache<dim>::width_valid() const
+  {
+    return has_width;
+  }  // eom
+
+
+  template <int dim>
+  inline
+  bool FieldCache<dim>::pressure_valid() const
+  {
+    return has_pressure;
+  }  // eom
+
+
+  template <int dim>
+  inline
+  unsigned int FieldCache<dim>::n_quadrature_points() const
+  {
+    return n_q_points;
+  }  // eom
+
+
+  template <int dim>
+  inline
+  double FieldCache<dim>::phi(const unsigned int cell_index,
+                              const unsigned int q) const
+  {
+    return phi_values[cell_index*n_q_points + q];
+  }  // eom
+
+
+  template <int dim>
+  inline
+  double FieldCache<dim>::div_u(const unsigned int cell_index,
+                                const unsigned int q) const
+  {
+    return div_u_values[cell_index*n_q_points + q];
+  }  // eom
+
+
+  template <int dim>
+  inline
+  double FieldCache<dim>::div_old_u(const unsigned int cell_index,
+                                    const unsigned int q) const
+  {
+    return div_old_u_values[cell_index*n_q_points + q];
+  }  // eom
+
+
+  template <int dim>
+  inline
+  double FieldCache<dim>::width(const unsigned int cell_index,
+                                const unsigned int q) const
+  {
+    return width_values[cell_index*n_q_points + q];
+  }  // eom
+
+
+  template <int dim>
+  inline
+  double FieldCache<dim>::permeability(const unsigned int cell_index,
+                                       const unsigned int q) const
+  {
+    return permeability_values[cell_index*n_q_points + q];
+  }  // eom
+
+
+  template <int dim>
+  inline
+  double FieldCache<dim>::pressure(const unsigned int cell_index,
+                                   const unsigned int q) const
+  {
+    return pressure_values[cell_index*n_q_points + q];
+  }  // eom
+
+
+  template <int dim>
+  inline
+  const Tensor<1,dim> &
+  FieldCache<dim>::pressure_gradient(const unsigned int cell_index,
+                                     const unsigned int q) const
+  {
+    return pressure_gradients[cell_index*n_q_points + q];
+  }  // eom
+
+
+  template <int dim>
+  double FieldCache<dim>::cell_mean(const std::vector<double> &values,
+                                    const unsigned int         cell_index) const
+  {
+    // quadrature weights of the reference cell sum up to 1
+    double mean = 0;
+    for (unsigned int q=0; q<n_q_points; ++q)
+      mean += quadrature.weight(q)*values[cell_index*n_q_points + q];
+    return mean;
+  }  // eom
+
+
+  template <int dim>
+  double FieldCache<dim>::cell_phi(const unsigned int cell_index) const
+  {
+    return cell_mean(phi_values, cell_index);
+  }  // eom
+
+
+  template <int dim>
+  double FieldCache<dim>::cell_permeability(const unsigned int cell_index) const
+  {
+    return cell_mean(permeability_values, cell_index);
+  }  // eom
+
+
+  template <int dim>
+  inline
+  double FieldCache<dim>::fracture_indicator(const double phi_value)
+  {
+    // values that separate fracture, reservoir, and cake zone
+    const double cx = 0.1;
+    const double c1 = 0.5 - cx;
+    const double c2 = 0.5 + cx;
+    if (phi_value <= c1)
+      return 1.0;
+    if (phi_value >= c2)
+      return 0.0;
+    return (c2 - phi_value)/(c2 - c1);
+  }  // eom
+
+
+  template <int dim>
+  inline
+  double FieldCache<dim>::effective_permeability(const double phi_value,
+                                                 const double width_value,
+                                                 const double perm_res)
+  {
+    // fracture perm from lubrication theory
+    const double w = std::max(width_value, 0.0);
+    const double perm_f = std::max(1e-11, 1.0/12.0*w*w);
+    return perm_res + fracture_indicator(phi_value)*(perm_f - perm_res);
+  }  // eom
+
+}  // end of namespace
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <deal.II/base/exceptions.h>
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/trilinos_block_vector.h>
+#include <deal.II/lac/vector.h>
+
+#include <algorithm>    // std::min, std::max
+#include <cmath>        // std::abs
+#include <deque>
+#include <string>
+
+
+namespace FluidSolvers
+{
+  using namespace dealii;
+
+  /*
+    Acceleration of the fixed-stress-split iterations.
+    The FSS loop is the fixed-point iteration x_{k+1} = G(x_k), x being the
+    pressure and G one pass of solid, width and pressure solves; with
+    r_k = G(x_k) - x_k the accelerated iterate is
+      none     - x_k + omega r_k  (omega = relaxation, 1 = plain FSS)
+      aitken   - x_k + omega_k r_k with the dynamic Aitken factor
+                 omega_k = -omega_{k-1} (r_{k-1}, r_k - r_{k-1})/|r_k - r_{k-1}|^2
+      anderson - Anderson mixing over the last depth iterates:
+                 gamma = argmin |r_k - dR gamma| (normal equations),
+                 x_{k+1} = x_k + omega r_k - (dX + omega dR) gamma
+    The history holds vectors of one mesh and time step: reset must be
+    called at the start of every time step and after mesh changes.
+   */
+  class FixedPointAccelerator
+  {
+  public:
+    FixedPointAccelerator();
+    void set_parameters(const std::string  &method_,
+                        const unsigned int  depth_,
+                        const double        relaxation_);
+    void reset();
+    // previous: x_k (may be ghosted); iterate: G(x_k) on input, x_{k+1} on output
+    void update(const TrilinosWrappers::MPI::BlockVector &previous,
+                TrilinosWrappers::MPI::BlockVector       &iterate);
+    double get_relaxation() const;
+
+  private:
+    std::string  method;
+    unsigned int depth;
+    double       relaxation, omega;
+    // last iterate and residual
+    TrilinosWrappers::MPI::BlockVector last_x, last_r;
+    bool                               has_last;
+    // differences of iterates and residuals, newest in the back
+    std::deque<TrilinosWrappers::MPI::BlockVector> dx, dr;
+  };
+
+
+  inline
+  FixedPointAccelerator::FixedPointAccelerator()
+  :
+  method("none"),
+  depth(5),
+  relaxation(1),
+  omega(1),
+  has_last(false)
+  {}  // eom
+
+
+  inline
+  void FixedPointAccelerator::set_parameters(const std::string  &method_,
+                                             const unsigned int  depth_,
+                                             const double        relaxation_)
+  {
+    AssertThrow(method_ == "none" || method_ == "aitken" ||
+                method_ == "anderson",
+                ExcMessage("Unknown FSS acceleration " + method_));
+    method = method_;
+    depth = std::max(depth_, 1u);
+    relaxation = relaxation_;
+    reset();
+  }  // eom
+
+
+  inline
+  void FixedPointAccelerator::reset()
+  {
+    omega = relaxation;
+    has_last = false;
+    dx.clear();
+    dr.clear();
+  }  // eom
+
+
+  inline
+  double FixedPointAccelerator::get_relaxation() const
+  {
+    return omega;
+  }  // eom
+
+
+  inline
+  void FixedPointAccelerator::
+  update(const TrilinosWrappers::MPI::BlockVector &previous,
+         TrilinosWrappers::MPI::BlockVector       &iterate)
+  {
+    if (method == "none" && relaxation == 1)
+      return;
+
+    // owned copies with the layout of the iterate
+    TrilinosWrappers::MPI::BlockVector x(iterate), r(iterate);
+    x = previous;
+    r -= x;
+
+    if (method == "aitken" && has_last)
+    {
+      TrilinosWrappers::MPI::BlockVector dr_k(r);
+      dr_k -= last_r;
+      const double denominator = dr_k*dr_k;
+      if (denominator > 0)
+        omega = -omega*(last_r*dr_k)/denominator;
+      // keep the factor away from zero and from over-relaxation
+      omega = std::max(std::min(omega, 2.0), 1e-2);
+    }
+
+    if (method != "anderson")
+    {
+      iterate = x;
+      iterate.add(omega, r);
+    }
+    else
+    {
+      if (has_last)
+      {
+        dx.push_back(x);
+        dx.back() -= last_x;
+        dr.push_back(r);
+        dr.back() -= last_r;
+        if (dx.size() > depth)
+        {
+          dx.pop_front();
+          dr.pop_front();
+        }
+      }
+
+      iterate = x;
+      iterate.add(relaxation, r);
+
+      const unsigned int m = dr.size();
+      if (m > 0)
+      {
+        FullMatrix<double> normal_matrix(m, m);
+        Vector<double>     rhs(m), gamma(m);
+        for (unsigned int i=0; i<m; ++i)
+        {
+          for (unsigned int j=0; j<=i; ++j)
+          {
+            normal_matrix(i, j) = dr[i]*dr[j];
+            normal_matrix(j, i) = normal_matrix(i, j);
+          }
+          rhs[i] = dr[i]*r;
+        }
+        // Tikhonov term against (nearly) dependent differences
+        double trace = 0;
+        for (unsigned int i=0; i<m; ++i)
+          trace += normal_matrix(i, i);
+        for (unsigned int i=0; i<m; ++i)
+          normal_matrix(i, i) += 1e-10*trace/m;
+
+        if (trace > 0)
+        {
+          normal_matrix.gauss_jordan();
+          normal_matrix.vmult(gamma, rhs);
+          for (unsigned int i=0; i<m; ++i)
+          {
+            iterate.add(-gamma[i], dx[i]);
+            iterate.add(-relaxation*gamma[i], dr[i]);
+          }
+        }
+      }
+    }
+
+    last_x = x;
+    last_r = r;
+    has_last = true;
+  }  // eom
+
+}  // end of namespace
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <deal.II/base/conditional_ostream.h>
+#include <deal.II/base/exceptions.h>
+
+#include <algorithm>    // std::min, std::max
+#include <cmath>        // std::pow
+#include <string>
+
+
+namespace LinearSolvers
+{
+  using namespace dealii;
+
+  /*
+    Relative tolerance (forcing term) of the linear solves of an inexact
+    Newton iteration, ||F(x_k) + J(x_k) dx|| <= eta_k ||F(x_k)||.
+      constant         - eta_k = linear tolerance
+      eisenstat-walker - choice 2 of Eisenstat and Walker:
+                         eta_0 = eta_max,
+                         eta_k = gamma (|F_k|/|F_{k-1}|)^alpha,
+                         gamma = 0.9, alpha = 2, kept above
+                         gamma eta_{k-1}^alpha when that one is > 0.1
+                         and above 0.5 tol/|F_k| (no oversolving in the
+                         last step), limited to [linear tolerance, eta_max]
+    update must get the nonlinear residual norm of every iterate before
+    its linear solve and reset is called when a new nonlinear solve
+    starts. Solvers without a line search accept a linear solve that
+    stops at the iteration limit only once per nonlinear solve
+    (accept_unconverged). The linear iterations per nonlinear step are
+    counted over the whole run.
+   */
+  class ForcingTerm
+  {
+  public:
+    ForcingTerm();
+    void set_parameters(const std::string &method_,
+                        const double       eta_min_,
+                        const double       eta_max_,
+                        const double       nonlinear_tolerance_);
+    // start of a nonlinear solve
+    void reset();
+    // nonlinear residual norm of the current iterate, returns eta
+    double update(const double residual_norm);
+    double tolerance() const;
+    bool is_adaptive() const;
+    void register_iterations(const unsigned int n_iterations,
+                             const bool         converged);
+    // true for the first unconverged linear solve since reset
+    bool accept_unconverged();
+    void print_statistics(ConditionalOStream &pcout,
+                          const std::string  &name) const;
+
+  private:
+    std::string  method;
+    double       eta_min, eta_max, nonlinear_tolerance;
+    double       eta, last_residual;
+    bool         unconverged_accepted;
+    unsigned int n_nonlinear_steps, n_linear_iterations, n_unconverged;
+  };
+
+
+  inline
+  ForcingTerm::ForcingTerm()
+  :
+  method("constant"),
+  eta_min(1e-10),
+  eta_max(0.1),
+  nonlinear_tolerance(0),
+  eta(1e-10),
+  last_residual(0),
+  unconverged_accepted(false),
+  n_nonlinear_steps(0),
+  n_linear_iterations(0),
+  n_unconverged(0)
+  {}  // eom
+
+
+  inline
+  void ForcingTerm::set_parameters(const std::string &method_,
+                                   const double       eta_min_,
+                                   const double       eta_max_,
+                                   const double       nonlinear_tolerance_)
+  {
+    AssertThrow(method_ == "constant" || method_ == "eisenstat-walker",
+                ExcMessage("Unknown linear solver forcing " + method_));
+    method = method_;
+    eta_min = eta_min_;
+    eta_max = std::max(eta_max_, eta_min_);
+    nonlinear_tolerance = nonlinear_tolerance_;
+    reset();
+  }  // eom
+
+
+  inline
+  void ForcingTerm::reset()
+  {
+    last_residual = 0;
+    unconverged_accepted = false;
+    eta = is_adaptive() ? eta_max : eta_min;
+  }  // eom
+
+
+  inline
+  bool ForcingTerm::is_adaptive() const
+  {
+    return method == "eisenstat-walker";
+  }  // eom
+
+
+  inline
+  double ForcingTerm::update(const double residual_norm)
+  {
+    n_nonlinear_steps++;
+    if (!is_adaptive())
+      return eta;
+
+    if (last_residual > 0)
+    {
+      const double gamma = 0.9, alpha = 2;
+      const double ratio = residual_norm/last_residual;
+      double eta_new = gamma*std::pow(ratio, alpha);
+      // safeguard against a too fast decrease of eta
+      const double eta_safe = gamma*std::pow(eta, alpha);
+      if (eta_safe > 0.1)
+        eta_new = std::max(eta_new, eta_safe);
+      eta = std::min(eta_new, eta_max);
+    }
+    // solving below the nonlinear tolerance is wasted
+    if (nonlinear_tolerance > 0 && residual_norm > 0)
+      eta = std::min(std::max(eta, 0.5*nonlinear_tolerance/residual_norm),
+                     eta_max);
+    eta = std::max(eta, eta_min);
+
+    last_residual = residual_norm;
+    return eta;
+  }  // eom
+
+
+  inline
+  double ForcingTerm::tolerance() const
+  {
+    return eta;
+  }  // eom
+
+
+  inline
+  void ForcingTerm::register_iterations(const unsigned int n_iterations,
+                                        const bool         converged)
+  {
+    n_linear_iterations += n_iterations;
+    if (!converged)
+      n_unconverged++;
+  }  // eom
+
+
+  inline
+  bool ForcingTerm::accept_unconverged()
+  {
+    if (!is_adaptive() || unconverged_accepted)
+      return false;
+    unconverged_accepted = true;
+    return true;
+  }  // eom
+
+
+  inline
+  void ForcingTerm::print_statistics(ConditionalOStream &pcout,
+                                     const std::string  &name) const
+  {
+    pcout << name << ": "
+          << n_linear_iterations << " linear iterations in "
+          << n_nonlinear_steps << " nonlinear steps ("
+          << static_cast<double>(n_linear_iterations)/
+             std::max(n_nonlinear_steps, 1u)
+          << " per step, " << n_unconverged << " stopped at the limit)"
+          << std::endl;
+  }  // eom
+
+}  // end of namespace
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <deal.II/base/mpi.h>
+#include <deal.II/lac/trilinos_block_vector.h>
+#include <deal.II/lac/trilinos_vector.h>
+
+
+namespace DofUtilities
+{
+  using namespace dealii;
+
+  /*
+    Owned -> ghosted copies that skip the ghost exchange when the ghosted
+    vector already holds the owned values.
+    A ghosted Trilinos vector can only be written by assignment, so its
+    ghost entries always agree with the owned entries on their owner
+    processes. Thus if the owned part of the ghosted vector equals the
+    source on every process, the copy would not change anything. The
+    check is a local comparison and one reduction of a flag instead of
+    the copy and the point-to-point exchange of the ghost layer.
+    The counters tell how many copies were skipped.
+   */
+  class GhostUpdater
+  {
+  public:
+    GhostUpdater();
+    // ghosted = owned unless nothing changed, returns true if copied
+    bool update(TrilinosWrappers::MPI::BlockVector       &ghosted,
+                const TrilinosWrappers::MPI::BlockVector &owned);
+    unsigned int n_exchanges() const;
+    unsigned int n_skipped() const;
+
+  private:
+    static bool owned_part_equal(const TrilinosWrappers::MPI::Vector &ghosted,
+                                 const TrilinosWrappers::MPI::Vector &owned);
+    unsigned int n_copies, n_skips;
+  };
+
+
+  inline
+  GhostUpdater::GhostUpdater()
+  :
+  n_copies(0),
+  n_skips(0)
+  {}  // eom
+
+
+  inline
+  bool GhostUpdater::
+  owned_part_equal(const TrilinosWrappers::MPI::Vector &ghosted,
+                   const TrilinosWrappers::MPI::Vector &owned)
+  {
+    if (ghosted.size() != owned.size())
+      return false;
+
+    const IndexSet owned_elements = owned.locally_owned_elements();
+    if (owned_elements.n_elements() == 0)
+      return true;
+
+    // local values of the ghosted vector are stored in the order of its
+    // map; the owned range is contiguous in the map if it is contiguous
+    // in the index space
+    const Epetra_Map &map = ghosted.vector_partitioner();
+    const double *ghosted_values = ghosted.trilinos_vector()[0];
+    const double *owned_values = owned.begin();
+    if (owned_elements.is_contiguous())
+    {
+      const int first = map.LID(static_cast<int>(*owned_elements.begin()));
+      const int last = map.LID(static_cast<int>(owned_elements.nth_index_in_set
+                                               (owned_elements.n_elements() - 1)));
+      if (first < 0 || last - first + 1 !=
+          static_cast<int>(owned_elements.n_elements()))
+        return false;
+      for (unsigned int i=0; i<owned_elements.n_elements(); ++i)
+        if (ghosted_values[first + i] != owned_values[i])
+          return false;
+      return true;
+    }
+
+    unsigned int i = 0;
+    for (IndexSet::ElementIterator it = owned_elements.begin();
+         it != owned_elements.end(); ++it, ++i)
+    {
+      const int lid = map.LID(static_cast<int>(*it));
+      if (lid < 0 || ghosted_values[lid] != owned_values[i])
+        return false;
+    }
+    return true;
+  }  // eom
+
+
+  inline
+  bool GhostUpdater::update(TrilinosWrappers::MPI::BlockVector       &ghosted,
+                            const TrilinosWrappers::MPI::BlockVector &owned)
+  {
+    if (&ghosted == &owned)
+      return false;
+
+    bool equal = (ghosted.n_blocks() == owned.n_blocks());
+    for (unsigned int b=0; equal && b<owned.n_blocks(); ++b)
+      equal = owned_part_equal(ghosted.block(b), owned.block(b));
+
+    // collective decision: every process either copies or skips
+    const MPI_Comm &communicator = owned.block(0).get_mpi_communicator();
+    if (Utilities::MPI::min(equal ? 1 : 0, communicator) == 1)
+    {
+      n_skips++;
+      return false;
+    }
+
+    ghosted = owned;
+    n_copies++;
+    return true;
+  }  // eom
+
+
+  inline
+  unsigned int GhostUpdater::n_exchanges() const
+  {
+    return n_copies;
+  }  // eom
+
+
+  inline
+  unsigned int GhostUpdater::n_skipped() const
+  {
+    return n_skips;
+  }  // eom
+
+}  // end of namespace
@@ -8,6 +8,7 @@
 
 // custom modules
 #include <BitMap.hpp>
+#include <CellProperties.hpp>
 #include <Parsers.hpp>
 
 
@@ -22,6 +23,8 @@ namespace InputData {
 		get_property_vector(const Function<dim> 														&func,
 	    									const parallel::distributed::Triangulation<dim> &triangulation,
 												Vector<double>      														&dst) const;
+		// evaluate the property functions in the cells of the current mesh
+		void update_cell_properties(const Triangulation<dim> &triangulation);
   public:
     double young_modulus, poisson_ratio, biot_coef,
            lame_constant, shear_modulus;
@@ -29,6 +32,8 @@ namespace InputData {
     double regularization_parameter_kappa;
     double regularization_parameter_epsilon;
     std::string mesh_file_name;
+    // AMG reuse thresholds (see LinearSolvers::PreconditionerReusePolicy)
+    double amg_rebuild_active_set_fraction, amg_rebuild_iteration_factor;
 
     std::vector<int>    displacement_boundary_labels;
     std::vector<int>    displacement_boundary_components;
@@ -37,6 +42,8 @@ namespace InputData {
       *get_young_modulus,
       *get_poisson_ratio,
       *get_fracture_toughness;
+    // material constants in the active cells (see update_cell_properties)
+    CellProperties<dim> cell_properties;
 
   };
 
@@ -64,6 +71,15 @@ namespace InputData {
 	}	 // eom
 
 
+  template <int dim>
+  void PhaseFieldData<dim>::
+  update_cell_properties(const Triangulation<dim> &triangulation)
+  {
+    cell_properties.update(triangulation, *get_young_modulus,
+                           *get_poisson_ratio, *get_fracture_toughness);
+  }  // eom
+
+
   template <int dim>
   class PhaseFieldSolidData : public PhaseFieldData<dim>
   {
@@ -86,14 +102,53 @@ namespace InputData {
     double newton_tolerance;
     int max_newton_iter;
     double t_max, minimum_time_step;
+    // time-step control: Newton steps per Newton solve and residual
+    // reduction per Newton step (0 = only cuts and regrowth), growth and
+    // cut factors, extrapolated initial displacement
+    double target_newton_steps, target_newton_contraction,
+           time_step_growth_factor, time_step_cut_factor;
+    bool extrapolate_initial_guess;
+    // linear solves inside the Newton loops (see LinearSolvers::ForcingTerm):
+    // constant or eisenstat-walker forcing, smallest and largest relative
+    // tolerance, GMRES restart length, iteration limit (0 = system size)
+    std::string linear_solver_forcing;
+    double linear_solver_tolerance, max_forcing_term;
+    unsigned int gmres_restart, max_linear_iterations;
+    // double: AMG block preconditioners, single: float block Jacobi ILU
+    // with a switch to double after a solve that needs more iterations
+    // than the fallback limit
+    std::string preconditioner_precision;
+    unsigned int single_precision_fallback_iterations;
+    // steps between the checks of the single precision convergence rate
+    unsigned int single_precision_check_iterations;
+    // threads per MPI process in the assembly loops
+    unsigned int n_threads;
 
     // Mesh
     int initial_refinement_level, n_prerefinement_steps, n_adaptive_steps;
     double phi_refinement_value;
+    // adaptivity: coarsen where phi > value (0 = never), layers of
+    // neighbors refined around the fracture, cell budget (0 = no limit)
+    double phi_coarsening_value;
+    int refinement_halo, max_active_cells;
+    // load balancing: relative cost of the cells with phi < Adaptive phi
+    // value (0 = fit to the assembly times), steps between the imbalance
+    // checks (0 = weights only applied on refinement), max/mean tolerance
+    double fracture_cell_weight, load_imbalance_tolerance;
+    int load_balancing_interval;
     std::vector<std::pair<double,double>> local_prerefinement_region;
     std::string mesh_file_name;
     // postprocessing
     std::vector<std::string> postprocessing_function_names;
+    // write a restart checkpoint every n time steps (0 = never)
+    int checkpoint_interval;
+    // output: format, every n-th step, minimum time between outputs,
+    // selected fields (empty = all), background writes, vtu compression
+    std::string output_format, output_compression;
+    int output_interval;
+    double output_time_interval;
+    std::vector<std::string> output_fields;
+    bool asynchronous_output;
 
     bool uniform_fracture_toughness, uniform_young_modulus;
     // this is a container for postprocessing function arguments
@@ -154,9 +209,7 @@ namespace InputData {
     else
       this->get_fracture_toughness =
         new BitMap::BitMapFunction<dim>(
-          bitmap_file_name,
-          bitmap_range[0].first, bitmap_range[0].second,
-          bitmap_range[1].first, bitmap_range[1].second,
+          bitmap_file_name, bitmap_range,
           fracture_toughness_limits.first,
           fracture_toughness_limits.second);
 
@@ -166,9 +219,7 @@ namespace InputData {
     else
       this->get_young_modulus =
         new BitMap::BitMapFunction<dim>(
-          bitmap_file_name,
-          bitmap_range[0].first, bitmap_range[0].second,
-          bitmap_range[1].first, bitmap_range[1].second,
+          bitmap_file_name, bitmap_range,
           young_modulus_limits.first,
           young_modulus_limits.second);
 
@@ -196,6 +247,12 @@ namespace InputData {
       prm.declare_entry("Initial global refinement steps", "0", Patterns::Integer(0, 100));
       prm.declare_entry("Adaptive steps", "0", Patterns::Integer(0, 100));
       prm.declare_entry("Adaptive phi value", "0", Patterns::Double(0, 1));
+      prm.declare_entry("Adaptive coarsening phi value", "0", Patterns::Double(0, 1));
+      prm.declare_entry("Adaptive refinement halo", "0", Patterns::Integer(0, 10));
+      prm.declare_entry("Maximum active cells", "0", Patterns::Integer(0));
+      prm.declare_entry("Fracture cell weight", "4", Patterns::Double(0));
+      prm.declare_entry("Load balancing interval", "0", Patterns::Integer(0));
+      prm.declare_entry("Load imbalance tolerance", "1.2", Patterns::Double(1));
       prm.declare_entry("Local refinement region", "",
                         Patterns::List(Patterns::Double()));
       prm.leave_subsection();
@@ -249,14 +306,43 @@ namespace InputData {
       prm.declare_entry("T max", "1", Patterns::Double());
       prm.declare_entry("Time stepping table", "(0, 1e-5)", Patterns::Anything());
       prm.declare_entry("Minimum time step", "1e-9", Patterns::Double());
+      prm.declare_entry("Target Newton steps", "0", Patterns::Double(0));
+      prm.declare_entry("Target Newton contraction", "0", Patterns::Double(0, 1));
+      prm.declare_entry("Time step growth factor", "2", Patterns::Double(1));
+      prm.declare_entry("Time step cut factor", "0.1", Patterns::Double(0, 1));
+      prm.declare_entry("Extrapolate initial guess", "false", Patterns::Bool());
       prm.declare_entry("Newton tolerance", "1e-9", Patterns::Double());
       prm.declare_entry("Max Newton steps", "20", Patterns::Integer());
+      prm.declare_entry("Linear solver forcing", "constant",
+                        Patterns::Selection("constant|eisenstat-walker"));
+      prm.declare_entry("Linear solver tolerance", "1e-10", Patterns::Double(0));
+      prm.declare_entry("Maximum forcing term", "0.1", Patterns::Double(0, 1));
+      prm.declare_entry("GMRES restart", "30", Patterns::Integer(1));
+      prm.declare_entry("Max linear iterations", "0", Patterns::Integer(0));
+      prm.declare_entry("Preconditioner precision", "double",
+                        Patterns::Selection("double|single"));
+      prm.declare_entry("Single precision fallback iterations", "200",
+                        Patterns::Integer(1));
+      prm.declare_entry("Single precision check iterations", "10",
+                        Patterns::Integer(0));
+      prm.declare_entry("Number of threads", "1", Patterns::Integer(1));
+      prm.declare_entry("AMG rebuild active set fraction", "0.05", Patterns::Double(0));
+      prm.declare_entry("AMG rebuild iteration factor", "2", Patterns::Double(1));
       prm.leave_subsection();
     }
     {
       prm.enter_subsection("Postprocessing");
       prm.declare_entry("Functions", "", Patterns::Anything());
       prm.declare_entry("Arguments", "", Patterns::Anything());
+      prm.declare_entry("Checkpoint interval", "0", Patterns::Integer(0));
+      prm.declare_entry("Output format", "vtu",
+                        Patterns::Selection("vtu|parallel vtu|hdf5"));
+      prm.declare_entry("Output interval", "1", Patterns::Integer(0));
+      prm.declare_entry("Output time interval", "0", Patterns::Double(0));
+      prm.declare_entry("Output fields", "", Patterns::Anything());
+      prm.declare_entry("Asynchronous output", "true", Patterns::Bool());
+      prm.declare_entry("Output compression", "speed",
+                        Patterns::Selection("none|speed|best|default"));
       prm.leave_subsection();
     }
   }  // eom
@@ -323,6 +409,16 @@ void PhaseFieldSolidData<dim>::assign_parameters()
     initial_refinement_level = prm.get_integer("Initial global refinement steps");
     n_adaptive_steps = prm.get_integer("Adaptive steps");
     phi_refinement_value = prm.get_double("Adaptive phi value");
+    phi_coarsening_value = prm.get_double("Adaptive coarsening phi value");
+    refinement_halo = prm.get_integer("Adaptive refinement halo");
+    max_active_cells = prm.get_integer("Maximum active cells");
+    fracture_cell_weight = prm.get_double("Fracture cell weight");
+    load_balancing_interval = prm.get_integer("Load balancing interval");
+    load_imbalance_tolerance = prm.get_double("Load imbalance tolerance");
+    AssertThrow(phi_coarsening_value == 0 ||
+                phi_coarsening_value > phi_refinement_value,
+                ExcMessage("Adaptive coarsening phi value should be larger "
+                           "than Adaptive phi value"));
     std::vector<double> tmp =
       Parsers::parse_string_list<double>(prm.get("Local refinement region"));
     local_prerefinement_region.resize(dim);
@@ -413,12 +509,41 @@ void PhaseFieldSolidData<dim>::assign_parameters()
       this->timestep_table[row[0]] = row[1];
 
     this->minimum_time_step = prm.get_double("Minimum time step");
+    this->target_newton_steps = prm.get_double("Target Newton steps");
+    this->target_newton_contraction =
+      prm.get_double("Target Newton contraction");
+    this->time_step_growth_factor = prm.get_double("Time step growth factor");
+    this->time_step_cut_factor = prm.get_double("Time step cut factor");
+    this->extrapolate_initial_guess = prm.get_bool("Extrapolate initial guess");
     this->newton_tolerance = prm.get_double("Newton tolerance");
     this->max_newton_iter = prm.get_integer("Max Newton steps");
+    this->linear_solver_forcing = prm.get("Linear solver forcing");
+    this->linear_solver_tolerance = prm.get_double("Linear solver tolerance");
+    this->max_forcing_term = prm.get_double("Maximum forcing term");
+    this->gmres_restart = prm.get_integer("GMRES restart");
+    this->max_linear_iterations = prm.get_integer("Max linear iterations");
+    this->preconditioner_precision = prm.get("Preconditioner precision");
+    this->single_precision_fallback_iterations =
+      prm.get_integer("Single precision fallback iterations");
+    this->single_precision_check_iterations =
+      prm.get_integer("Single precision check iterations");
+    this->n_threads = prm.get_integer("Number of threads");
+    this->amg_rebuild_active_set_fraction =
+      prm.get_double("AMG rebuild active set fraction");
+    this->amg_rebuild_iteration_factor =
+      prm.get_double("AMG rebuild iteration factor");
     prm.leave_subsection();
   }
   { // Postprocessing
     prm.enter_subsection("Postprocessing");
+    checkpoint_interval = prm.get_integer("Checkpoint interval");
+    output_format = prm.get("Output format");
+    output_compression = prm.get("Output compression");
+    output_interval = prm.get_integer("Output interval");
+    output_time_interval = prm.get_double("Output time interval");
+    output_fields =
+        Parsers::parse_string_list<std::string>(prm.get("Output fields"));
+    asynchronous_output = prm.get_bool("Asynchronous output");
     postprocessing_function_names =
         Parsers::parse_string_list<std::string>(prm.get("Functions"));
 
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <deal.II/base/utilities.h>
+#include <deal.II/distributed/tria.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/dofs/dof_accessor.h>
+#include <deal.II/fe/fe.h>
+#include <deal.II/lac/trilinos_block_vector.h>
+
+#include <boost/signals2/connection.hpp>
+
+#include <algorithm>    // std::min, std::max
+#include <cmath>        // std::round, std::isfinite
+#include <limits>       // std::numeric_limits
+#include <vector>
+
+
+namespace Mesher
+{
+  using namespace dealii;
+
+  /*
+    Weighted partitioning of the triangulation.
+    Cells in the fracture zone (minimum phase field below a threshold)
+    cost more than reservoir cells: active set, split branches, width
+    system. The balancer listens to the cell_weight signal of the
+    triangulation, so every execute_coarsening_and_refinement (also with no
+    flags set, which then only repartitions) distributes the weights
+    instead of the cell count. update_weights must be called before.
+
+    Rebalancing trigger: the drivers pass the accumulated wall time of the
+    local assembly work; every n-th time step the imbalance
+    max/mean of the work done since the last check is compared with a
+    tolerance.
+    With a fracture cell weight of 0 the ratio of the cost of fracture and
+    reservoir cells is fitted to the measured times (least squares over
+    the processes) at every check.
+   */
+  template <int dim>
+  class LoadBalancer
+  {
+  public:
+    LoadBalancer(parallel::distributed::Triangulation<dim> &triangulation_,
+                 MPI_Comm                                  &mpi_communicator_);
+    ~LoadBalancer();
+
+    void set_parameters(const double fracture_cell_weight_,
+                        const double imbalance_tolerance_,
+                        const int    interval_);
+    // mark the locally owned cells with phi < phi_threshold as fracture cells
+    void update_weights(const DoFHandler<dim>                    &dof_handler,
+                        const TrilinosWrappers::MPI::BlockVector &relevant_solution,
+                        const double                              phi_threshold);
+    // work_time: accumulated local wall time of the balanced work
+    bool need_rebalance(const int    time_step_number,
+                        const double work_time);
+    double get_imbalance() const;
+
+  private:
+    unsigned int cell_weight(const typename Triangulation<dim>::cell_iterator &cell,
+                             const typename parallel::distributed::Triangulation<dim>::CellStatus status) const;
+    void fit_fracture_cell_weight(const double local_work);
+
+    parallel::distributed::Triangulation<dim> &triangulation;
+    MPI_Comm                                  &mpi_communicator;
+    boost::signals2::connection                weight_listener;
+    double                                     fracture_cell_weight,
+                                               fitted_weight,
+                                               imbalance_tolerance,
+                                               last_work_time,
+                                               imbalance;
+    int                                        interval;
+    // 1 for fracture cells [active cell index]
+    std::vector<unsigned char>                 fracture_cell;
+  };
+
+
+  template <int dim>
+  LoadBalancer<dim>::
+  LoadBalancer(parallel::distributed::Triangulation<dim> &triangulation_,
+               MPI_Comm                                  &mpi_communicator_)
+  :
+  triangulation(triangulation_),
+  mpi_communicator(mpi_communicator_),
+  fracture_cell_weight(1),
+  fitted_weight(1),
+  imbalance_tolerance(std::numeric_limits<double>::max()),
+  last_work_time(0),
+  imbalance(1),
+  interval(0)
+  {
+    weight_listener = triangulation.signals.cell_weight.connect
+      ([this](const typename Triangulation<dim>::cell_iterator &cell,
+              const typename parallel::distributed::Triangulation<dim>::CellStatus status)
+       -> unsigned int
+       {
+         return this->cell_weight(cell, status);
+       });
+  }  // eom
+
+
+  template <int dim>
+  LoadBalancer<dim>::~LoadBalancer()
+  {
+    weight_listener.disconnect();
+  }  // eom
+
+
+  template <int dim>
+  void LoadBalancer<dim>::set_parameters(const double fracture_cell_weight_,
+                                         const double imbalance_tolerance_,
+                                         const int    interval_)
+  {
+    fracture_cell_weight = fracture_cell_weight_;
+    imbalance_tolerance = imbalance_tolerance_;
+    interval = interval_;
+    // starting value of the fit
+    fitted_weight = (fracture_cell_weight > 0) ? fracture_cell_weight : 1;
+  }  // eom
+
+
+  template <int dim>
+  double LoadBalancer<dim>::get_imbalance() const
+  {
+    return imbalance;
+  }  // eom
+
+
+  template <int dim>
+  void LoadBalancer<dim>::
+  update_weights(const DoFHandler<dim>                    &dof_handler,
+                 const TrilinosWrappers::MPI::BlockVector &relevant_solution,
+                 const double                              phi_threshold)
+  {
+    const FiniteElement<dim> &fe = dof_handler.get_fe();
+    std::vector<types::global_dof_index> local_dof_indices(fe.dofs_per_cell);
+    fracture_cell.assign(triangulation.n_active_cells(), 0);
+
+    typename DoFHandler<dim>::active_cell_iterator
+      cell = dof_handler.begin_active(),
+      endc = dof_handler.end();
+    for (; cell!=endc; ++cell)
+      if (cell->is_locally_owned())
+      {
+        cell->get_dof_indices(local_dof_indices);
+        for (unsigned int i=0; i<fe.dofs_per_cell; ++i)
+          if (fe.system_to_component_index(i).first == dim &&
+              relevant_solution(local_dof_indices[i]) < phi_threshold)
+          {
+            fracture_cell[cell->active_cell_index()] = 1;
+            break;
+          }
+      }  // end cell loop
+  }  // eom
+
+
+  template <int dim>
+  unsigned int LoadBalancer<dim>::
+  cell_weight(const typename Triangulation<dim>::cell_iterator &cell,
+              const typename parallel::distributed::Triangulation<dim>::CellStatus) const
+  {
+    // weights are added to the default weight of 1000 per cell;
+    // cells to be coarsened are passed as the parent of active cells
+    unsigned int index = numbers::invalid_unsigned_int;
+    if (cell->active())
+      index = cell->active_cell_index();
+    else if (cell->has_children() && cell->child(0)->active())
+      index = cell->child(0)->active_cell_index();
+
+    if (index >= fracture_cell.size() || fracture_cell[index] == 0)
+      return 0;
+
+    const double weight = (fracture_cell_weight > 0) ?
+                          fracture_cell_weight : fitted_weight;
+    return static_cast<unsigned int>(std::round(1000*std::max(weight - 1.0, 0.0)));
+  }  // eom
+
+
+  template <int dim>
+  bool LoadBalancer<dim>::need_rebalance(const int    time_step_number,
+                                         const double work_time)
+  {
+    if (interval <= 0 || time_step_number % interval != 0)
+      return false;
+
+    const double local_work = work_time - last_work_time;
+    last_work_time = work_time;
+
+    const double max_work = Utilities::MPI::max(local_work, mpi_communicator);
+    const double mean_work = Utilities::MPI::sum(local_work, mpi_communicator)/
+      Utilities::MPI::n_mpi_processes(mpi_communicator);
+    imbalance = (mean_work > 0) ? max_work/mean_work : 1;
+
+    if (fracture_cell_weight <= 0)
+      fit_fracture_cell_weight(local_work);
+
+    return (imbalance > imbalance_tolerance);
+  }  // eom
+
+
+  template <int dim>
+  void LoadBalancer<dim>::fit_fracture_cell_weight(const double local_work)
+  {
+    /*
+      work_p = c_r*n_r,p + c_f*n_f,p on every process p:
+      normal equations of the least squares problem for (c_r, c_f)
+     */
+    double n_fracture = 0, n_reservoir = 0;
+    typename Triangulation<dim>::active_cell_iterator
+      cell = triangulation.begin_active(),
+      endc = triangulation.end();
+    for (; cell!=endc; ++cell)
+      if (cell->is_locally_owned())
+      {
+        const unsigned int c = cell->active_cell_index();
+        if (c < fracture_cell.size() && fracture_cell[c])
+          n_fracture += 1;
+        else
+          n_reservoir += 1;
+      }
+
+    std::vector<double> local(5), global(5);
+    local[0] = n_reservoir*n_reservoir;
+    local[1] = n_reservoir*n_fracture;
+    local[2] = n_fracture*n_fracture;
+    local[3] = n_reservoir*local_work;
+    local[4] = n_fracture*local_work;
+    Utilities::MPI::sum(local, mpi_communicator, global);
+
+    const double det = global[0]*global[2] - global[1]*global[1];
+    if (std::abs(det) <= 1e-12*global[0]*global[2])
+      return;  // not enough variation in the fracture cell counts
+    const double c_r = (global[2]*global[3] - global[1]*global[4])/det;
+    const double c_f = (global[0]*global[4] - global[1]*global[3])/det;
+    if (c_r > 0 && c_f > 0 && std::isfinite(c_f/c_r))
+      fitted_weight = std::min(std::max(c_f/c_r, 1.0), 100.0);
+  }  // eom
+
+}  // end of namespace
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <deal.II/base/utilities.h>
+#include <deal.II/base/conditional_ostream.h>
 // dealii mesh modules
 #include <deal.II/distributed/tria.h>
 #include <deal.II/distributed/grid_refinement.h>
@@ -13,77 +14,210 @@ namespace Mesher {
   using namespace dealii;
 
 
+  // kind of mesh change prepared by prepare_phase_field_refinement
+  enum class MeshChange {none, coarsening, refinement};
+
+
   template <int dim>
-  bool
-  prepare_phase_field_refinement(PhaseField::PhaseFieldSolver<dim> &pf,
-                                 const double min_phi_value,
+  bool point_in_region(const Point<dim>                              &p,
+                       const std::vector< std::pair<double,double> > &region)
+  {
+    for (int d=0; d<dim; ++d)
+      if (p[d] <= region[d].first || p[d] >= region[d].second)
+        return false;
+    return true;
+  }  // eom
+
+
+  template <int dim>
+  MeshChange
+  prepare_phase_field_refinement(PhaseField::PhaseFieldSolver<dim>         &pf,
+                                 const InputData::PhaseFieldSolidData<dim> &data,
                                  const int max_refinement_level)
-  { // refine if phase field < constant
+  {
+    /*
+      Flags cells for adaptivity from the minimum phase-field value
+      in a cell:
+        phi < Adaptive phi value                   -> refine
+        phi > Adaptive coarsening phi value (> 0)  -> coarsen
+      The gap between the two values is a hysteresis band: cells
+      refined when the fracture passes stay refined until phi is well
+      above the refinement value.
+      Predictor: a halo of "Adaptive refinement halo" layers of face
+      neighbors around the refined cells is refined as well, so the
+      fracture tip stays in the refined zone for a few time steps and
+      fewer steps have to be redone (the halo is limited by the ghost
+      layer at process boundaries).
+      Budget: with "Maximum active cells" > 0 only the cells with the
+      smallest phi (then the inner halo layers) are refined so that
+      the mesh doesn't exceed the budget.
+      Cells are not coarsened below the initial global refinement level
+      or inside the local prerefinement region.
+      Returns which kind of mesh change the flags lead to; only
+      refinement requires redoing the time step.
+     */
+    const Triangulation<dim> &triangulation = pf.triangulation;
+    pf.update_relevant_solution();
+
+    const unsigned int dofs_per_cell = pf.fe.dofs_per_cell;
+    std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
+    const double never = std::numeric_limits<double>::max();
+
+    // minimum phase field in the non-artificial cells
+    std::vector<double> min_phi(triangulation.n_active_cells(), never);
+    typename DoFHandler<dim>::active_cell_iterator
+      cell = pf.dof_handler.begin_active(),
+      endc = pf.dof_handler.end();
+    for (; cell != endc; ++cell)
+      if (!cell->is_artificial())
+      {
+        cell->get_dof_indices(local_dof_indices);
+        double &phi = min_phi[cell->active_cell_index()];
+        for (unsigned int i=0; i<dofs_per_cell; ++i)
+          if (pf.fe.system_to_component_index(i).first == dim)
+            phi = std::min(phi, pf.relevant_solution(local_dof_indices[i]));
+      }  // end cell loop
+
+    /*
+      Refinement priority of the cells (smaller = more important):
+      phi in the cells with phi < threshold, threshold + layer in the halo,
+      never elsewhere
+     */
+    std::vector<double> priority(triangulation.n_active_cells(), never);
+    for (unsigned int c=0; c<min_phi.size(); ++c)
+      if (min_phi[c] < data.phi_refinement_value)
+        priority[c] = min_phi[c];
+
+    for (int layer=1; layer<=data.refinement_halo; ++layer)
     {
-      pf.relevant_solution = pf.solution;
-
-      const int dofs_per_cell = pf.fe.dofs_per_cell;
-      std::vector<unsigned int> local_dof_indices(dofs_per_cell);
-
-      typename DoFHandler<dim>::active_cell_iterator
-        cell = pf.dof_handler.begin_active(),
-        endc = pf.dof_handler.end();
-
-        for (; cell != endc; ++cell)
-          if (cell->is_locally_owned())
-          {
-            cell->get_dof_indices(local_dof_indices);
-              for (int i=0; i<dofs_per_cell; ++i)
-              {
-                const int c = pf.fe.system_to_component_index(i).first;
-                if (c == dim)
+      const std::vector<double> old_priority = priority;
+      for (cell = pf.dof_handler.begin_active(); cell != endc; ++cell)
+        if (!cell->is_artificial() && old_priority[cell->active_cell_index()] < never)
+          for (unsigned int f=0; f<GeometryInfo<dim>::faces_per_cell; ++f)
+            if (!cell->at_boundary(f))
+            {
+              // a finer neighbor across a hanging face is the set of
+              // its children on the subfaces
+              std::vector<typename DoFHandler<dim>::active_cell_iterator> neighbors;
+              if (cell->neighbor(f)->active())
+                neighbors.push_back(cell->neighbor(f));
+              else
+                for (unsigned int sf=0; sf<cell->face(f)->n_children(); ++sf)
+                  neighbors.push_back(cell->neighbor_child_on_subface(f, sf));
+
+              for (const auto & neighbor : neighbors)
+                if (!neighbor->is_artificial())
                 {
-                  double phi_value = pf.relevant_solution(local_dof_indices[i]);
-                  if (phi_value < min_phi_value)
-                    {
-                      cell->set_refine_flag();
-                      break; /*dof loop*/
-                    }
-                }  // end if comp
-              }  // end dof loop
-          }  // end cell looop
-    }
-
-    {  // don't refine beyond max level
-      typename DoFHandler<dim>::active_cell_iterator
-        cell = pf.dof_handler.begin_active(),
-        endc = pf.dof_handler.end();
+                  const unsigned int n = neighbor->active_cell_index();
+                  if (priority[n] == never)
+                    priority[n] = data.phi_refinement_value + layer;
+                }
+            }
+    }  // end halo layers
 
-      for (; cell != endc; ++cell)
-        if (cell->is_locally_owned()
-            && cell->level() == max_refinement_level)
-          cell->clear_refine_flag();
-    }
+    // refinable cells with priority below the threshold
+    const auto count_refined = [&](const double threshold)
+      {
+        unsigned int n = 0;
+        for (cell = pf.dof_handler.begin_active(); cell != endc; ++cell)
+          if (cell->is_locally_owned() &&
+              cell->level() < max_refinement_level &&
+              priority[cell->active_cell_index()] < threshold)
+            n++;
+        return Utilities::MPI::sum(n, pf.mpi_communicator);
+      };
+
+    double threshold = never;
+    if (data.max_active_cells > 0)
+    {
+      const unsigned int children = GeometryInfo<dim>::max_children_per_cell - 1;
+      const unsigned int n_cells = pf.triangulation.n_global_active_cells();
+      const unsigned int n_allowed =
+        (static_cast<unsigned int>(data.max_active_cells) > n_cells) ?
+        (data.max_active_cells - n_cells)/children : 0;
+
+      if (count_refined(threshold) > n_allowed)
+      {  // bisect for the largest threshold within the budget
+        double low = -1, high = data.phi_refinement_value + data.refinement_halo + 1;
+        for (int it=0; it<50; ++it)
+        {
+          const double mid = 0.5*(low + high);
+          if (count_refined(mid) > n_allowed)
+            high = mid;
+          else
+            low = mid;
+        }
+        threshold = low;
+      }
+    }  // end budget
+
+    for (cell = pf.dof_handler.begin_active(); cell != endc; ++cell)
+      if (cell->is_locally_owned())
+      {
+        const unsigned int c = cell->active_cell_index();
+        if (priority[c] < threshold && cell->level() < max_refinement_level)
+          cell->set_refine_flag();
+        else if (data.phi_coarsening_value > 0 &&
+                 priority[c] == never &&
+                 min_phi[c] > data.phi_coarsening_value &&
+                 cell->level() > data.initial_refinement_level &&
+                 !point_in_region(cell->center(), data.local_prerefinement_region))
+          cell->set_coarsen_flag();
+      }  // end cell loop
 
     {  // determine whether mesh is changed
-      bool any_change = false;
       pf.triangulation.prepare_coarsening_and_refinement();
 
-      typename DoFHandler<dim>::active_cell_iterator
-        cell = pf.dof_handler.begin_active(),
-        endc = pf.dof_handler.end();
+      unsigned int n_refine = 0, n_coarsen = 0;
+      for (cell = pf.dof_handler.begin_active(); cell != endc; ++cell)
+        if (cell->is_locally_owned())
+        {
+          if (cell->refine_flag_set())
+            n_refine++;
+          if (cell->coarsen_flag_set())
+            n_coarsen++;
+        }
 
-      for (; cell != endc; ++cell)
-        if (cell->is_locally_owned() &&
-            (cell->refine_flag_set() || cell->coarsen_flag_set()))
-          {
-            any_change = true;
-            break;
-          }
-
-      if (Utilities::MPI::sum(any_change?1:0, pf.mpi_communicator)==0)
-        return false;
+      if (Utilities::MPI::sum(n_refine, pf.mpi_communicator) > 0)
+        return MeshChange::refinement;
+      else if (Utilities::MPI::sum(n_coarsen, pf.mpi_communicator) > 0)
+        return MeshChange::coarsening;
       else
-        return true;
+        return MeshChange::none;
     }  // end check
 
   }  // eom
 
+
+  template <int dim, typename Refinement>
+  bool
+  adapt_phase_field_mesh(PhaseField::PhaseFieldSolver<dim>         &pf,
+                         const InputData::PhaseFieldSolidData<dim> &data,
+                         const int                                  max_refinement_level,
+                         ConditionalOStream                        &pcout,
+                         Refinement                                 execute_refinement)
+  {
+    /*
+      Predictor-corrector adaptivity step of the drivers: flags the
+      cells (prepare_phase_field_refinement) and, if the mesh changes,
+      calls execute_refinement to transfer the solution.
+      Coarsening away from the fracture doesn't change the solution of
+      this step; returns true only after refinement, when the time step
+      must be redone.
+     */
+    const MeshChange mesh_change =
+      prepare_phase_field_refinement(pf, data, max_refinement_level);
+    if (mesh_change == MeshChange::none)
+      return false;
+
+    pcout << std::endl
+          << "Adapting mesh"
+          << std::endl;
+    execute_refinement();
+    return (mesh_change == MeshChange::refinement);
+  }  // eom
+
+
   template <int dim>
   double
   compute_minimum_mesh_size(parallel::distributed::Triangulation<dim> &triangulation,
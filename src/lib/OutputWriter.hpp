@@ -0,0 +1,260 @@
+#pragma once
+
+#include <deal.II/base/exceptions.h>
+#include <deal.II/base/utilities.h>
+#include <deal.II/numerics/data_out.h>
+
+#include <algorithm>    // std::find
+#include <fstream>
+#include <iostream>
+#include <limits>       // std::numeric_limits
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace Output
+{
+  using namespace dealii;
+
+  /*
+    Writes the DataOut objects built by the drivers.
+    Formats:
+      vtu          - one vtu per process + pvtu + pvd (default)
+      parallel vtu - one vtu per time step through MPI-IO + pvd
+      hdf5         - one h5 file per time step + xdmf (requires deal.II
+                     with HDF5)
+    With asynchronous output the vtu file of a process is encoded into
+    memory and put on disk by a background thread, so the time loop
+    continues while the file system is busy. At most one write is in
+    flight; the next write (or the destructor) waits for it.
+    The collective formats are written synchronously.
+
+    Output can be limited to every n-th time step and/or a minimum time
+    between two outputs, and to a subset of the fields (empty = all).
+   */
+  class Writer
+  {
+  public:
+    Writer(MPI_Comm &mpi_communicator_);
+    ~Writer();
+    void set_parameters(const std::string              &directory_,
+                        const std::string              &format_,
+                        const int                       interval_,
+                        const double                    time_interval_,
+                        const std::vector<std::string> &fields_,
+                        const bool                      asynchronous_,
+                        const std::string              &compression_);
+    // whether output is due at this time step
+    bool need_output(const int time_step_number, const double time) const;
+    // whether the field is selected for output
+    bool write_field(const std::string &field_name) const;
+    // data_out must have the patches built. times_and_names gets the pvd
+    // record of this output (vtu formats).
+    template <int dim>
+    void write(DataOut<dim>                                   &data_out,
+               const int                                       time_step_number,
+               const double                                    time,
+               std::vector< std::pair<double,std::string> >   &times_and_names);
+    // wait for the background write to finish
+    void flush();
+
+  private:
+    std::string file_base(const int time_step_number) const;
+
+    MPI_Comm    &mpi_communicator;
+    std::string directory, format;
+    int         interval;
+    double      time_interval, last_output_time;
+    std::vector<std::string> fields;
+    bool        asynchronous;
+    DataOutBase::VtkFlags::ZlibCompressionLevel compression;
+    std::thread io_thread;
+#ifdef DEAL_II_WITH_HDF5
+    std::vector<XDMFEntry> xdmf_entries;
+#endif
+  };
+
+
+  inline
+  Writer::Writer(MPI_Comm &mpi_communicator_)
+  :
+  mpi_communicator(mpi_communicator_),
+  directory("."),
+  format("vtu"),
+  interval(1),
+  time_interval(0),
+  last_output_time(-std::numeric_limits<double>::max()),
+  asynchronous(false),
+  compression(DataOutBase::VtkFlags::best_speed)
+  {}  // eom
+
+
+  inline
+  Writer::~Writer()
+  {
+    flush();
+  }  // eom
+
+
+  inline
+  void Writer::set_parameters(const std::string              &directory_,
+                              const std::string              &format_,
+                              const int                       interval_,
+                              const double                    time_interval_,
+                              const std::vector<std::string> &fields_,
+                              const bool                      asynchronous_,
+                              const std::string              &compression_)
+  {
+    directory = directory_;
+    format = format_;
+    interval = interval_;
+    time_interval = time_interval_;
+    fields = fields_;
+    asynchronous = asynchronous_;
+
+    if (compression_ == "none")
+      compression = DataOutBase::VtkFlags::no_compression;
+    else if (compression_ == "speed")
+      compression = DataOutBase::VtkFlags::best_speed;
+    else if (compression_ == "best")
+      compression = DataOutBase::VtkFlags::best_compression;
+    else
+      compression = DataOutBase::VtkFlags::default_compression;
+
+#ifndef DEAL_II_WITH_HDF5
+    AssertThrow(format != "hdf5",
+                ExcMessage("hdf5 output requires deal.II with HDF5"));
+#endif
+  }  // eom
+
+
+  inline
+  bool Writer::need_output(const int    time_step_number,
+                           const double time) const
+  {
+    if (interval <= 0 || time_step_number % interval != 0)
+      return false;
+    return (time - last_output_time >= time_interval);
+  }  // eom
+
+
+  inline
+  bool Writer::write_field(const std::string &field_name) const
+  {
+    if (fields.size() == 0)
+      return true;
+    return (std::find(fields.begin(), fields.end(), field_name) != fields.end());
+  }  // eom
+
+
+  inline
+  std::string Writer::file_base(const int time_step_number) const
+  {
+    return "solution-" + Utilities::int_to_string(time_step_number, 3);
+  }  // eom
+
+
+  inline
+  void Writer::flush()
+  {
+    if (io_thread.joinable())
+      io_thread.join();
+  }  // eom
+
+
+  template <int dim>
+  void Writer::write(DataOut<dim>                                 &data_out,
+                     const int                                     time_step_number,
+                     const double                                  time,
+                     std::vector< std::pair<double,std::string> > &times_and_names)
+  {
+    last_output_time = time;
+    const unsigned int this_process =
+      Utilities::MPI::this_mpi_process(mpi_communicator);
+    const std::string base = file_base(time_step_number);
+
+#ifdef DEAL_II_WITH_HDF5
+    if (format == "hdf5")
+    {
+      DataOutBase::DataOutFilter
+        data_filter(DataOutBase::DataOutFilterFlags(true, true));
+      data_out.write_filtered_data(data_filter);
+      const std::string h5_name = base + ".h5";
+      data_out.write_hdf5_parallel(data_filter, directory + "/" + h5_name,
+                                   mpi_communicator);
+      // file names in the xdmf record are relative to the xdmf file
+      xdmf_entries.push_back(data_out.create_xdmf_entry(data_filter, h5_name,
+                                                        time, mpi_communicator));
+      data_out.write_xdmf_file(xdmf_entries, directory + "/solution.xdmf",
+                               mpi_communicator);
+      return;
+    }
+#endif
+
+    DataOutBase::VtkFlags flags;
+    flags.time = time;
+    flags.cycle = time_step_number;
+    flags.compression_level = compression;
+    data_out.set_flags(flags);
+
+    std::string pvd_entry;
+    if (format == "parallel vtu")
+    {
+      pvd_entry = "./vtu/" + base + ".vtu";
+      data_out.write_vtu_in_parallel((directory + "/vtu/" + base + ".vtu").c_str(),
+                                     mpi_communicator);
+    }
+    else
+    {
+      const std::string local_name =
+        base + "." + Utilities::int_to_string(this_process, 3) + ".vtu";
+      const std::string file_name = directory + "/vtu/" + local_name;
+
+      if (asynchronous)
+      {
+        std::ostringstream buffer;
+        data_out.write_vtu(buffer);
+        flush();
+        io_thread = std::thread([file_name](const std::string &content)
+                                {
+                                  std::ofstream output(file_name.c_str(),
+                                                       std::ios::binary);
+                                  output << content;
+                                  if (!output)
+                                    std::cerr << "Failed to write "
+                                              << file_name << std::endl;
+                                },
+                                buffer.str());
+      }
+      else
+      {
+        std::ofstream output(file_name.c_str());
+        data_out.write_vtu(output);
+      }
+
+      pvd_entry = "./vtu/" + base + ".pvtu";
+      if (this_process == 0)
+      {
+        std::vector<std::string> filenames;
+        for (unsigned int i=0;
+             i<Utilities::MPI::n_mpi_processes(mpi_communicator);
+             ++i)
+          filenames.push_back(base + "." + Utilities::int_to_string(i, 3) + ".vtu");
+        std::ofstream
+          master_output((directory + "/vtu/" + base + ".pvtu").c_str());
+        data_out.write_pvtu_record(master_output, filenames);
+      }
+    }
+
+    // write pvd file
+    times_and_names.push_back(std::pair<double,std::string>(time, pvd_entry));
+    if (this_process == 0)
+    {
+      std::ofstream pvd_master((directory + "/solution.pvd").c_str());
+      data_out.write_pvd_record(pvd_master, times_and_names);
+    }
+  }  // eom
+
+}  // end of namespace
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <deal.II/base/exceptions.h>
+#include <deal.II/base/utilities.h>
+
+#include <algorithm>    // std::find
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+namespace Output
+{
+  using namespace dealii;
+
+  /*
+    Per-time-step performance records, one CSV line per time step:
+      step, time, dt,
+      <section>_min, <section>_max, <section>_avg  wall time [s] of the
+                                                  phases over the processes
+      <counter>                                   iteration counts, sizes
+      memory_min, memory_max, memory_avg          peak resident memory [MB]
+    The columns are fixed by the sections and counters declared before the
+    first record. Sections accumulate over repeated start/stop pairs
+    within a step (FSS iterations, redone steps); start of a running section
+    and end_step close it. Counters are summed within a step (add) or
+    overwritten (set) and are taken from process 0, since the drivers only
+    log global values.
+    The file is written by process 0 and appended to on restart.
+   */
+  class PerformanceLog
+  {
+  public:
+    PerformanceLog(MPI_Comm &mpi_communicator_);
+    void add_section(const std::string &name);
+    void add_counter(const std::string &name);
+    // empty file name disables the output (timers still run)
+    void set_file(const std::string &file_name_, const bool append);
+
+    void start(const std::string &section);
+    void stop(const std::string &section);
+    void add(const std::string &counter, const double value);
+    void set(const std::string &counter, const double value);
+    // reduce over the processes, write the record and reset
+    void end_step(const int time_step_number, const double time,
+                  const double time_step);
+
+  private:
+    typedef std::chrono::steady_clock Clock;
+
+    unsigned int section_index(const std::string &name) const;
+    unsigned int counter_index(const std::string &name) const;
+    void write_header();
+
+    MPI_Comm                       &mpi_communicator;
+    std::string                     file_name;
+    bool                            header_written;
+    std::vector<std::string>        section_names, counter_names;
+    std::vector<double>             section_times, counter_values;
+    std::vector<bool>               running;
+    std::vector<Clock::time_point>  start_times;
+  };
+
+
+  inline
+  PerformanceLog::PerformanceLog(MPI_Comm &mpi_communicator_)
+  :
+  mpi_communicator(mpi_communicator_),
+  header_written(false)
+  {}  // eom
+
+
+  inline
+  void PerformanceLog::add_section(const std::string &name)
+  {
+    AssertThrow(!header_written,
+                ExcMessage("Sections must be added before the first record"));
+    section_names.push_back(name);
+    section_times.push_back(0);
+    running.push_back(false);
+    start_times.push_back(Clock::now());
+  }  // eom
+
+
+  inline
+  void PerformanceLog::add_counter(const std::string &name)
+  {
+    AssertThrow(!header_written,
+                ExcMessage("Counters must be added before the first record"));
+    counter_names.push_back(name);
+    counter_values.push_back(0);
+  }  // eom
+
+
+  inline
+  void PerformanceLog::set_file(const std::string &file_name_,
+                                const bool         append)
+  {
+    file_name = file_name_;
+    // a restarted run continues the records of the previous one
+    header_written = append;
+    if (file_name.empty() || append ||
+        Utilities::MPI::this_mpi_process(mpi_communicator) != 0)
+      return;
+    std::ofstream f(file_name.c_str());
+    AssertThrow(f, ExcMessage("Can't write to <" + file_name + ">"));
+  }  // eom
+
+
+  inline
+  unsigned int PerformanceLog::section_index(const std::string &name) const
+  {
+    const unsigned int i =
+      std::find(section_names.begin(), section_names.end(), name)
+      - section_names.begin();
+    AssertThrow(i < section_names.size(),
+                ExcMessage("Unknown performance section " + name));
+    return i;
+  }  // eom
+
+
+  inline
+  unsigned int PerformanceLog::counter_index(const std::string &name) const
+  {
+    const unsigned int i =
+      std::find(counter_names.begin(), counter_names.end(), name)
+      - counter_names.begin();
+    AssertThrow(i < counter_names.size(),
+                ExcMessage("Unknown performance counter " + name));
+    return i;
+  }  // eom
+
+
+  inline
+  void PerformanceLog::start(const std::string &section)
+  {
+    const unsigned int i = section_index(section);
+    if (running[i])
+      stop(section);
+    running[i] = true;
+    start_times[i] = Clock::now();
+  }  // eom
+
+
+  inline
+  void PerformanceLog::stop(const std::string &section)
+  {
+    const unsigned int i = section_index(section);
+    if (!running[i])
+      return;
+    running[i] = false;
+    section_times[i] +=
+      std::chrono::duration<double>(Clock::now() - start_times[i]).count();
+  }  // eom
+
+
+  inline
+  void PerformanceLog::add(const std::string &counter, const double value)
+  {
+    counter_values[counter_index(counter)] += value;
+  }  // eom
+
+
+  inline
+  void PerformanceLog::set(const std::string &counter, const double value)
+  {
+    counter_values[counter_index(counter)] = value;
+  }  // eom
+
+
+  inline
+  void PerformanceLog::write_header()
+  {
+    std::ofstream f(file_name.c_str(), std::ios::app);
+    f << "step,time,dt";
+    for (unsigned int i=0; i<section_names.size(); ++i)
+      f << "," << section_names[i] << "_min"
+        << "," << section_names[i] << "_max"
+        << "," << section_names[i] << "_avg";
+    for (unsigned int i=0; i<counter_names.size(); ++i)
+      f << "," << counter_names[i];
+    f << ",memory_min,memory_max,memory_avg" << std::endl;
+  }  // eom
+
+
+  inline
+  void PerformanceLog::end_step(const int    time_step_number,
+                                const double time,
+                                const double time_step)
+  {
+    for (unsigned int i=0; i<section_names.size(); ++i)
+      stop(section_names[i]);
+
+    std::vector<Utilities::MPI::MinMaxAvg> section_stats(section_names.size());
+    for (unsigned int i=0; i<section_names.size(); ++i)
+      section_stats[i] = Utilities::MPI::min_max_avg(section_times[i],
+                                                     mpi_communicator);
+
+    Utilities::System::MemoryStats memory;
+    Utilities::System::get_memory_stats(memory);
+    const Utilities::MPI::MinMaxAvg memory_stats =
+      Utilities::MPI::min_max_avg(memory.VmHWM/1024.0, mpi_communicator);
+
+    if (!file_name.empty() &&
+        Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
+    {
+      if (!header_written)
+        write_header();
+      header_written = true;
+
+      std::ofstream f(file_name.c_str(), std::ios::app);
+      f.precision(6);
+      f << time_step_number << "," << time << "," << time_step;
+      for (unsigned int i=0; i<section_stats.size(); ++i)
+        f << "," << section_stats[i].min
+          << "," << section_stats[i].max
+          << "," << section_stats[i].avg;
+      for (unsigned int i=0; i<counter_values.size(); ++i)
+        f << "," << counter_values[i];
+      f << "," << memory_stats.min
+        << "," << memory_stats.max
+        << "," << memory_stats.avg << std::endl;
+    }
+    header_written = true;
+
+    std::fill(section_times.begin(), section_times.end(), 0);
+    std::fill(counter_values.begin(), counter_values.end(), 0);
+  }  // eom
+
+}  // end of namespace
@@ -29,12 +29,24 @@
 
 // standard c++ modules
 #include <cmath>        // std:: math functions
+#include <memory>       // std::unique_ptr
 
 // Custom modules
+#include <AssemblyCache.hpp>
+#include <AssemblyData.hpp>
+#include <FieldCache.hpp>
 #include <ConstitutiveModel.hpp>
+#include <ForcingTerm.hpp>
 #include <InputData.hpp>
 #include <LinearSolver.hpp>
+#include <PreconditionerReuse.hpp>
+#include <SinglePrecisionPreconditioner.hpp>
+#include <SpectralSplit.hpp>
+#include <SplitPolicies.hpp>
 #include <DecompositionHeister.hpp>
+#include <DofUtilities.hpp>
+#include <GhostUpdater.hpp>
+#include <PointLocator.hpp>
 
 
 namespace PhaseField
@@ -94,18 +106,83 @@ public:
 
 	void update_old_solution();
 	bool active_set_changed(const IndexSet &) const;
+	// number of dofs that entered or left the active set in the last
+	// call of compute_active_set (summed over all processes)
+	unsigned int active_set_changes() const;
+	// accumulated wall time of the cell loops of this process
+	// (measure of the local work for the load balancing)
+	double local_assembly_time() const;
 	void truncate_phase_field();
 	unsigned int active_set_size() const;
 	void set_coupling(const DoFHandler<dim>            &,
 		           			const FESystem<dim>   					 &,
 							 			const FEValuesExtractors::Scalar &);
+	// coupled assembly takes p and grad p from the cache while it is valid;
+	// the cache must hold the pressure passed to assemble_coupled_system
+	void set_field_cache(const Assembly::FieldCache<dim> &);
 	double linear_residual(TrilinosWrappers::MPI::BlockVector &);
+	// relevant_solution = solution, skipped if it holds the values already
+	void update_relevant_solution();
+	// switch between the float ILU and the AMG block preconditioners
+	// (takes effect at the next Jacobian assembly, clears a past stall)
+	void set_preconditioner_precision(const bool single);
   void get_stresses(std::vector< Vector<double> > &dst);
 
 private:
 	// this function also computes finest mesh size
 	void assemble_mass_matrix_diagonal();
+	// per-thread data for the cell loop of assemble_coupled_system
+	struct AssemblyScratchData
+	{
+		AssemblyScratchData(const unsigned int        dofs_per_cell,
+		                    const Quadrature<dim>    &quadrature,
+		                    const FiniteElement<dim> *pressure_fe,
+		                    const bool                with_shape_tensors);
+		AssemblyScratchData(const AssemblyScratchData &scratch);
+
+		const Quadrature<dim>            quadrature;
+		const FiniteElement<dim>        *pressure_fe;
+		std::unique_ptr< FEValues<dim> > pressure_fe_values;
+		Vector<double>                   local_solution, local_old_solution,
+		                                 local_old_old_solution;
+		std::vector< Tensor<1,dim> >     xi_u;
+		std::vector<double>              xi_phi;
+		std::vector< Tensor<2,dim> >     grad_xi_u;
+		std::vector< Tensor<1,dim> >     grad_xi_phi;
+		std::vector< Tensor<2,dim> >     eps_u;
+		std::vector< Tensor<2,dim> >     sigma_u_plus, sigma_u_minus;
+		std::vector<double>              p_values;
+		std::vector< Tensor<1,dim> >     grad_p_values;
+		ConstitutiveModel::EnergySpectralDecomposition<dim> stress_decomposition;
+		// strains and stresses of all q points for the batched spectral split
+		std::vector< Tensor<2,dim> >     cell_strains, cell_stress_plus,
+		                                 cell_stress_minus;
+		ConstitutiveModel::BatchedSpectralSplit<dim> spectral_split;
+	};
+
+	// choose the kernel instance for decompose_stress and include_pressure
+	template <bool assemble_matrix>
+	void dispatch_assemble_cells(const TrilinosWrappers::MPI::BlockVector &,
+	                             const std::pair<double,double> &,
+	                             const bool);
+	// cell loop of assemble_coupled_system (matrix+rhs or residual only)
+	template <bool assemble_matrix, typename SplitPolicy, bool include_pressure>
+	void assemble_cells(const TrilinosWrappers::MPI::BlockVector &,
+	                    const std::pair<double,double> &);
+	template <bool assemble_matrix, typename SplitPolicy, bool include_pressure>
+	void local_assemble_cell(const typename DoFHandler<dim>::active_cell_iterator &,
+	                         AssemblyScratchData &,
+	                         Assembly::CopyData &,
+	                         const TrilinosWrappers::MPI::BlockVector &,
+	                         const std::pair<double,double> &);
+	template <bool assemble_matrix>
+	void copy_local_to_global(const Assembly::CopyData &);
 	void setup_preconditioners();
+	// GMRES with the block diagonal preconditioner, false if it stops at
+	// the iteration limit of the control
+	template <class PreconditionerA, class PreconditionerS>
+	bool solve_gmres(const PreconditionerA &, const PreconditionerS &,
+	                 SolverControl &);
 	void impose_boundary_displacement(const std::vector<int>       &,
 	                                  const std::vector<int>       &,
 	                                  const std::vector<double>    &);
@@ -142,13 +219,44 @@ private:
 	TrilinosWrappers::BlockSparseMatrix preconditioner_matrix;
 
 	TrilinosWrappers::PreconditionAMG prec_displacement, prec_phase_field;
+	// single precision alternative; the AMG ones are only built after a
+	// fallback to double precision
+	LinearSolvers::PreconditionFloatILU float_prec_displacement,
+	                                    float_prec_phase_field;
+	bool use_single_precision;
+	// set by the first stall of the single precision solve: double from
+	// then on, also on later meshes
+	bool single_precision_stalled;
+	// false if the last GMRES run stopped at the iteration limit
+	bool linear_solve_converged;
+	// state of the locally relevant unconstrained phase-field dofs in the
+	// active set (in the order of DofUtilities::for_each_unconstrained_dof)
+	std::vector<unsigned char> active_set_flags;
+	unsigned int n_active_set_changes;
+	double assembly_wall_time;
+	// false if all_constraints lacks the active set constraints
+	bool active_set_constraints_valid;
+	// decides when the AMG hierarchies are rebuilt rather than refreshed
+	LinearSolvers::PreconditionerReusePolicy amg_policy;
+
+	public:
+	// GMRES tolerance of the Newton steps (reset at the start of every
+	// Newton loop)
+	LinearSolvers::ForcingTerm forcing_term;
+
+	private:
 
 	// Pointers to couple with pore pressure
 	// these are set by method set_coupling
 	const DoFHandler<dim> *p_pressure_dof_handler;
 	const FESystem<dim> *p_pressure_fe;
 	const FEValuesExtractors::Scalar *p_pressure_extractor;
+	const Assembly::FieldCache<dim>  *p_field_cache;
 
+	// per-cell geometry, material, and stress data for assembly
+	AssemblyCache<dim> assembly_cache;
+	// owned -> ghosted copies of the solution
+	DofUtilities::GhostUpdater ghost_updater;
 
 	public:
 	FESystem<dim> fe;
@@ -167,6 +275,8 @@ private:
   // Simple splitting: 1
   // Spectral decomposition: 2
 	int  decompose_stress;
+	// closest mesh vertices/cells to wells, monitor and displacement points
+	Mesher::PointLocator<dim> point_locator;
 
 };
 
@@ -188,8 +298,15 @@ PhaseFieldSolver<dim>::PhaseFieldSolver
     fe(FE_Q<dim>(1), dim, // displacement components
        FE_Q<dim>(1), 1), // phase-field
     use_old_time_step_phi(false),
-		decompose_stress(2)
-{}     // EOM
+		decompose_stress(2),
+    point_locator(triangulation_)
+{
+  assembly_wall_time = 0;
+  p_field_cache = NULL;
+  use_single_precision = false;
+  single_precision_stalled = false;
+  linear_solve_converged = true;
+}     // EOM
 
 
 template <int dim>
@@ -209,7 +326,12 @@ void PhaseFieldSolver<dim>::setup_dofs()
   std::vector<unsigned int> blocks(dim+1, 0);
   blocks[dim] = 1;
 
+  // mesh has changed: cell data is rebuilt in the next assembly
+  assembly_cache.clear();
+  data.update_cell_properties(triangulation);
+
   // distribute and renumber dofs
+  computing_timer.enter_section("Setup phase-field dofs");
   dof_handler.distribute_dofs(fe);
   DoFRenumbering::component_wise(dof_handler, blocks);
 
@@ -256,7 +378,9 @@ void PhaseFieldSolver<dim>::setup_dofs()
     relevant_partitioning[0] = locally_relevant_dofs.get_view(0, n_u);
     relevant_partitioning[1] = locally_relevant_dofs.get_view(n_u, n_u+n_phi);
   }
+  computing_timer.exit_section("Setup phase-field dofs");
 
+  computing_timer.enter_section("Setup phase-field constraints");
   { // constraints
     hanging_nodes_constraints.clear();
     hanging_nodes_constraints.reinit(locally_relevant_dofs);
@@ -264,18 +388,21 @@ void PhaseFieldSolver<dim>::setup_dofs()
                                             hanging_nodes_constraints);
     hanging_nodes_constraints.close();
 
-    physical_constraints.clear();
-    physical_constraints.reinit(locally_relevant_dofs);
-    physical_constraints.merge(hanging_nodes_constraints);
-    physical_constraints.close();
-
-    all_constraints.clear();
-    all_constraints.reinit(locally_relevant_dofs);
-    all_constraints.merge(physical_constraints);
-    all_constraints.close();
+    // no other physical constraints yet: copies of the closed hanging
+    // node constraints instead of merging and closing them again
+    physical_constraints.copy_from(hanging_nodes_constraints);
+    all_constraints.copy_from(physical_constraints);
   }
+  computing_timer.exit_section("Setup phase-field constraints");
 
+  computing_timer.enter_section("Setup phase-field sparsity");
   { // Setup system matrices and diagonal mass matrix
+    prec_displacement.clear();
+    prec_phase_field.clear();
+    float_prec_displacement.clear();
+    float_prec_phase_field.clear();
+    use_single_precision = (data.preconditioner_precision == "single" &&
+                            !single_precision_stalled);
     system_matrix.clear();
 
     /*
@@ -308,11 +435,15 @@ void PhaseFieldSolver<dim>::setup_dofs()
     //                                 Utilities::MPI::this_mpi_process(mpi_communicator));
     sp.compress();
     system_matrix.reinit(sp);
-
-    mass_matrix_diagonal_relevant.reinit(relevant_partitioning);
-    assemble_mass_matrix_diagonal();
   }
+  computing_timer.exit_section("Setup phase-field sparsity");
+
+  computing_timer.enter_section("Setup phase-field mass matrix");
+  mass_matrix_diagonal_relevant.reinit(relevant_partitioning);
+  assemble_mass_matrix_diagonal();
+  computing_timer.exit_section("Setup phase-field mass matrix");
 
+  computing_timer.enter_section("Setup phase-field vectors");
   { // Setup vectors
     solution.reinit(owned_partitioning, mpi_communicator);
     relevant_solution.reinit(relevant_partitioning, mpi_communicator);
@@ -328,9 +459,22 @@ void PhaseFieldSolver<dim>::setup_dofs()
 
     active_set.clear();
     active_set.set_size(dof_handler.n_dofs());
+    active_set_flags.assign(relevant_partitioning[1].n_elements(), 0);
+    n_active_set_changes = 0;
+    active_set_constraints_valid = false;
   }
-
-  computing_timer.exit_section();
+  computing_timer.exit_section("Setup phase-field vectors");
+
+  // new sparsity pattern: the AMG hierarchies must be rebuilt
+  amg_policy.set_thresholds(data.amg_rebuild_active_set_fraction,
+                            data.amg_rebuild_iteration_factor);
+  amg_policy.force_rebuild();
+  forcing_term.set_parameters(data.linear_solver_forcing,
+                              data.linear_solver_tolerance,
+                              data.max_forcing_term,
+                              data.newton_tolerance);
+
+  computing_timer.exit_section("Setup phase-field system");
 }    // EOM
 
 
@@ -374,6 +518,14 @@ set_coupling(const DoFHandler<dim>            &pressure_dof_handler,
 }  // eom
 
 
+template <int dim>
+void PhaseFieldSolver<dim>::
+set_field_cache(const Assembly::FieldCache<dim> &field_cache)
+{
+	p_field_cache = &field_cache;
+}  // eom
+
+
 template <int dim>
 void PhaseFieldSolver<dim>::
 assemble_coupled_system(const TrilinosWrappers::MPI::BlockVector &linerarization_point,
@@ -393,277 +545,488 @@ assemble_coupled_system(const TrilinosWrappers::MPI::BlockVector &linerarization
   else
     computing_timer.enter_section("Assemble nonlinear residual");
 
-  const QGauss<dim> quadrature_formula(fe.degree + 2);
-  const QGauss<dim-1> face_quadrature_formula(fe.degree + 1);
-  FEValues<dim> fe_values(fe, quadrature_formula,
-                          update_values | update_gradients |
-                          update_quadrature_points |
-                          update_JxW_values);
-  FEFaceValues<dim> fe_face_values(fe, face_quadrature_formula,
-                                   update_values | update_gradients |
-                                   update_normal_vectors |
-                                   update_JxW_values);
-
-	// dummy unless include_pressure=true
-	FEValues<dim> *p_pressure_fe_values = NULL;
-  FEFaceValues<dim> *p_pressure_fe_face_values = NULL;
-	if (include_pressure)
+  // geometry and material data only change with the mesh
+  if (!assembly_cache.is_initialized())
+    assembly_cache.reinit(dof_handler, QGauss<dim>(fe.degree + 2));
+  if (assembly_cache.get_stress_split() != decompose_stress)
+    assembly_cache.invalidate_stress_state(decompose_stress);
+
+  ghost_updater.update(relevant_solution, linerarization_point);
+
+  // process-local timer of the cell loop (without the communication)
+  Timer cell_loop_timer;
+  if (assemble_matrix)
   {
-    p_pressure_fe_values = new FEValues<dim>(*p_pressure_fe, quadrature_formula,
-	                     											 update_values | update_gradients |
-																						 update_quadrature_points);
-    p_pressure_fe_face_values = new FEFaceValues<dim>(*p_pressure_fe,
-                                                      face_quadrature_formula,
-                                                      update_values);
+    system_matrix = 0;
+    rhs_vector = 0;
+    cell_loop_timer.restart();
+    dispatch_assemble_cells<true>(pressure_relevant_solution, time_steps,
+                                  include_pressure);
+    cell_loop_timer.stop();
+    system_matrix.compress(VectorOperation::add);
+    rhs_vector.compress(VectorOperation::add);
   }
+  else
+  {
+    residual = 0;
+    cell_loop_timer.restart();
+    dispatch_assemble_cells<false>(pressure_relevant_solution, time_steps,
+                                   include_pressure);
+    cell_loop_timer.stop();
+    residual.compress(VectorOperation::add);
+  }
+  assembly_wall_time += cell_loop_timer.wall_time();
 
-  auto & pressure_fe_values	= (*p_pressure_fe_values);
-  // auto & pressure_fe_face_values	= (*p_pressure_fe_face_values);
+  computing_timer.exit_section();
+
+  if (assemble_matrix)
+    setup_preconditioners();
+}  // eom
+
+
+template <int dim>
+PhaseFieldSolver<dim>::AssemblyScratchData::
+AssemblyScratchData(const unsigned int        dofs_per_cell,
+                    const Quadrature<dim>    &quadrature_,
+                    const FiniteElement<dim> *pressure_fe_,
+                    const bool                with_shape_tensors)
+:
+quadrature(quadrature_),
+pressure_fe(pressure_fe_),
+local_solution(dofs_per_cell),
+local_old_solution(dofs_per_cell),
+local_old_old_solution(dofs_per_cell),
+xi_u((with_shape_tensors) ? dofs_per_cell : 0),
+xi_phi((with_shape_tensors) ? dofs_per_cell : 0),
+grad_xi_u((with_shape_tensors) ? dofs_per_cell : 0),
+grad_xi_phi((with_shape_tensors) ? dofs_per_cell : 0),
+eps_u((with_shape_tensors) ? dofs_per_cell : 0),
+sigma_u_plus((with_shape_tensors) ? dofs_per_cell : 0),
+sigma_u_minus((with_shape_tensors) ? dofs_per_cell : 0),
+p_values(quadrature_.size()),
+grad_p_values(quadrature_.size()),
+cell_strains(quadrature_.size()),
+cell_stress_plus(quadrature_.size()),
+cell_stress_minus(quadrature_.size())
+{
+	// dummy unless pressure is coupled
+  if (pressure_fe != NULL)
+    pressure_fe_values.reset(new FEValues<dim>(*pressure_fe, quadrature,
+                                               update_values | update_gradients));
+}  // eom
 
-  const unsigned int dofs_per_cell   = fe.dofs_per_cell;
-  const unsigned int n_q_points      = quadrature_formula.size();
-  const unsigned int n_face_q_points = face_quadrature_formula.size();
 
-  FullMatrix<double>   local_matrix(dofs_per_cell, dofs_per_cell);
-  Vector<double>       local_rhs(dofs_per_cell);
+template <int dim>
+PhaseFieldSolver<dim>::AssemblyScratchData::
+AssemblyScratchData(const AssemblyScratchData &scratch)
+:
+quadrature(scratch.quadrature),
+pressure_fe(scratch.pressure_fe),
+local_solution(scratch.local_solution),
+local_old_solution(scratch.local_old_solution),
+local_old_old_solution(scratch.local_old_old_solution),
+xi_u(scratch.xi_u),
+xi_phi(scratch.xi_phi),
+grad_xi_u(scratch.grad_xi_u),
+grad_xi_phi(scratch.grad_xi_phi),
+eps_u(scratch.eps_u),
+sigma_u_plus(scratch.sigma_u_plus),
+sigma_u_minus(scratch.sigma_u_minus),
+p_values(scratch.p_values),
+grad_p_values(scratch.grad_p_values),
+cell_strains(scratch.cell_strains),
+cell_stress_plus(scratch.cell_stress_plus),
+cell_stress_minus(scratch.cell_stress_minus)
+{
+  if (pressure_fe != NULL)
+    pressure_fe_values.reset(new FEValues<dim>(*pressure_fe, quadrature,
+                                               update_values | update_gradients));
+}  // eom
 
-  std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
 
-  const FEValuesExtractors::Vector displacement(0);
-  const FEValuesExtractors::Scalar phase_field(dim);
+template <int dim>
+template <bool assemble_matrix>
+void PhaseFieldSolver<dim>::
+dispatch_assemble_cells(const TrilinosWrappers::MPI::BlockVector &pressure_relevant_solution,
+                        const std::pair<double,double>           &time_steps,
+                        const bool                                include_pressure)
+{
+  /*
+    The split model and the pressure coupling are template parameters of
+    the cell kernel, so the branches on them are resolved once per
+    assembly instead of in every quadrature point.
+   */
+  typedef ConstitutiveModel::NoSplit<dim>       NoSplit;
+  typedef ConstitutiveModel::SimpleSplit<dim>   SimpleSplit;
+  typedef ConstitutiveModel::SpectralSplit<dim> SpectralSplit;
+
+  if (include_pressure)
+    switch (decompose_stress)
+    {
+      case NoSplit::id:
+        assemble_cells<assemble_matrix, NoSplit, true>
+          (pressure_relevant_solution, time_steps);
+        break;
+      case SimpleSplit::id:
+        assemble_cells<assemble_matrix, SimpleSplit, true>
+          (pressure_relevant_solution, time_steps);
+        break;
+      case SpectralSplit::id:
+        assemble_cells<assemble_matrix, SpectralSplit, true>
+          (pressure_relevant_solution, time_steps);
+        break;
+    }
+  else
+    switch (decompose_stress)
+    {
+      case NoSplit::id:
+        assemble_cells<assemble_matrix, NoSplit, false>
+          (pressure_relevant_solution, time_steps);
+        break;
+      case SimpleSplit::id:
+        assemble_cells<assemble_matrix, SimpleSplit, false>
+          (pressure_relevant_solution, time_steps);
+        break;
+      case SpectralSplit::id:
+        assemble_cells<assemble_matrix, SpectralSplit, false>
+          (pressure_relevant_solution, time_steps);
+        break;
+    }
+}  // eom
+
 
-  // FeValues containers
-  std::vector< Tensor<1,dim> >  xi_u(dofs_per_cell);
-  std::vector<double>  				  xi_phi(dofs_per_cell);
-  std::vector< Tensor<2,dim> >  grad_xi_u(dofs_per_cell);
-  std::vector< Tensor<1,dim> >  grad_xi_phi(dofs_per_cell);
-  std::vector< Tensor<2,dim> >  eps_u(dofs_per_cell);
+template <int dim>
+template <bool assemble_matrix, typename SplitPolicy, bool include_pressure>
+void PhaseFieldSolver<dim>::
+assemble_cells(const TrilinosWrappers::MPI::BlockVector &pressure_relevant_solution,
+               const std::pair<double,double> 					 &time_steps)
+{
+  /*
+    Cell loop of assemble_coupled_system. The linearization point is
+    in relevant_solution.
+    With assemble_matrix = false only the residual is assembled into
+    residual: the shape function tensors and stress derivatives that
+    the Jacobian needs are not computed at all, and the residual terms
+    are evaluated directly from the scalar base shape functions.
+    Cells are assembled in parallel threads; the copy into the global
+    objects is serialized by WorkStream.
+   */
+  const QGauss<dim> quadrature_formula(fe.degree + 2);
+  typedef typename DoFHandler<dim>::active_cell_iterator cell_iterator;
+
+  WorkStream::
+    run(Assembly::begin_owned(dof_handler),
+        Assembly::end_owned(dof_handler),
+        [this, &pressure_relevant_solution, &time_steps]
+        (const cell_iterator   &cell,
+         AssemblyScratchData   &scratch,
+         Assembly::CopyData    &copy_data)
+        {
+          this->template local_assemble_cell
+            <assemble_matrix, SplitPolicy, include_pressure>
+            (cell, scratch, copy_data, pressure_relevant_solution, time_steps);
+        },
+        [this](const Assembly::CopyData &copy_data)
+        {
+          this->template copy_local_to_global<assemble_matrix>(copy_data);
+        },
+        AssemblyScratchData(fe.dofs_per_cell, quadrature_formula,
+                            (include_pressure) ? p_pressure_fe : NULL,
+                            assemble_matrix),
+        Assembly::CopyData(fe.dofs_per_cell, assemble_matrix));
+}  // eom
+
+
+template <int dim>
+template <bool assemble_matrix, typename SplitPolicy, bool include_pressure>
+void PhaseFieldSolver<dim>::
+local_assemble_cell(const typename DoFHandler<dim>::active_cell_iterator &cell,
+                    AssemblyScratchData                      &scratch,
+                    Assembly::CopyData                       &copy_data,
+                    const TrilinosWrappers::MPI::BlockVector &pressure_relevant_solution,
+                    const std::pair<double,double> 					 &time_steps)
+{
+  const unsigned int dofs_per_cell   = fe.dofs_per_cell;
+  const unsigned int n_q_points      = scratch.quadrature.size();
+
+  FullMatrix<double>   &local_matrix = copy_data.local_matrix;
+  Vector<double>       &local_rhs = copy_data.local_rhs;
+  std::vector<types::global_dof_index> &local_dof_indices =
+    copy_data.local_dof_indices;
+  // local dof values of the linearization point and old solutions
+  Vector<double>       &local_solution = scratch.local_solution,
+                       &local_old_solution = scratch.local_old_solution,
+                       &local_old_old_solution = scratch.local_old_old_solution;
+
+  // FeValues containers (only used for the Jacobian)
+  std::vector< Tensor<1,dim> >  &xi_u = scratch.xi_u;
+  std::vector<double>  				  &xi_phi = scratch.xi_phi;
+  std::vector< Tensor<2,dim> >  &grad_xi_u = scratch.grad_xi_u;
+  std::vector< Tensor<1,dim> >  &grad_xi_phi = scratch.grad_xi_phi;
+  std::vector< Tensor<2,dim> >  &eps_u = scratch.eps_u;
   // Solution values containers
-  std::vector<double> 					phi_values(n_q_points),
-                                old_phi_face_values(n_face_q_points),
-						  									old_phi_values(n_q_points),
-						  									old_old_phi_values(n_q_points);
-  std::vector< Tensor<1, dim> > u_values(n_q_points),
-                                u_face_values(n_face_q_points);
-  std::vector< Tensor<2, dim> > grad_u_values(n_q_points);
-  std::vector< Tensor<1,dim> >  grad_phi_values(n_q_points);
-  Tensor<2, dim> 								strain_tensor_value;
+  double                        phi_value, old_phi_value, old_old_phi_value;
+  Tensor<1, dim>                u_value, grad_phi_value;
+  Tensor<2, dim> 								grad_u_value;
   // Pressure solution containers
-	std::vector<double> 				  p_values(n_q_points);
-	std::vector<double> 				  p_face_values(n_face_q_points);
-	std::vector< Tensor<1,dim> >  grad_p_values(n_q_points);
+	std::vector<double> 				  &p_values = scratch.p_values;
+	std::vector< Tensor<1,dim> >  &grad_p_values = scratch.grad_p_values;
 
   // Stress decomposition containers
-  ConstitutiveModel::EnergySpectralDecomposition<dim> stress_decomposition;
-  Tensor<2, dim> stress_tensor_plus, stress_tensor_minus;
+  ConstitutiveModel::EnergySpectralDecomposition<dim> &stress_decomposition =
+    scratch.stress_decomposition;
   std::vector< Tensor<2, dim> >
-  	sigma_u_plus(dofs_per_cell),
-  	sigma_u_minus(dofs_per_cell);
-  Tensor<2,dim> zero_matrix;
-  zero_matrix.clear();
-  // zero_matrix = 0;
+  	&sigma_u_plus = scratch.sigma_u_plus,
+  	&sigma_u_minus = scratch.sigma_u_minus;
 
   // Equation data
-  double kappa = data.regularization_parameter_kappa;
-  double e = data.regularization_parameter_epsilon;
-
-  relevant_solution = linerarization_point;
+  const double kappa = data.regularization_parameter_kappa;
+  const double e = data.regularization_parameter_epsilon;
+  const double time_step = time_steps.first;
+  const double old_time_step = time_steps.second;
 
+  local_rhs = 0;
   if (assemble_matrix)
+    local_matrix = 0;
+
+  const unsigned int cell_index = cell->active_cell_index();
+  cell->get_dof_indices(local_dof_indices);
+  for (unsigned int k=0; k<dofs_per_cell; ++k)
   {
-    system_matrix = 0;
-    rhs_vector = 0;
+    local_solution[k] = relevant_solution[local_dof_indices[k]];
+    local_old_solution[k] = old_solution[local_dof_indices[k]];
+    local_old_old_solution[k] = old_old_solution[local_dof_indices[k]];
   }
-  else
-    residual = 0;
 
-	// Pressure cell is either taken from solid dof_handler (no pressure terms)
-	// or from pressure dof handler (include_pressure = true)
-  typename DoFHandler<dim>::active_cell_iterator
-	  cell = dof_handler.begin_active(),
-	  pressure_cell = dof_handler.begin_active(),
-	  endc = dof_handler.end();
-
-	if (include_pressure)
-  	pressure_cell = p_pressure_dof_handler->begin_active();
+  // strains and split stresses from the last assembly can be reused
+  // if the displacement in this cell hasn't changed since
+  const bool reuse_stress_state =
+    assembly_cache.stress_state_valid(cell_index, local_solution);
 
-  for (; cell!=endc; ++cell, ++pressure_cell)
-    if (cell->is_locally_owned())
-    {
-      local_rhs = 0;
-      local_matrix = 0;
-
-      fe_values.reinit(cell);
-			if (include_pressure)
-				pressure_fe_values.reinit(pressure_cell);
-
-      fe_values[phase_field].get_function_values(relevant_solution,
-                                                 phi_values);
-      fe_values[phase_field].get_function_values(old_solution,
-                                                 old_phi_values);
-      fe_values[phase_field].get_function_values(old_old_solution,
-                                                 old_old_phi_values);
-      fe_values[phase_field].get_function_gradients(relevant_solution,
-                                                    grad_phi_values);
-			fe_values[displacement].get_function_gradients(relevant_solution,
-																										 grad_u_values);
-
-			if (include_pressure)
+			if (include_pressure &&
+			    p_field_cache != NULL && p_field_cache->pressure_valid() &&
+			    p_field_cache->n_quadrature_points() == n_q_points)
+				for (unsigned int q=0; q<n_q_points; ++q)
+				{
+					p_values[q] = p_field_cache->pressure(cell_index, q);
+					grad_p_values[q] = p_field_cache->pressure_gradient(cell_index, q);
+				}
+			else if (include_pressure)
 			{
+				// same cell in the pressure dof handler
+				FEValues<dim> &pressure_fe_values = *scratch.pressure_fe_values;
+				pressure_fe_values.reinit(Assembly::same_cell(cell, *p_pressure_dof_handler));
 				pressure_fe_values[*p_pressure_extractor].get_function_values
 					(pressure_relevant_solution, p_values);
 				pressure_fe_values[*p_pressure_extractor].get_function_gradients
 					(pressure_relevant_solution, grad_p_values);
-				fe_values[displacement].get_function_values(relevant_solution, u_values);
-				// pcout << "Pressure " << p_values[2] << std::endl;
-				// pcout << "Pressure grad " << grad_p_values[0] << std::endl;
 			}
 
-      double G_c = data.get_fracture_toughness->value(cell->center(), 0);
-			double E = data.get_young_modulus->value(cell->center(), 0);
-			double nu = data.get_poisson_ratio->value(cell->center(), 0);
-			double lame_constant = E*nu/((1.+nu)*(1.-2*nu));
-			double shear_modulus = 0.5*E/(1.+nu);
-			// pcout << " biot_coef " << data.biot_coef << std::endl;
-			// pcout << " E " << E << std::endl;
-			// pcout << " nu " << nu << std::endl;
+  const double G_c = data.cell_properties.fracture_toughness(cell_index);
+			const double lame_constant = data.cell_properties.lame_constant(cell_index);
+			const double shear_modulus = data.cell_properties.shear_modulus(cell_index);
 
-      for (unsigned int q=0; q<n_q_points; ++q)
+  /*
+    Spectral split: strains of all q points first, then one batched
+    evaluation of the split. The Jacobian needs the split data of the
+    current strains even if the stresses are reused.
+   */
+  const bool batched_split = SplitPolicy::batched;
+  if (batched_split && (assemble_matrix || !reuse_stress_state))
+  {
+    for (unsigned int q=0; q<n_q_points; ++q)
+    {
+      Tensor<2,dim> &strain_tensor_value = assembly_cache.strain(cell_index, q);
+      if (!reuse_stress_state)
       {
-				strain_tensor_value = 0.5*(grad_u_values[q] + transpose(grad_u_values[q]));
-
-				if (decompose_stress == 0)  // no splitting
-				{
-					stress_decomposition.get_stress(strain_tensor_value, lame_constant,
-							 													  shear_modulus, stress_tensor_plus);
-					stress_tensor_minus = 0;
-				}
-				else if (decompose_stress == 1) // Simple splitting
-	        stress_decomposition.get_stress_decomposition(strain_tensor_value,
-	                                                      lame_constant,
-	                                                      shear_modulus,
-	                                                      stress_tensor_plus,
-	                                                      stress_tensor_minus);
-				else if (decompose_stress == 2) // Spectral decomposition
+        grad_u_value = 0;
+        for (unsigned int k=0; k<dofs_per_cell; ++k)
         {
-          // Decomposition::decompose_stress(stress_tensor_plus, stress_tensor_minus,
-          //                                 strain_tensor_value, trace(strain_tensor_value),
-          //                                 zero_matrix , 0.0,
-          //                                 lame_constant, shear_modulus, false);
-          // pcout << "stress tensor plus_1 " << stress_tensor_plus << std::endl;
-          stress_decomposition.stress_spectral_decomposition(strain_tensor_value,
-                                                             lame_constant,
-                                                             shear_modulus,
-                                                             stress_tensor_plus,
-                                                             stress_tensor_minus);
-          // pcout << "stress tensor plus_2 " << stress_tensor_plus << std::endl;
+          const unsigned int comp_k = assembly_cache.system_component(k);
+          if (comp_k < dim)
+            grad_u_value[comp_k] +=
+              local_solution[k]*assembly_cache.shape_grad(cell_index, k, q);
         }
+        strain_tensor_value = 0.5*(grad_u_value + transpose(grad_u_value));
+      }
+      scratch.cell_strains[q] = strain_tensor_value;
+    }  // end q loop
 
-        // we get nans at the first time step
+    scratch.spectral_split.evaluate(scratch.cell_strains,
+                                    lame_constant, shear_modulus,
+                                    scratch.cell_stress_plus,
+                                    scratch.cell_stress_minus);
+
+    if (!reuse_stress_state)
+      for (unsigned int q=0; q<n_q_points; ++q)
+      {
+        Tensor<2,dim> &stress_tensor_plus = assembly_cache.stress_plus(cell_index, q);
+        Tensor<2,dim> &stress_tensor_minus = assembly_cache.stress_minus(cell_index, q);
+        stress_tensor_plus = scratch.cell_stress_plus[q];
+        stress_tensor_minus = scratch.cell_stress_minus[q];
         if (!numbers::is_finite(trace(stress_tensor_plus)))
-        // if (!numbers::is_finite(stress_tensor_plus.norm()))
-				{
-          if (decompose_stress > 0)
-            stress_decomposition.get_stress_decomposition(strain_tensor_value,
-                                                          lame_constant,
-                                                          shear_modulus,
-                                                          stress_tensor_plus,
-                                                          stress_tensor_minus);
-          else
-          {
-            stress_decomposition.get_stress(strain_tensor_value, lame_constant,
-                                            shear_modulus, stress_tensor_plus);
-            stress_tensor_minus = 0;
-          }
-				}
+          stress_decomposition.get_stress_decomposition(scratch.cell_strains[q],
+                                                        lame_constant,
+                                                        shear_modulus,
+                                                        stress_tensor_plus,
+                                                        stress_tensor_minus);
+      }
+  }  // end batched split
 
-        double old_phi_value = old_phi_values[q];
-        double old_old_phi_value = old_old_phi_values[q];
-        const double time_step = time_steps.first;
-        const double old_time_step = time_steps.second;
-        double dphi_dt_old = (old_phi_value - old_old_phi_value)/old_time_step;
+  for (unsigned int q=0; q<n_q_points; ++q)
+  {
+    // Solution values in the quadrature point
+    phi_value = 0;
+    old_phi_value = 0;
+    old_old_phi_value = 0;
+    grad_phi_value = 0;
+    grad_u_value = 0;
+    u_value = 0;
+    for (unsigned int k=0; k<dofs_per_cell; ++k)
+    {
+      const unsigned int comp_k = assembly_cache.system_component(k);
+      const double shape_value = assembly_cache.shape_value(k, q);
+      const Tensor<1,dim> &shape_grad =
+        assembly_cache.shape_grad(cell_index, k, q);
 
-        double phi_tilda = old_phi_value + dphi_dt_old*time_step;
-        phi_tilda = std::max(std::min(1.0, phi_tilda), 0.0);
-        if (use_old_time_step_phi)
-          phi_tilda = old_phi_value;
+      if (comp_k == dim)
+      {
+        phi_value += local_solution[k]*shape_value;
+        old_phi_value += local_old_solution[k]*shape_value;
+        old_old_phi_value += local_old_old_solution[k]*shape_value;
+        grad_phi_value += local_solution[k]*shape_grad;
+      }
+      else
+      {
+        grad_u_value[comp_k] += local_solution[k]*shape_grad;
+        u_value[comp_k] += local_solution[k]*shape_value;
+      }
+    }  // end k loop
 
-        double jxw = fe_values.JxW(q);
+    Tensor<2,dim> &strain_tensor_value = assembly_cache.strain(cell_index, q);
+    Tensor<2,dim> &stress_tensor_plus = assembly_cache.stress_plus(cell_index, q);
+    Tensor<2,dim> &stress_tensor_minus = assembly_cache.stress_minus(cell_index, q);
+    if (!reuse_stress_state && !batched_split)
+    {
+      strain_tensor_value = 0.5*(grad_u_value + transpose(grad_u_value));
+      SplitPolicy::stress(stress_decomposition, strain_tensor_value,
+                          lame_constant, shear_modulus,
+                          stress_tensor_plus, stress_tensor_minus);
+    }
 
-        for (unsigned int k=0; k<dofs_per_cell; ++k)
-        {
-          xi_phi[k]      = fe_values[phase_field].value(k,q);
-          grad_xi_phi[k] = fe_values[phase_field].gradient(k, q);
-					grad_xi_u[k]   = fe_values[displacement].gradient(k, q);
-					eps_u[k] 			 = 0.5*(grad_xi_u[k] + transpose(grad_xi_u[k]));
-					if (include_pressure)
-						xi_u[k] = fe_values[displacement].value(k,q);
-
-          const unsigned int comp_k = fe.system_to_component_index(k).first;
-          sigma_u_plus[k] = 0;
-          sigma_u_minus[k] = 0;
-          if (assemble_matrix && comp_k != dim)
-          {
-						if (decompose_stress == 0) // No decomposition
-						{
-							stress_decomposition.get_stress
-							(eps_u[k], lame_constant,
-							 shear_modulus, sigma_u_plus[k]);
-	            sigma_u_minus[k] = 0;
-						}
-
-						else if (decompose_stress == 1) // Simple splitting
-						{
-              stress_decomposition.get_stress_decomposition_derivatives
-                (strain_tensor_value, eps_u[k],
-                 lame_constant, shear_modulus,
-                 sigma_u_plus[k], sigma_u_minus[k]);
-						}
-						else if (decompose_stress == 2) // Spectral decomposition
-            {
-              // Decomposition::decompose_stress(sigma_u_plus[k], sigma_u_minus[k],
-              //                                 strain_tensor_value, trace(strain_tensor_value),
-              //                                 eps_u[k], trace(eps_u[k]),
-              //                                 lame_constant, shear_modulus, true);
-              // if (!numbers::is_nan(sigma_u_plus[k][0][0]))
-              // {
-              //   pcout << "\nstress tensor+ " << stress_tensor_plus << std::endl;
-              //   pcout << "sigma u plus_1 " << sigma_u_plus[k] << std::endl;
-              //   pcout << "sigma u minus_1 " << sigma_u_minus[k] << std::endl;
-              // }
-	            stress_decomposition.stress_spectral_decomposition_derivatives
-	              (strain_tensor_value, eps_u[k],
-	               lame_constant, shear_modulus,
-	               sigma_u_plus[k], sigma_u_minus[k]);
-              // if (!numbers::is_nan(sigma_u_plus[k][0][0]))
-              // {
-              //   pcout << "sigma u plus_2 " << sigma_u_plus[k] << std::endl;
-              //   pcout << "sigma u minus_2 " << sigma_u_minus[k] << std::endl;
-              // }
-            }
+    double dphi_dt_old = (old_phi_value - old_old_phi_value)/old_time_step;
 
-            // we get nans at the first time step
-            // simple splitting
-            if (!numbers::is_finite(trace(sigma_u_plus[k])))
-            // if (!numbers::is_finite(sigma_u_plus[k].norm()))
-						{
-							stress_decomposition.get_stress(eps_u[k], lame_constant,
-							 																shear_modulus, sigma_u_plus[k]);
-							sigma_u_minus[k] = 0;
-						}
-          }  // end if assemble matrix
-        } // end k loop
-
-        // Assemble local rhs +
-        for (unsigned int i=0; i<dofs_per_cell; ++i)
+    double phi_tilda = old_phi_value + dphi_dt_old*time_step;
+    phi_tilda = std::max(std::min(1.0, phi_tilda), 0.0);
+    if (use_old_time_step_phi)
+      phi_tilda = old_phi_value;
+
+    const double jxw = assembly_cache.JxW(cell_index, q);
+    const double degradation = (1.-kappa)*phi_tilda*phi_tilda + kappa;
+    const double elastic_energy =
+      scalar_product(stress_tensor_plus, strain_tensor_value);
+    const double div_u = trace(strain_tensor_value);
+
+    if (!assemble_matrix)
+    {
+      /*
+        Residual only: test functions are e_c*N for displacement
+        and N for phase-field, so the products with the stresses
+        reduce to matrix-vector products with the shape gradients
+       */
+      double phi_coefficient =
+        (1.0-kappa)*phi_value*elastic_energy - G_c/e*(1.0-phi_value);
+      if (include_pressure)
+        phi_coefficient +=
+          -
+          2.0*(data.biot_coef-1.0)*phi_value*p_values[q]*div_u
+          +
+          2.0*phi_value*scalar_product(grad_p_values[q], u_value);
+
+      for (unsigned int i=0; i<dofs_per_cell; ++i)
+      {
+        const unsigned int comp_i = assembly_cache.system_component(i);
+        const double shape_value = assembly_cache.shape_value(i, q);
+        const Tensor<1,dim> &shape_grad =
+          assembly_cache.shape_grad(cell_index, i, q);
+
+        double rhs_i;
+        if (comp_i == dim)
+          rhs_i =
+            phi_coefficient*shape_value
+            +
+            G_c*e*scalar_product(grad_phi_value, shape_grad);
+        else
         {
-          double rhs_u =
-            ((1.-kappa)*phi_tilda*phi_tilda + kappa) *
-            // scalar_product(stress_tensor_plus, eps_u[i])
-            scalar_product(stress_tensor_plus, grad_xi_u[i])
+          rhs_i =
+            degradation*scalar_product(stress_tensor_plus[comp_i], shape_grad)
             +
-						// scalar_product(stress_tensor_minus, eps_u[i])
-            scalar_product(stress_tensor_minus, grad_xi_u[i])
+            scalar_product(stress_tensor_minus[comp_i], shape_grad);
+          if (include_pressure)
+            rhs_i +=
+              -
+              (data.biot_coef-1.0)*phi_tilda*phi_tilda*
+              p_values[q]*shape_grad[comp_i]
+              +
+              phi_tilda*phi_tilda*grad_p_values[q][comp_i]*shape_value;
+        }
+
+        local_rhs[i] -= rhs_i*jxw;
+      }  // end i loop
+
+      continue;
+    }  // end residual kernel
+
+    // Shape function tensors for the Jacobian
+    for (unsigned int k=0; k<dofs_per_cell; ++k)
+    {
+      const unsigned int comp_k = assembly_cache.system_component(k);
+      const double shape_value = assembly_cache.shape_value(k, q);
+      const Tensor<1,dim> &shape_grad =
+        assembly_cache.shape_grad(cell_index, k, q);
+
+      xi_phi[k] = 0;
+      grad_xi_phi[k] = 0;
+      grad_xi_u[k] = 0;
+      xi_u[k] = 0;
+      sigma_u_plus[k] = 0;
+      sigma_u_minus[k] = 0;
+
+      if (comp_k == dim)
+      {
+        xi_phi[k] = shape_value;
+        grad_xi_phi[k] = shape_grad;
+        eps_u[k] = 0;
+        continue;
+      }
+
+      grad_xi_u[k][comp_k] = shape_grad;
+      xi_u[k][comp_k] = shape_value;
+      eps_u[k] = 0.5*(grad_xi_u[k] + transpose(grad_xi_u[k]));
+
+      SplitPolicy::derivative(stress_decomposition, scratch.spectral_split,
+                              q, strain_tensor_value, eps_u[k],
+                              lame_constant, shear_modulus,
+                              sigma_u_plus[k], sigma_u_minus[k]);
+
+      // we get nans at the first time step
+      // simple splitting
+      if (!numbers::is_finite(trace(sigma_u_plus[k])))
+					{
+						stress_decomposition.get_stress(eps_u[k], lame_constant,
+						 																shear_modulus, sigma_u_plus[k]);
+						sigma_u_minus[k] = 0;
+					}
+    } // end k loop
+
+    // Assemble local rhs +
+    for (unsigned int i=0; i<dofs_per_cell; ++i)
+    {
+      double rhs_u =
+        degradation *
+        scalar_product(stress_tensor_plus, grad_xi_u[i])
+        +
+        scalar_product(stress_tensor_minus, grad_xi_u[i])
 						;
 				  if (include_pressure)
 						rhs_u +=
@@ -674,121 +1037,100 @@ assemble_coupled_system(const TrilinosWrappers::MPI::BlockVector &linerarization
 							phi_tilda*phi_tilda*scalar_product(grad_p_values[q], xi_u[i])
 							;
 
-          double rhs_phi =
-            (1.0-kappa)*phi_values[q] *
-            scalar_product(stress_tensor_plus, strain_tensor_value)*xi_phi[i]
-            -
-						G_c/e*(1.0-phi_values[q])*xi_phi[i]
-            +
-						G_c*e*scalar_product(grad_phi_values[q], grad_xi_phi[i])
+      double rhs_phi =
+        (1.0-kappa)*phi_value*elastic_energy*xi_phi[i]
+        -
+						G_c/e*(1.0-phi_value)*xi_phi[i]
+        +
+						G_c*e*scalar_product(grad_phi_value, grad_xi_phi[i])
 						;
 				  if (include_pressure)
 					{
 						rhs_phi +=
 							-
-							2.0*(data.biot_coef-1.0)*phi_values[q]*p_values[q] *
-							trace(grad_u_values[q])*xi_phi[i]
+							2.0*(data.biot_coef-1.0)*phi_value*p_values[q] *
+							div_u*xi_phi[i]
 							+
-							2.0*phi_values[q]*
-							scalar_product(grad_p_values[q], u_values[q])*xi_phi[i]
+							2.0*phi_value*
+							scalar_product(grad_p_values[q], u_value)*xi_phi[i]
 							;
 					}
 
-          local_rhs[i] -= (rhs_u + rhs_phi)*jxw;
+      local_rhs[i] -= (rhs_u + rhs_phi)*jxw;
 
-        } // end i loop
+    } // end i loop
 
-        // Assemble local matrix
-        if (assemble_matrix)
-          for (unsigned int i=0; i<dofs_per_cell; ++i)
-            for (unsigned int j=0; j<dofs_per_cell; ++j)
-            {
-              double m_u_u =
-                ((1.-kappa)*phi_tilda*phi_tilda + kappa) *
-                // scalar_product(sigma_u_plus[j], eps_u[i])
-                scalar_product(sigma_u_plus[j], grad_xi_u[i])
-                +
-								// scalar_product(sigma_u_minus[j], eps_u[i])
-                scalar_product(sigma_u_minus[j], grad_xi_u[i])
-								;
-
-              double m_phi_u =
-                (1.-kappa)*phi_values[q]*
-                  (scalar_product(sigma_u_plus[j], strain_tensor_value) +
-                   scalar_product(stress_tensor_plus, eps_u[j]))*
-                xi_phi[i]
-								;
-							if (include_pressure)
-								{
-									m_phi_u +=
-										-
-										2.0*(data.biot_coef-1.0)*p_values[q]*phi_values[q]*
-										trace(grad_xi_u[j])*xi_phi[i]
-										+
-										2.0*phi_values[q]*scalar_product(grad_p_values[q], xi_u[j])*
-										xi_phi[i]
-										;
-								}
-
-              // double m_u_phi = 0;
-
-              double m_phi_phi =
-                (1.-kappa) *
-                scalar_product(stress_tensor_plus, strain_tensor_value)*
-								xi_phi[j]*xi_phi[i]
-                +
-								G_c/e*(xi_phi[j]*xi_phi[i])
-                +
-								G_c*e*scalar_product(grad_xi_phi[j], grad_xi_phi[i]);
+    // Assemble local matrix
+    for (unsigned int i=0; i<dofs_per_cell; ++i)
+      for (unsigned int j=0; j<dofs_per_cell; ++j)
+      {
+        double m_u_u =
+          degradation *
+          scalar_product(sigma_u_plus[j], grad_xi_u[i])
+          +
+          scalar_product(sigma_u_minus[j], grad_xi_u[i])
+							;
 
-							if (include_pressure)
-								m_phi_phi +=
+        double m_phi_u =
+          (1.-kappa)*phi_value*
+            (scalar_product(sigma_u_plus[j], strain_tensor_value) +
+             scalar_product(stress_tensor_plus, eps_u[j]))*
+          xi_phi[i]
+							;
+						if (include_pressure)
+							{
+								m_phi_u +=
 									-
-									2.0*(data.biot_coef-1.0)*p_values[q]*
-									trace(grad_u_values[q])*xi_phi[j]*xi_phi[i]
+									2.0*(data.biot_coef-1.0)*p_values[q]*phi_value*
+									trace(grad_xi_u[j])*xi_phi[i]
 									+
-									2.0*scalar_product(grad_p_values[q], u_values[q])*
-									xi_phi[j]*xi_phi[i]
+									2.0*phi_value*scalar_product(grad_p_values[q], xi_u[j])*
+									xi_phi[i]
 									;
+							}
+
+        double m_phi_phi =
+          (1.-kappa)*elastic_energy*xi_phi[j]*xi_phi[i]
+          +
+							G_c/e*(xi_phi[j]*xi_phi[i])
+          +
+							G_c*e*scalar_product(grad_xi_phi[j], grad_xi_phi[i]);
+
+						if (include_pressure)
+							m_phi_phi +=
+								-
+								2.0*(data.biot_coef-1.0)*p_values[q]*
+								div_u*xi_phi[j]*xi_phi[i]
+								+
+								2.0*scalar_product(grad_p_values[q], u_value)*
+								xi_phi[j]*xi_phi[i]
+								;
 
-              local_matrix(i, j) += (m_u_u + m_phi_u + m_phi_phi) * jxw;
+        local_matrix(i, j) += (m_u_u + m_phi_u + m_phi_phi) * jxw;
 
-            } // end i&j loop
-      } // end q loop
+      } // end i&j loop
+  } // end q loop
 
-      cell->get_dof_indices(local_dof_indices);
-
-      if (assemble_matrix)
-        all_constraints.distribute_local_to_global(local_matrix,
-                                                   local_rhs,
-                                                   local_dof_indices,
-                                                   system_matrix,
-                                                   rhs_vector);
-      else
-        hanging_nodes_constraints.distribute_local_to_global(local_rhs,
-                                                             local_dof_indices,
-                                                             residual);
-        // all_constraints.distribute_local_to_global(local_rhs,
-        //                                            local_dof_indices,
-        //                                            residual);
+  if (!reuse_stress_state)
+    assembly_cache.store_stress_state_key(cell_index, local_solution);
+}  // eom
 
-    } // end of cell loop
 
+template <int dim>
+template <bool assemble_matrix>
+void PhaseFieldSolver<dim>::
+copy_local_to_global(const Assembly::CopyData &copy_data)
+{
   if (assemble_matrix)
-  {
-    system_matrix.compress(VectorOperation::add);
-    rhs_vector.compress(VectorOperation::add);
-  }
+    all_constraints.distribute_local_to_global(copy_data.local_matrix,
+                                               copy_data.local_rhs,
+                                               copy_data.local_dof_indices,
+                                               system_matrix,
+                                               rhs_vector);
   else
-    residual.compress(VectorOperation::add);
-
-  computing_timer.exit_section();
-
-  if (assemble_matrix)
-    setup_preconditioners();
-
-  delete p_pressure_fe_values;
-  delete p_pressure_fe_face_values;
+    hanging_nodes_constraints.distribute_local_to_global(copy_data.local_rhs,
+                                                         copy_data.local_dof_indices,
+                                                         residual);
 }  // eom
 
 
@@ -825,44 +1167,48 @@ assemble_mass_matrix_diagonal()
   // const QTrapez<dim> quadrature_formula;
   QGaussLobatto<dim> quadrature_formula(fe.degree + 1);
 
-  FEValues<dim> fe_values(fe, quadrature_formula,
-                          update_quadrature_points |
-                          update_values |
-                          update_JxW_values);
-
   const unsigned int dofs_per_cell = fe.dofs_per_cell;
   const unsigned int n_q_points = quadrature_formula.size();
 
-  Vector<double> cell_rhs(dofs_per_cell);
-  std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
-
-  typename DoFHandler<dim>::active_cell_iterator
-  cell = dof_handler.begin_active(),
-  endc = dof_handler.end();
-
   TrilinosWrappers::MPI::BlockVector mass_matrix_diagonal;
   mass_matrix_diagonal.reinit(owned_partitioning, mpi_communicator);
   mass_matrix_diagonal = 0;
 
-  for (; cell!=endc; ++cell)
-    if (cell->is_locally_owned())
-    {
-      fe_values.reinit(cell);
-      cell_rhs = 0;
-      for (unsigned int q_point=0; q_point<n_q_points; ++q_point)
-        for (unsigned int i=0; i<dofs_per_cell; ++i)
-        {
-          const unsigned int comp_i = fe.system_to_component_index(i).first;
-          if (comp_i == dim)
-            cell_rhs(i) += (fe_values.shape_value(i, q_point) *
-                            fe_values.shape_value(i, q_point) *
-                            fe_values.JxW(q_point));
-        }
+  typedef typename DoFHandler<dim>::active_cell_iterator cell_iterator;
 
-      cell->get_dof_indices(local_dof_indices);
-      for (unsigned int i = 0; i < dofs_per_cell; i++)
-        mass_matrix_diagonal(local_dof_indices[i]) += cell_rhs(i);
-    } // end cell loop
+  WorkStream::
+    run(Assembly::begin_owned(dof_handler),
+        Assembly::end_owned(dof_handler),
+        [this, dofs_per_cell, n_q_points]
+        (const cell_iterator           &cell,
+         Assembly::FEValuesScratch<dim> &scratch,
+         Assembly::CopyData             &copy_data)
+        {
+          FEValues<dim> &fe_values = scratch.fe_values;
+          Vector<double> &cell_rhs = copy_data.local_rhs;
+          fe_values.reinit(cell);
+          cell_rhs = 0;
+          for (unsigned int q_point=0; q_point<n_q_points; ++q_point)
+            for (unsigned int i=0; i<dofs_per_cell; ++i)
+            {
+              const unsigned int comp_i = fe.system_to_component_index(i).first;
+              if (comp_i == dim)
+                cell_rhs(i) += (fe_values.shape_value(i, q_point) *
+                                fe_values.shape_value(i, q_point) *
+                                fe_values.JxW(q_point));
+            }
+          cell->get_dof_indices(copy_data.local_dof_indices);
+        },
+        [&mass_matrix_diagonal, dofs_per_cell]
+        (const Assembly::CopyData &copy_data)
+        {
+          for (unsigned int i = 0; i < dofs_per_cell; i++)
+            mass_matrix_diagonal(copy_data.local_dof_indices[i]) +=
+              copy_data.local_rhs(i);
+        },
+        Assembly::FEValuesScratch<dim>(fe, quadrature_formula,
+                                       update_values | update_JxW_values),
+        Assembly::CopyData(dofs_per_cell, /* with_matrix = */ false));
 
   mass_matrix_diagonal.compress(VectorOperation::add);
 
@@ -877,66 +1223,88 @@ template <int dim>
 void PhaseFieldSolver<dim>::
 compute_active_set(TrilinosWrappers::MPI::BlockVector &linerarization_point)
 {
+  /*
+    The phase-field dofs form the second block of relevant_partitioning.
+    active_set_flags holds the state of each locally relevant phase-field
+    dof that is not a hanging node, in the order they are visited,
+    so we only need local storage and can count the dofs that enter or
+    leave the set.
+    The active set part of all_constraints is only rebuilt if the local
+    set has changed (or all_constraints was reset from the physical
+    constraints in between).
+   */
   computing_timer.enter_section("Computing active set");
-  active_set.clear();
-  all_constraints.clear();
-  all_constraints.reinit(locally_relevant_dofs);
-
-  std::vector<bool> dof_touched(dof_handler.n_dofs(), false);
-  const unsigned int dofs_per_cell = fe.dofs_per_cell;
-  std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
 
   relevant_residual = residual;
-  relevant_solution = linerarization_point;
-
-  typename DoFHandler<dim>::active_cell_iterator
-    cell = dof_handler.begin_active(),
-    endc = dof_handler.end();
-
-  for (; cell != endc; ++cell)
-    if (!cell->is_artificial())
-    {
-      cell->get_dof_indices(local_dof_indices);
-      for (unsigned int i=0; i<dofs_per_cell; ++i)
-      {
-        const int component = fe.system_to_component_index(i).first;
-        const unsigned int index = local_dof_indices[i];
-
-        if (component == dim
-            && dof_touched[index] == false
-            && !hanging_nodes_constraints.is_constrained(index)
-            // && locally_owned_dofs.is_element(index)
-            )
-        {
-          dof_touched[index] = true;
-
-          double gap = relevant_solution[index] - old_solution[index];
-          double res = relevant_residual[index];
-          double mass_diag = mass_matrix_diagonal_relevant[index];
-
-          if (res/mass_diag + data.penalty_parameter*gap > 0 )
-          {
-            active_set.add_index(index);
-            all_constraints.add_line(index);
-            all_constraints.set_inhomogeneity(index, 0.0);
-            linerarization_point(index) = old_solution(index);
-          } // end if in active set
-        } // end if touched
-      } // end dof loop
-    } // end cell loop
+  // usually the point of the last residual assembly
+  ghost_updater.update(relevant_solution, linerarization_point);
+
+  unsigned int n_local_changes = 0, n_owned_changes = 0;
+  unsigned int k = 0;
+  DofUtilities::for_each_unconstrained_dof
+    (relevant_partitioning, 1, hanging_nodes_constraints,
+     [&](const unsigned int, const types::global_dof_index index)
+     {
+       double gap = relevant_solution[index] - old_solution[index];
+       double res = relevant_residual[index];
+       double mass_diag = mass_matrix_diagonal_relevant[index];
+       const bool in_active_set =
+         (res/mass_diag + data.penalty_parameter*gap > 0);
+
+       const bool owned = locally_owned_dofs.is_element(index);
+       if (in_active_set && owned)
+         linerarization_point(index) = old_solution(index);
+
+       if (in_active_set != (active_set_flags[k] != 0))
+       {
+         active_set_flags[k] = in_active_set;
+         n_local_changes++;
+         if (owned)
+           n_owned_changes++;
+       }
+       k++;
+     });
 
   linerarization_point.compress(VectorOperation::insert);
   // we might have changed values of the solution, so fix the
   // hanging nodes (we ignore in the active set):
   hanging_nodes_constraints.distribute(linerarization_point);
 
-  // since physical_constraints may fix the phase_field, because
-  // we now may constrain phase field in nodes, we merge with the
-  // priority of physical constraints
-  // all_constraints.merge(physical_constraints);
-  all_constraints.merge(physical_constraints,
-                        ConstraintMatrix::right_object_wins);
-  all_constraints.close();
+  if (n_local_changes > 0 || !active_set_constraints_valid)
+  {
+    active_set.clear();
+    all_constraints.clear();
+    all_constraints.reinit(locally_relevant_dofs);
+
+    k = 0;
+    DofUtilities::for_each_unconstrained_dof
+      (relevant_partitioning, 1, hanging_nodes_constraints,
+       [&](const unsigned int, const types::global_dof_index index)
+       {
+         if (active_set_flags[k++])
+         {
+           active_set.add_index(index);
+           all_constraints.add_line(index);
+           all_constraints.set_inhomogeneity(index, 0.0);
+         }
+       });
+
+    // since physical_constraints may fix the phase_field, because
+    // we now may constrain phase field in nodes, we merge with the
+    // priority of physical constraints
+    all_constraints.merge(physical_constraints,
+                          ConstraintMatrix::right_object_wins);
+    all_constraints.close();
+    active_set_constraints_valid = true;
+  }
+
+  n_active_set_changes = Utilities::MPI::sum(n_owned_changes, mpi_communicator);
+
+  // tell the preconditioner policy how much the active set has moved
+  const unsigned int n_phi = system_matrix.block(1, 1).m();
+  if (n_phi > 0)
+    amg_policy.register_active_set_change
+      (static_cast<double>(n_active_set_changes)/n_phi);
 
   computing_timer.exit_section();
 }    // EOM
@@ -964,6 +1332,7 @@ solve_newton_step(const std::pair<double,double> &time_steps)
     const int max_steps = 10;
     const double damping = 0.6;
 		unsigned int n_steps = 0;
+    bool decreased = false;
     for (int step = 0; step < max_steps; ++step)
     {
 			n_steps++;
@@ -974,7 +1343,10 @@ solve_newton_step(const std::pair<double,double> &time_steps)
       // double error = residual.linfty_norm();
 
       if (error < old_error)
+      {
+        decreased = true;
         break;
+      }
 
       if (step < max_steps)
       {
@@ -983,6 +1355,10 @@ solve_newton_step(const std::pair<double,double> &time_steps)
         solution_update *= damping;
       }
     } // end line search
+    // an unconverged direction that doesn't reduce the residual fails
+    // the step at once instead of repeating the same solve
+    if (!decreased && !linear_solve_converged)
+      throw SolverControl::NoConvergence(n_gmres, old_error);
 
 		std::pair<unsigned int, unsigned int> solver_results =
 			std::make_pair(n_gmres, n_steps);
@@ -1009,6 +1385,7 @@ solve_coupled_newton_step(const TrilinosWrappers::MPI::BlockVector &pressure_sol
   const int max_steps = 10;
   const double damping = 0.6;
 	unsigned int n_steps = 0;
+  bool decreased = false;
   for (int step = 0; step < max_steps; ++step)
   {
 		n_steps++;
@@ -1021,7 +1398,10 @@ solve_coupled_newton_step(const TrilinosWrappers::MPI::BlockVector &pressure_sol
     double error = residual.l2_norm();
 
     if (error < old_error)
+    {
+      decreased = true;
       break;
+    }
 
     if (step < max_steps)
     {
@@ -1030,6 +1410,10 @@ solve_coupled_newton_step(const TrilinosWrappers::MPI::BlockVector &pressure_sol
       solution_update *= damping;
     }
   } // end line search
+  // an unconverged direction that doesn't reduce the residual fails
+  // the step at once instead of repeating the same solve
+  if (!decreased && !linear_solve_converged)
+    throw SolverControl::NoConvergence(n_gmres, old_error);
 
 	std::pair<unsigned int, unsigned int>
 		solver_results = std::make_pair(n_gmres, n_steps);
@@ -1046,6 +1430,20 @@ active_set_changed(const IndexSet &old_active_set) const
 }    // eom
 
 
+template <int dim>
+unsigned int PhaseFieldSolver<dim>::active_set_changes() const
+{
+  return n_active_set_changes;
+}    // eom
+
+
+template <int dim>
+double PhaseFieldSolver<dim>::local_assembly_time() const
+{
+  return assembly_wall_time;
+}    // eom
+
+
 template <int dim>
 unsigned int PhaseFieldSolver<dim>::active_set_size() const
 {
@@ -1118,79 +1516,40 @@ impose_node_displacement(const std::vector < Point<dim> > &displacement_points,
                          const std::vector<double>        &displacement_point_values,
                          const std::vector<bool>          &constraint_point_phase_field)
 {
-  // loop throught vertices and find nodes that are closest to points
-  // store cells that are closest
-  const int n_displacement_points = displacement_points.size();
-
-  // set unrealistic cell number and distance to compare with later on
-  std::vector<double> min_distances(n_displacement_points);
-  std::vector<types::global_dof_index> closest_vertex_idx(n_displacement_points);
-  // if we want to constrain phase-field in a displacement node
-  std::vector<types::global_dof_index> constrained_phi_nodes(n_displacement_points);
-  for (int i=0; i<n_displacement_points; ++i)
-  {
-    min_distances[i] = std::numeric_limits<double>::max();
-    closest_vertex_idx[i] = std::numeric_limits<unsigned int>::max();
-  }
-
-  typename DoFHandler<dim>::active_cell_iterator
-    cell = dof_handler.begin_active(),
-    endc = dof_handler.end();
-
-  for (; cell != endc; ++cell)
-  {
-    if (cell->is_artificial())
-      continue;
-
-    for (unsigned int v=0; v<GeometryInfo<dim>::vertices_per_cell; ++v)
-    {
-      for (int p=0; p<n_displacement_points; ++p)
-      {
-        double distance = 0;
-        for (int c=0; c<dim; ++c)
-        {
-          double tmp = cell->vertex(v)[c] - displacement_points[p](c);
-          distance += tmp*tmp;
-        }  // end component loop
-
-        // check if point is the closest so far
-        if (distance < min_distances[p])
-        {
-          types::global_dof_index idx =
-              cell->vertex_dof_index(v, displacement_point_components[p]);
-          closest_vertex_idx[p] = idx;
-          min_distances[p] = distance;
-          if (constraint_point_phase_field[p])
-          {
-            idx = cell->vertex_dof_index(v, dim);  // dim = phase-field
-            constrained_phi_nodes[p] = idx;
-          }
-        }
-      }  // end target point loop
-    } // end vertex loop
-  }  // end cell loop
-
-  // now we need to make sure that only the process with the closest cells
-  // gets to impose the BC's
-  for (int p=0; p<n_displacement_points; ++p)
-  {
-    // std::cout << constraint_point_phase_field[p] << std::endl;
-    double global_min_distance = Utilities::MPI::min(min_distances[p],
-                                                     mpi_communicator);
-    if (global_min_distance == min_distances[p])
+  // find the vertices closest to the points; every process that has the
+  // global closest vertex (owned or ghost) adds the constraint lines, so
+  // the constraints agree between the processes and include the owner
+  const unsigned int n_displacement_points = displacement_points.size();
+  std::vector<typename Mesher::PointLocator<dim>::CellIterator> cells;
+  std::vector<unsigned int> vertices;
+  std::vector<double> min_distances;
+  point_locator.closest_vertices(displacement_points, cells, vertices,
+                                 min_distances);
+  const std::vector<bool> closest =
+    Mesher::closest_ties(min_distances, mpi_communicator);
+
+  for (unsigned int p=0; p<n_displacement_points; ++p)
+    if (closest[p])
       {
-        solution[closest_vertex_idx[p]] = displacement_point_values[p];
-        physical_constraints.add_line(closest_vertex_idx[p]);
+        const typename DoFHandler<dim>::active_cell_iterator
+          cell(&triangulation, cells[p]->level(), cells[p]->index(),
+               &dof_handler);
+        const types::global_dof_index idx =
+          cell->vertex_dof_index(vertices[p], displacement_point_components[p]);
+        solution[idx] = displacement_point_values[p];
+        physical_constraints.add_line(idx);
         if (constraint_point_phase_field[p])
         {
-          solution[constrained_phi_nodes[p]] = 1;
-          // std::cout << "constraining dof" << std::endl;
-          physical_constraints.add_line(constrained_phi_nodes[p]);
+          // dim = phase-field
+          const types::global_dof_index phi_idx =
+            cell->vertex_dof_index(vertices[p], dim);
+          solution[phi_idx] = 1;
+          physical_constraints.add_line(phi_idx);
         }
       }
-    solution.compress(VectorOperation::insert);
-    // Don't close constraints here: done in impose_displacement
-  }
+
+  solution.compress(VectorOperation::insert);
+  // Don't close constraints here: done in impose_displacement
 }  // eom
 
 
@@ -1263,6 +1622,8 @@ impose_displacement(const std::vector<int>          &boundary_ids,
   impose_node_displacement(points, point_components, point_values,
                            constraint_point_phase_field);
   physical_constraints.close();
+  // the active set constraints have to be added again
+  active_set_constraints_valid = false;
   all_constraints.clear();
   all_constraints.reinit(locally_relevant_dofs);
   all_constraints.merge(physical_constraints);
@@ -1274,6 +1635,33 @@ impose_displacement(const std::vector<int>          &boundary_ids,
 template <int dim>
 void PhaseFieldSolver<dim>::setup_preconditioners()
 {
+  /*
+    The hierarchies are only built from scratch when amg_policy asks for it
+    (mesh change, large active set change, or degraded GMRES convergence).
+    Otherwise they are recomputed from the new matrix values.
+    The number of calls of both timer sections shows up in the summary.
+    In single precision the ILU factors are recomputed for every matrix.
+   */
+  if (use_single_precision)
+  {
+    computing_timer.enter_section("Build phase-field float ILU");
+    float_prec_displacement.initialize(system_matrix.block(0, 0));
+    float_prec_phase_field.initialize(system_matrix.block(1, 1));
+    computing_timer.exit_section();
+    return;
+  }
+
+  if (!amg_policy.needs_rebuild())
+  {
+    computing_timer.enter_section("Refresh phase-field AMG");
+    prec_displacement.reinit();
+    prec_phase_field.reinit();
+    amg_policy.refreshed();
+    computing_timer.exit_section();
+    return;
+  }
+
+  computing_timer.enter_section("Build phase-field AMG");
   // Preconditioner for the displacement (0, 0) block
   // TrilinosWrappers::PreconditionAMG prec_displacement;
   {
@@ -1296,43 +1684,119 @@ void PhaseFieldSolver<dim>::setup_preconditioners()
     data.aggregation_threshold = 0.02;
     prec_phase_field.initialize(system_matrix.block(1, 1), data);
   }
+  amg_policy.rebuilt();
+  computing_timer.exit_section();
 }    // eom
 
 
+template <int dim>
+template <class PreconditionerA, class PreconditionerS>
+bool PhaseFieldSolver<dim>::solve_gmres(const PreconditionerA &preconditioner_A,
+                                        const PreconditionerS &preconditioner_S,
+                                        SolverControl         &solver_control)
+{
+  // Construct block preconditioner (for the whole matrix)
+  const LinearSolvers::
+  BlockDiagonalPreconditioner<PreconditionerA, PreconditionerS>
+  preconditioner(preconditioner_A, preconditioner_S);
+
+  // SolverFGMRES<TrilinosWrappers::MPI::BlockVector>
+  SolverGMRES<TrilinosWrappers::MPI::BlockVector>::AdditionalData
+    gmres_data(data.gmres_restart);
+  SolverGMRES<TrilinosWrappers::MPI::BlockVector>
+  solver(solver_control, gmres_data);
+
+  try
+  {
+    solver.solve(system_matrix, solution_update,
+                 rhs_vector, preconditioner);
+  }
+  catch (SolverControl::NoConvergence &exc)
+  {
+    return false;
+  }
+  return true;
+}    // EOM
+
+
 template <int dim>
 unsigned int PhaseFieldSolver<dim>::solve()
 {
   /*
      In this method we essentially use 2 block diagonal preconditioners
-     for the block (0,0) and the block (1, 1)
+     for the block (0,0) and the block (1, 1).
+     A single precision solve whose convergence rate predicts more than
+     the fallback iterations (checked every "Single precision check
+     iterations") continues from its last iterate with the AMG
+     preconditioners, which are kept for the rest of the run.
    */
   computing_timer.enter_section("Solve phase-field system");
 
-  // Construct block preconditioner (for the whole matrix)
-  const LinearSolvers::
-  BlockDiagonalPreconditioner<TrilinosWrappers::PreconditionAMG,
-                              TrilinosWrappers::PreconditionAMG>
-  preconditioner(prec_displacement, prec_phase_field);
-
   // set up the linear solver and solve the system
-  unsigned int max_iter = system_matrix.m();
-  // pcout << "rhs norm" << rhs_vector.l2_norm() << "\t";
-  // double tol = std::max(1e-10*rhs_vector.l2_norm(), 1e-14);
-  double tol = 1e-10*rhs_vector.l2_norm();
-  SolverControl solver_control(max_iter, tol);
-
-  // SolverFGMRES<TrilinosWrappers::MPI::BlockVector>
-  SolverGMRES<TrilinosWrappers::MPI::BlockVector>
-  solver(solver_control);
+  // the rhs is the nonlinear residual at the linearization point
+  const double rhs_norm = rhs_vector.l2_norm();
+  const double eta = forcing_term.update(rhs_norm);
+  const unsigned int max_iter = (data.max_linear_iterations > 0) ?
+                                data.max_linear_iterations : system_matrix.m();
+
+  unsigned int n_iterations = 0;
+  bool converged = false;
+  if (use_single_precision)
+  {
+    LinearSolvers::ConvergenceRateControl
+      solver_control(std::min(max_iter, data.single_precision_fallback_iterations),
+                     eta*rhs_norm, data.single_precision_check_iterations);
+    converged = solve_gmres(float_prec_displacement, float_prec_phase_field,
+                            solver_control);
+    n_iterations += solver_control.last_step();
+    if (!converged)
+    {
+      pcout << "Single precision preconditioner stalled after "
+            << solver_control.last_step() << " iterations: "
+            << "switching to double precision" << std::endl;
+      use_single_precision = false;
+      single_precision_stalled = true;
+      float_prec_displacement.clear();
+      float_prec_phase_field.clear();
+      computing_timer.exit_section();
+      setup_preconditioners();
+      computing_timer.enter_section("Solve phase-field system");
+    }
+  }
 
-  solver.solve(system_matrix, solution_update,
-               rhs_vector, preconditioner);
+  if (!converged)
+  {
+    SolverControl solver_control(max_iter, eta*rhs_norm);
+    converged = solve_gmres(prec_displacement, prec_phase_field,
+                            solver_control);
+    n_iterations += solver_control.last_step();
+    amg_policy.register_iterations(solver_control.last_step());
+    // with adaptive forcing an unconverged update is kept if it still
+    // reduces the residual; the Newton step throws otherwise
+    if (!converged && !forcing_term.is_adaptive())
+      throw SolverControl::NoConvergence(solver_control.last_step(),
+                                         solver_control.last_value());
+  }
 
   all_constraints.distribute(solution_update);
 
+  linear_solve_converged = converged;
+  forcing_term.register_iterations(n_iterations, converged);
+
   computing_timer.exit_section();
 
-	return solver_control.last_step();
+	return n_iterations;
+}    // EOM
+
+
+template <int dim>
+void PhaseFieldSolver<dim>::set_preconditioner_precision(const bool single)
+{
+  use_single_precision = single;
+  single_precision_stalled = false;
+  float_prec_displacement.clear();
+  float_prec_phase_field.clear();
+  amg_policy.force_rebuild();
 }    // EOM
 
 
@@ -1344,6 +1808,14 @@ unsigned int PhaseFieldSolver<dim>::solve()
     return system_matrix.residual(dst, solution_update, rhs_vector);
   }
 
+
+  template <int dim>
+  void
+  PhaseFieldSolver<dim>::update_relevant_solution()
+  {
+    ghost_updater.update(relevant_solution, solution);
+  }
+
   // template <int dim>
   // inline void
   // distribute_local_to_global(const Tensor<2, dim>a &cell_tensor,
@@ -1385,7 +1857,7 @@ unsigned int PhaseFieldSolver<dim>::solve()
       cell = dof_handler.begin_active(),
       endc = dof_handler.end();
 
-    relevant_solution = solution;
+    update_relevant_solution();
     unsigned int idx = 0;
 
     for (; cell!=endc; ++cell)
@@ -1398,10 +1870,9 @@ unsigned int PhaseFieldSolver<dim>::solve()
         fe_values[phase_field].get_function_values(relevant_solution,
                                                    phi_values);
         cell_stress_tensor = 0;
-        double E = data.get_young_modulus->value(cell->center(), 0);
-        double nu = data.get_poisson_ratio->value(cell->center(), 0);
-        double lame_constant = E*nu/((1.+nu)*(1.-2*nu));
-        double shear_modulus = 0.5*E/(1.+nu);
+        const unsigned int c = cell->active_cell_index();
+        double lame_constant = data.cell_properties.lame_constant(c);
+        double shear_modulus = data.cell_properties.shear_modulus(c);
 
         for (unsigned int q=0; q<n_q_points; ++q)
         {
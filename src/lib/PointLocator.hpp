@@ -0,0 +1,369 @@
+#pragma once
+
+#include <deal.II/base/exceptions.h>
+#include <deal.II/base/point.h>
+#include <deal.II/base/utilities.h>
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/tria_accessor.h>
+#include <deal.II/grid/tria_iterator.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/dofs/dof_accessor.h>
+
+#include <boost/signals2/connection.hpp>
+
+#include <algorithm>    // std::min, std::max
+#include <cmath>        // std::pow, std::floor
+#include <limits>       // std::numeric_limits
+#include <vector>
+
+
+namespace Mesher
+{
+  using namespace dealii;
+
+  /*
+    Finds the mesh entities closest to a set of points: vertices of the
+    non-artificial cells and centers of the locally owned cells.
+    The entities are sorted into a uniform grid of buckets spanning their
+    bounding box (about one entity per bucket); a query only visits the
+    buckets around the point.
+    The grids are built on the first query after the triangulation has
+    changed (the locator listens to Triangulation::signals.any_change), so
+    the same object can be kept over the whole run.
+    The results are process-local. Use closest_owners to decide, with a
+    single reduction for all points, which process holds the global
+    closest entity of each point (closest_ties for all processes that
+    share it).
+   */
+  template <int dim>
+  class PointLocator
+  {
+  public:
+    typedef typename Triangulation<dim>::active_cell_iterator CellIterator;
+
+    PointLocator(const Triangulation<dim> &triangulation_);
+    ~PointLocator();
+
+    // closest vertex of the non-artificial cells: cells[p]->vertex(vertices[p])
+    void closest_vertices(const std::vector< Point<dim> > &points,
+                          std::vector<CellIterator>       &cells,
+                          std::vector<unsigned int>       &vertices,
+                          std::vector<double>             &distances);
+    // closest center of the locally owned cells
+    void closest_cell_centers(const std::vector< Point<dim> > &points,
+                              std::vector<CellIterator>       &cells,
+                              std::vector<double>             &distances);
+
+  private:
+    struct Entry
+    {
+      Point<dim>   point;
+      CellIterator cell;
+      unsigned int vertex;
+    };
+
+    class BucketGrid
+    {
+    public:
+      void build(const std::vector<Entry> &entries_);
+      // index of the entry closest to p (invalid_unsigned_int if empty)
+      unsigned int nearest(const Point<dim> &p, double &distance) const;
+      std::vector<Entry> entries;
+
+    private:
+      unsigned int bucket_index(const unsigned int (&ind)[dim]) const;
+      Point<dim>   lower, upper;
+      double       h[dim];
+      unsigned int n_buckets[dim];
+      std::vector< std::vector<unsigned int> > buckets;
+    };
+
+    void update();
+
+    const Triangulation<dim>   &triangulation;
+    boost::signals2::connection tria_listener;
+    bool                        valid;
+    BucketGrid                  vertex_grid, center_grid;
+  };
+
+
+  template <int dim>
+  PointLocator<dim>::PointLocator(const Triangulation<dim> &triangulation_)
+  :
+  triangulation(triangulation_),
+  valid(false)
+  {
+    tria_listener =
+      triangulation.signals.any_change.connect([this](){this->valid = false;});
+  }  // eom
+
+
+  template <int dim>
+  PointLocator<dim>::~PointLocator()
+  {
+    tria_listener.disconnect();
+  }  // eom
+
+
+  template <int dim>
+  void PointLocator<dim>::update()
+  {
+    if (valid)
+      return;
+
+    std::vector<Entry> vertex_entries, center_entries;
+    for (CellIterator cell=triangulation.begin_active();
+         cell!=triangulation.end(); ++cell)
+    {
+      if (cell->is_artificial())
+        continue;
+      for (unsigned int v=0; v<GeometryInfo<dim>::vertices_per_cell; ++v)
+      {
+        const Entry entry = {cell->vertex(v), cell, v};
+        vertex_entries.push_back(entry);
+      }
+      if (cell->is_locally_owned())
+      {
+        const Entry entry = {cell->center(), cell, 0};
+        center_entries.push_back(entry);
+      }
+    }  // end cell loop
+
+    vertex_grid.build(vertex_entries);
+    center_grid.build(center_entries);
+    valid = true;
+  }  // eom
+
+
+  template <int dim>
+  void PointLocator<dim>::
+  closest_vertices(const std::vector< Point<dim> > &points,
+                   std::vector<CellIterator>       &cells,
+                   std::vector<unsigned int>       &vertices,
+                   std::vector<double>             &distances)
+  {
+    update();
+    cells.resize(points.size());
+    vertices.resize(points.size());
+    distances.resize(points.size());
+    for (unsigned int p=0; p<points.size(); ++p)
+    {
+      const unsigned int i = vertex_grid.nearest(points[p], distances[p]);
+      if (i != numbers::invalid_unsigned_int)
+      {
+        cells[p] = vertex_grid.entries[i].cell;
+        vertices[p] = vertex_grid.entries[i].vertex;
+      }
+    }
+  }  // eom
+
+
+  template <int dim>
+  void PointLocator<dim>::
+  closest_cell_centers(const std::vector< Point<dim> > &points,
+                       std::vector<CellIterator>       &cells,
+                       std::vector<double>             &distances)
+  {
+    update();
+    cells.resize(points.size());
+    distances.resize(points.size());
+    for (unsigned int p=0; p<points.size(); ++p)
+    {
+      const unsigned int i = center_grid.nearest(points[p], distances[p]);
+      if (i != numbers::invalid_unsigned_int)
+        cells[p] = center_grid.entries[i].cell;
+    }
+  }  // eom
+
+
+  template <int dim>
+  void PointLocator<dim>::BucketGrid::build(const std::vector<Entry> &entries_)
+  {
+    entries = entries_;
+    buckets.clear();
+    if (entries.size() == 0)
+      return;
+
+    lower = entries[0].point;
+    upper = entries[0].point;
+    for (const auto & entry : entries)
+      for (int d=0; d<dim; ++d)
+      {
+        lower[d] = std::min(lower[d], entry.point[d]);
+        upper[d] = std::max(upper[d], entry.point[d]);
+      }
+
+    // about one entry per bucket
+    const unsigned int n_per_direction =
+      std::max(1, static_cast<int>(std::pow(entries.size(), 1.0/dim)));
+    unsigned int n_total = 1;
+    for (int d=0; d<dim; ++d)
+    {
+      const double length = upper[d] - lower[d];
+      n_buckets[d] = (length > 0) ? n_per_direction : 1;
+      h[d] = (length > 0) ? length/n_buckets[d] : 1.0;
+      n_total *= n_buckets[d];
+    }
+    buckets.resize(n_total);
+
+    for (unsigned int i=0; i<entries.size(); ++i)
+    {
+      unsigned int ind[dim];
+      for (int d=0; d<dim; ++d)
+        ind[d] = std::min(n_buckets[d] - 1,
+                          static_cast<unsigned int>((entries[i].point[d] - lower[d])/h[d]));
+      buckets[bucket_index(ind)].push_back(i);
+    }
+  }  // eom
+
+
+  template <int dim>
+  unsigned int
+  PointLocator<dim>::BucketGrid::bucket_index(const unsigned int (&ind)[dim]) const
+  {
+    unsigned int index = 0;
+    for (int d=dim-1; d>=0; --d)
+      index = index*n_buckets[d] + ind[d];
+    return index;
+  }  // eom
+
+
+  template <int dim>
+  unsigned int
+  PointLocator<dim>::BucketGrid::nearest(const Point<dim> &p,
+                                         double           &distance) const
+  {
+    distance = std::numeric_limits<double>::max();
+    unsigned int best = numbers::invalid_unsigned_int;
+    if (entries.size() == 0)
+      return best;
+
+    // bucket of the point (clamped onto the grid)
+    int center[dim];
+    unsigned int max_n = 0;
+    for (int d=0; d<dim; ++d)
+    {
+      const double x = std::floor((p[d] - lower[d])/h[d]);
+      center[d] = static_cast<int>(std::min(std::max(x, 0.0),
+                                            static_cast<double>(n_buckets[d] - 1)));
+      max_n = std::max(max_n, n_buckets[d]);
+    }
+
+    // search rings of buckets of growing size around the point bucket
+    for (int r=0; r<static_cast<int>(max_n); ++r)
+    {
+      int low[dim], high[dim];
+      unsigned int n_cells = 1;
+      for (int d=0; d<dim; ++d)
+      {
+        low[d] = std::max(center[d] - r, 0);
+        high[d] = std::min(center[d] + r, static_cast<int>(n_buckets[d]) - 1);
+        n_cells *= (high[d] - low[d] + 1);
+      }
+
+      for (unsigned int c=0; c<n_cells; ++c)
+      {
+        // bucket indices of the c-th bucket in the box [low, high]
+        unsigned int ind[dim];
+        unsigned int rest = c;
+        bool on_ring = false;
+        for (int d=0; d<dim; ++d)
+        {
+          const unsigned int width = high[d] - low[d] + 1;
+          ind[d] = low[d] + rest % width;
+          rest /= width;
+          if (static_cast<int>(ind[d]) == center[d] - r ||
+              static_cast<int>(ind[d]) == center[d] + r)
+            on_ring = true;
+        }
+        // inner buckets have been searched before
+        if (!on_ring && r > 0)
+          continue;
+
+        for (const unsigned int i : buckets[bucket_index(ind)])
+        {
+          const double d = p.distance(entries[i].point);
+          if (d < distance)
+          {
+            distance = d;
+            best = i;
+          }
+        }
+      }  // end bucket loop
+
+      // entries outside the searched box are at least this far away
+      double bound = std::numeric_limits<double>::max();
+      for (int d=0; d<dim; ++d)
+      {
+        if (low[d] > 0)
+          bound = std::min(bound, p[d] - (lower[d] + low[d]*h[d]));
+        if (high[d] < static_cast<int>(n_buckets[d]) - 1)
+          bound = std::min(bound, lower[d] + (high[d] + 1)*h[d] - p[d]);
+      }
+      if (best != numbers::invalid_unsigned_int && distance <= bound)
+        break;
+    }  // end ring loop
+
+    return best;
+  }  // eom
+
+
+  /*
+    For every point, true on the process whose local distance is the
+    global minimum (the lowest rank wins ties).
+    One MPI_Allreduce with MPI_MINLOC for all points.
+   */
+  inline
+  std::vector<bool>
+  closest_owners(const std::vector<double> &distances,
+                 MPI_Comm                  &mpi_communicator)
+  {
+    struct DistanceRank
+    {
+      double distance;
+      int    rank;
+    };
+
+    const int this_rank = Utilities::MPI::this_mpi_process(mpi_communicator);
+    std::vector<DistanceRank> local(distances.size()), global(distances.size());
+    for (unsigned int p=0; p<distances.size(); ++p)
+    {
+      local[p].distance = distances[p];
+      local[p].rank = this_rank;
+    }
+
+    if (distances.size() > 0)
+      MPI_Allreduce(&local[0], &global[0], distances.size(),
+                    MPI_DOUBLE_INT, MPI_MINLOC, mpi_communicator);
+
+    std::vector<bool> owners(distances.size());
+    for (unsigned int p=0; p<distances.size(); ++p)
+      owners[p] = (global[p].rank == this_rank);
+    return owners;
+  }  // eom
+
+
+  /*
+    For every point, true on all processes whose local distance equals
+    the global minimum. Unlike closest_owners, ties are kept: a vertex
+    found through a ghost cell has the same distance on every process
+    that sees it, and each of them has to know it (e.g. to add the same
+    constraint line). One MPI_Allreduce with MPI_MIN for all points.
+   */
+  inline
+  std::vector<bool>
+  closest_ties(const std::vector<double> &distances,
+               MPI_Comm                  &mpi_communicator)
+  {
+    std::vector<double> global(distances.size());
+    if (distances.size() > 0)
+      MPI_Allreduce(const_cast<double*>(&distances[0]), &global[0],
+                    distances.size(), MPI_DOUBLE, MPI_MIN, mpi_communicator);
+
+    std::vector<bool> ties(distances.size());
+    for (unsigned int p=0; p<distances.size(); ++p)
+      ties[p] = (distances[p] == global[p]);
+    return ties;
+  }  // eom
+
+}  // end of namespace
@@ -1,3 +1,5 @@
+#pragma once
+
 #include <deal.II/base/tensor.h>
 
 #include <PhaseFieldSolver.hpp>
@@ -28,7 +30,7 @@ namespace Postprocessing {
 
     const FEValuesExtractors::Vector displacement(0);
 
-    pf.relevant_solution = pf.solution;
+    pf.update_relevant_solution();
 
     typename DoFHandler<dim>::active_cell_iterator
       cell = pf.dof_handler.begin_active(),
@@ -93,7 +95,7 @@ namespace Postprocessing {
 
 		const unsigned int n_lines = lines.size();
 		Vector<double> cod_values(n_lines);
-	  pf.relevant_solution = pf.solution;
+	  pf.update_relevant_solution();
 
     typename DoFHandler<dim>::active_cell_iterator
       cell = pf.dof_handler.begin_active(),
@@ -138,64 +140,34 @@ namespace Postprocessing {
 								 	 const TrilinosWrappers::MPI::BlockVector &solution,
 									 const unsigned int                       comp,
 									 const std::vector< Point<dim> >          &points,
+									 Mesher::PointLocator<dim>                &point_locator,
 									 MPI_Comm                                 &mpi_communicator)
 	{
 		// returns values in vertices closest to points
 		const unsigned int n_points = points.size();
-		std::vector<double> min_distances(n_points);
-  	std::vector<types::global_dof_index> closest_vertex_idx(n_points);
-	  for (unsigned int i=0; i<n_points; ++i)
-	  {
-	    min_distances[i] = std::numeric_limits<double>::max();
-	    closest_vertex_idx[i] = std::numeric_limits<unsigned int>::max();
-	  }
-
-		typename DoFHandler<dim>::active_cell_iterator
-			cell = dof_handler.begin_active(),
-			endc = dof_handler.end();
-
-	  for (; cell != endc; ++cell)
-	  {
-	    if (cell->is_artificial())
-	      continue;
-
-	    for (unsigned int v=0; v<GeometryInfo<dim>::vertices_per_cell; ++v)
-	    {
-	      for (unsigned int p=0; p<n_points; ++p)
-	      {
-	        const double distance = points[p].distance(cell->vertex(v));
-
-	        // check if point is the closest so far
-	        if (distance < min_distances[p])
-	        {
-	          types::global_dof_index idx =
-	              cell->vertex_dof_index(v, comp);
-	          closest_vertex_idx[p] = idx;
-	          min_distances[p] = distance;
-	        } // if found a better point
-	      }  // end target point loop
-	    } // end vertex loop
-	  }  // end cell loop
-
-	  // now we need to make sure that only the process with the closest cells
-	  // gets to read the value
-		Vector<double> values(n_points);
+		std::vector<typename Mesher::PointLocator<dim>::CellIterator> cells;
+		std::vector<unsigned int> vertices;
+		std::vector<double> min_distances;
+		point_locator.closest_vertices(points, cells, vertices, min_distances);
+
+	  // only the process with the closest vertex reads the value,
+	  // then a single reduction for all points
+		const std::vector<bool> owners =
+			Mesher::closest_owners(min_distances, mpi_communicator);
+		std::vector<double> local_values(n_points, 0.0), global_values;
 	  for (unsigned int p=0; p<n_points; ++p)
-	  {
-			values[p] = std::numeric_limits<double>::max();
-	    double global_min_distance = Utilities::MPI::min(min_distances[p],
-	                                                     mpi_communicator);
-	    if (global_min_distance == min_distances[p])
-				{
-					values[p] = solution[closest_vertex_idx[p]];
-					// std::cout << values[p] << std::endl;
-					// std::cout << points[p] << std::endl;
-				}
-	  } // end point loop
+	    if (owners[p])
+	    {
+				const typename DoFHandler<dim>::active_cell_iterator
+					cell(&dof_handler.get_tria(),
+							 cells[p]->level(), cells[p]->index(), &dof_handler);
+				local_values[p] = solution[cell->vertex_dof_index(vertices[p], comp)];
+	    }
+		Utilities::MPI::sum(local_values, mpi_communicator, global_values);
 
+		Vector<double> values(n_points);
 	  for (unsigned int p=0; p<n_points; ++p)
-			values[p] = Utilities::MPI::min(values[p], mpi_communicator);
-		// std::cout << values[0] << std::endl;
+			values[p] = global_values[p];
 		return values;
 	}  // eom
 }  // end of namespace
@@ -0,0 +1,404 @@
+#pragma once
+
+#include <deal.II/base/quadrature_lib.h>
+#include <deal.II/base/tensor.h>
+#include <deal.II/base/utilities.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/fe/fe_values.h>
+#include <deal.II/lac/trilinos_block_vector.h>
+#include <deal.II/lac/vector.h>
+
+#include <algorithm>    // std::min, std::max, std::fill
+#include <utility>      // std::pair
+#include <vector>
+
+#include <ConstitutiveModel.hpp>
+#include <InputData.hpp>
+#include <PhaseFieldSolver.hpp>
+#include <PointLocator.hpp>
+
+
+namespace Postprocessing
+{
+  using namespace dealii;
+
+  /*
+    All postprocessing quantities of a time step in one pass over the mesh
+    and one reduction.
+    The quantities are registered once (the handles are given out in the
+    order of registration):
+      boundary load - integral of sigma(u) n over the faces with a boundary id
+      COD           - 0.5 int u grad phi over the face q points within
+                      space_tol of each line (same as compute_cod)
+      point values  - value of a component in the vertex closest to each
+                      point (e.g. well pressures, same as get_point_values)
+    After every mesh change (clear_mesh_data) the faces that contribute to a
+    boundary or a line and the q points of each line are collected, as well
+    as the processes that own the closest vertices. evaluate then only
+    visits those faces, and all results go into one vector that is summed
+    in a single collective.
+   */
+  template <int dim>
+  class Pipeline
+  {
+  public:
+    Pipeline();
+    unsigned int add_boundary_load(const int boundary_id);
+    unsigned int add_cod(const std::vector<double> &lines,
+                         const unsigned int         direction,
+                         const double               space_tol=1e-7);
+    // the dof handler and the (ghosted) vector are read in every evaluate
+    unsigned int add_point_values(const DoFHandler<dim>                    &dof_handler,
+                                  const TrilinosWrappers::MPI::BlockVector &vector,
+                                  const unsigned int                        component,
+                                  const std::vector< Point<dim> >          &points);
+    unsigned int n_quantities() const;
+    // to be called after mesh changes
+    void clear_mesh_data();
+    void evaluate(PhaseField::PhaseFieldSolver<dim> &pf,
+                  const InputData::PhaseFieldData<dim> &data);
+
+    Tensor<1,dim>  get_boundary_load(const unsigned int handle) const;
+    Vector<double> get_cod(const unsigned int handle) const;
+    Vector<double> get_point_values(const unsigned int handle) const;
+
+  private:
+    enum QuantityType {boundary_load_quantity, cod_quantity, point_value_quantity};
+    struct Quantity
+    {
+      QuantityType              type;
+      // index into the value vector, number of values
+      unsigned int              offset, n_values;
+      int                       boundary_id;
+      std::vector<double>       lines;
+      unsigned int              direction;
+      double                    space_tol;
+      const DoFHandler<dim>                    *dof_handler;
+      const TrilinosWrappers::MPI::BlockVector *vector;
+      unsigned int              component;
+      std::vector< Point<dim> > points;
+    };
+    // contributions of one cell face
+    struct FaceEntry
+    {
+      typename DoFHandler<dim>::active_cell_iterator cell;
+      unsigned int                                   face;
+      // boundary loads integrated over this face
+      std::vector<unsigned int>                      loads;
+      // (value index, q point) of the lines through the face
+      std::vector< std::pair<unsigned int, unsigned int> > cod_points;
+    };
+    // local dofs of the closest vertices of the points owned here
+    struct PointEntry
+    {
+      unsigned int              value_index;
+      const TrilinosWrappers::MPI::BlockVector *vector;
+      types::global_dof_index   dof;
+    };
+
+    unsigned int add_quantity(const Quantity &quantity);
+    void setup_mesh_data(PhaseField::PhaseFieldSolver<dim> &pf);
+
+    std::vector<Quantity>   quantities;
+    unsigned int            n_values;
+    bool                    mesh_data_valid;
+    std::vector<FaceEntry>  faces;
+    std::vector<PointEntry> point_entries;
+    std::vector<double>     values;
+  };
+
+
+  template <int dim>
+  Pipeline<dim>::Pipeline()
+  :
+  n_values(0),
+  mesh_data_valid(false)
+  {}  // eom
+
+
+  template <int dim>
+  unsigned int Pipeline<dim>::add_quantity(const Quantity &quantity)
+  {
+    quantities.push_back(quantity);
+    quantities.back().offset = n_values;
+    n_values += quantity.n_values;
+    mesh_data_valid = false;
+    return quantities.size() - 1;
+  }  // eom
+
+
+  template <int dim>
+  unsigned int Pipeline<dim>::add_boundary_load(const int boundary_id)
+  {
+    Quantity quantity;
+    quantity.type = boundary_load_quantity;
+    quantity.n_values = dim;
+    quantity.boundary_id = boundary_id;
+    return add_quantity(quantity);
+  }  // eom
+
+
+  template <int dim>
+  unsigned int Pipeline<dim>::add_cod(const std::vector<double> &lines,
+                                      const unsigned int         direction,
+                                      const double               space_tol)
+  {
+    AssertThrow(direction < dim, ExcMessage("Direction argument is wrong"));
+    Quantity quantity;
+    quantity.type = cod_quantity;
+    quantity.n_values = lines.size();
+    quantity.lines = lines;
+    quantity.direction = direction;
+    quantity.space_tol = space_tol;
+    return add_quantity(quantity);
+  }  // eom
+
+
+  template <int dim>
+  unsigned int Pipeline<dim>::
+  add_point_values(const DoFHandler<dim>                    &dof_handler,
+                   const TrilinosWrappers::MPI::BlockVector &vector,
+                   const unsigned int                        component,
+                   const std::vector< Point<dim> >          &points)
+  {
+    Quantity quantity;
+    quantity.type = point_value_quantity;
+    quantity.n_values = points.size();
+    quantity.dof_handler = &dof_handler;
+    quantity.vector = &vector;
+    quantity.component = component;
+    quantity.points = points;
+    return add_quantity(quantity);
+  }  // eom
+
+
+  template <int dim>
+  unsigned int Pipeline<dim>::n_quantities() const
+  {
+    return quantities.size();
+  }  // eom
+
+
+  template <int dim>
+  void Pipeline<dim>::clear_mesh_data()
+  {
+    mesh_data_valid = false;
+    faces.clear();
+    point_entries.clear();
+  }  // eom
+
+
+  template <int dim>
+  void Pipeline<dim>::setup_mesh_data(PhaseField::PhaseFieldSolver<dim> &pf)
+  {
+    clear_mesh_data();
+
+    // q points of the COD lines
+    const QGauss<dim-1> cod_quadrature(3);
+    FEFaceValues<dim> fe_face_values(pf.fe, cod_quadrature,
+                                     update_quadrature_points);
+    const unsigned int n_face_q_points = cod_quadrature.size();
+
+    typename DoFHandler<dim>::active_cell_iterator
+      cell = pf.dof_handler.begin_active(),
+      endc = pf.dof_handler.end();
+    for (; cell!=endc; ++cell)
+      if (cell->is_locally_owned())
+        for (unsigned int f=0; f<GeometryInfo<dim>::faces_per_cell; ++f)
+        {
+          FaceEntry entry;
+          entry.cell = cell;
+          entry.face = f;
+          bool face_values_computed = false;
+
+          for (unsigned int i=0; i<quantities.size(); ++i)
+          {
+            const Quantity &quantity = quantities[i];
+            if (quantity.type == boundary_load_quantity)
+            {
+              if (cell->face(f)->at_boundary() &&
+                  cell->face(f)->boundary_id() == quantity.boundary_id)
+                entry.loads.push_back(i);
+            }
+            else if (quantity.type == cod_quantity)
+            {
+              // extent of the face across the lines
+              const unsigned int c = 1 - quantity.direction;
+              double x_min = cell->face(f)->vertex(0)[c], x_max = x_min;
+              for (unsigned int v=1; v<GeometryInfo<dim>::vertices_per_face; ++v)
+              {
+                x_min = std::min(x_min, cell->face(f)->vertex(v)[c]);
+                x_max = std::max(x_max, cell->face(f)->vertex(v)[c]);
+              }
+
+              for (unsigned int k=0; k<quantity.lines.size(); ++k)
+              {
+                const double line = quantity.lines[k];
+                if (line + quantity.space_tol < x_min ||
+                    line - quantity.space_tol > x_max)
+                  continue;
+                if (!face_values_computed)
+                {
+                  fe_face_values.reinit(cell, f);
+                  face_values_computed = true;
+                }
+                for (unsigned int q=0; q<n_face_q_points; ++q)
+                {
+                  const double x = fe_face_values.quadrature_point(q)[c];
+                  if (x > line - quantity.space_tol &&
+                      x < line + quantity.space_tol)
+                    entry.cod_points.push_back
+                      (std::make_pair(quantity.offset + k, q));
+                }
+              }  // end line loop
+            }
+          }  // end quantity loop
+
+          if (!entry.loads.empty() || !entry.cod_points.empty())
+            faces.push_back(entry);
+        }  // end face loop
+
+    // closest vertices of the points, one reduction per quantity
+    for (unsigned int i=0; i<quantities.size(); ++i)
+      if (quantities[i].type == point_value_quantity)
+      {
+        const Quantity &quantity = quantities[i];
+        std::vector<typename Mesher::PointLocator<dim>::CellIterator> cells;
+        std::vector<unsigned int> vertices;
+        std::vector<double> min_distances;
+        pf.point_locator.closest_vertices(quantity.points, cells, vertices,
+                                          min_distances);
+        const std::vector<bool> owners =
+          Mesher::closest_owners(min_distances, pf.mpi_communicator);
+        for (unsigned int p=0; p<quantity.points.size(); ++p)
+          if (owners[p])
+          {
+            const typename DoFHandler<dim>::active_cell_iterator
+              dof_cell(&quantity.dof_handler->get_tria(),
+                       cells[p]->level(), cells[p]->index(),
+                       quantity.dof_handler);
+            PointEntry entry;
+            entry.value_index = quantity.offset + p;
+            entry.vector = quantity.vector;
+            entry.dof = dof_cell->vertex_dof_index(vertices[p],
+                                                   quantity.component);
+            point_entries.push_back(entry);
+          }
+      }
+
+    mesh_data_valid = true;
+  }  // eom
+
+
+  template <int dim>
+  void Pipeline<dim>::evaluate(PhaseField::PhaseFieldSolver<dim> &pf,
+                               const InputData::PhaseFieldData<dim> &data)
+  {
+    if (!mesh_data_valid)
+      setup_mesh_data(pf);
+
+    pf.update_relevant_solution();
+
+    const QGauss<dim-1> load_quadrature(pf.fe.degree+1);
+    FEFaceValues<dim> load_face_values(pf.fe, load_quadrature,
+                                       update_gradients | update_normal_vectors |
+                                       update_JxW_values);
+    const QGauss<dim-1> cod_quadrature(3);
+    FEFaceValues<dim> cod_face_values(pf.fe, cod_quadrature,
+                                      update_values | update_gradients |
+                                      update_JxW_values);
+
+    const FEValuesExtractors::Vector displacement(0);
+    const FEValuesExtractors::Scalar phase_field(dim);
+    std::vector< SymmetricTensor<2,dim> > strain_values(load_quadrature.size());
+    std::vector< Tensor<1,dim> > u_values(cod_quadrature.size());
+    std::vector< Tensor<1,dim> > grad_phi_values(cod_quadrature.size());
+    const Tensor<2,dim> identity_tensor =
+      ConstitutiveModel::get_identity_tensor<dim>();
+    Tensor<2,dim> strain_value, stress_value;
+
+    std::vector<double> local_values(n_values, 0.0);
+    for (unsigned int e=0; e<faces.size(); ++e)
+    {
+      const FaceEntry &entry = faces[e];
+      if (!entry.loads.empty())
+      {
+        load_face_values.reinit(entry.cell, entry.face);
+        load_face_values[displacement].get_function_symmetric_gradients
+          (pf.relevant_solution, strain_values);
+
+        Tensor<1,dim> face_load;
+        for (unsigned int q=0; q<load_quadrature.size(); ++q)
+        {
+          PhaseField::convert_to_tensor(strain_values[q], strain_value);
+          stress_value =
+            (data.lame_constant*trace(strain_value)*identity_tensor +
+             2*data.shear_modulus*strain_value);
+          face_load += stress_value*load_face_values.normal_vector(q)*
+                       load_face_values.JxW(q);
+        }
+        for (unsigned int l=0; l<entry.loads.size(); ++l)
+          for (int c=0; c<dim; ++c)
+            local_values[quantities[entry.loads[l]].offset + c] += face_load[c];
+      }
+
+      if (!entry.cod_points.empty())
+      {
+        cod_face_values.reinit(entry.cell, entry.face);
+        cod_face_values[displacement].get_function_values(pf.relevant_solution,
+                                                          u_values);
+        cod_face_values[phase_field].get_function_gradients(pf.relevant_solution,
+                                                            grad_phi_values);
+        for (unsigned int i=0; i<entry.cod_points.size(); ++i)
+        {
+          const unsigned int q = entry.cod_points[i].second;
+          local_values[entry.cod_points[i].first] +=
+            0.5*u_values[q]*grad_phi_values[q]*cod_face_values.JxW(q);
+        }
+      }
+    }  // end face loop
+
+    for (unsigned int p=0; p<point_entries.size(); ++p)
+      local_values[point_entries[p].value_index] =
+        (*point_entries[p].vector)[point_entries[p].dof];
+
+    Utilities::MPI::sum(local_values, pf.mpi_communicator, values);
+  }  // eom
+
+
+  template <int dim>
+  Tensor<1,dim> Pipeline<dim>::get_boundary_load(const unsigned int handle) const
+  {
+    AssertIndexRange(handle, quantities.size());
+    Assert(quantities[handle].type == boundary_load_quantity, ExcInternalError());
+    Tensor<1,dim> load;
+    for (int c=0; c<dim; ++c)
+      load[c] = values[quantities[handle].offset + c];
+    return load;
+  }  // eom
+
+
+  template <int dim>
+  Vector<double> Pipeline<dim>::get_cod(const unsigned int handle) const
+  {
+    AssertIndexRange(handle, quantities.size());
+    Assert(quantities[handle].type == cod_quantity, ExcInternalError());
+    Vector<double> cod_values(quantities[handle].n_values);
+    for (unsigned int k=0; k<cod_values.size(); ++k)
+      cod_values[k] = values[quantities[handle].offset + k];
+    return cod_values;
+  }  // eom
+
+
+  template <int dim>
+  Vector<double> Pipeline<dim>::get_point_values(const unsigned int handle) const
+  {
+    AssertIndexRange(handle, quantities.size());
+    Assert(quantities[handle].type == point_value_quantity, ExcInternalError());
+    Vector<double> point_values(quantities[handle].n_values);
+    for (unsigned int p=0; p<point_values.size(); ++p)
+      point_values[p] = values[quantities[handle].offset + p];
+    return point_values;
+  }  // eom
+
+}  // end of namespace
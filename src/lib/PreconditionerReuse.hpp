@@ -0,0 +1,135 @@
+#pragma once
+
+#include <algorithm>
+
+
+namespace LinearSolvers
+{
+  /*
+    Decides whether an AMG hierarchy has to be built from scratch or if it is
+    enough to recompute it from the new matrix values keeping the setup
+    (TrilinosWrappers::PreconditionAMG::reinit).
+    A rebuild is requested
+      - after the mesh (and thus the sparsity pattern) has changed,
+      - when the active set has changed by more than a fraction of
+        the phase-field dofs since the last rebuild,
+      - when the number of linear iterations grows beyond
+        iteration_factor times the count of the first solve after the
+        last rebuild.
+   */
+  class PreconditionerReusePolicy
+  {
+  public:
+    PreconditionerReusePolicy();
+    void set_thresholds(const double active_set_fraction,
+                        const double iteration_factor);
+    // next setup is a full rebuild (call after mesh changes)
+    void force_rebuild();
+    void register_active_set_change(const double changed_fraction);
+    void register_iterations(const unsigned int n_iterations);
+    bool needs_rebuild() const;
+    // to be called after the preconditioner has been set up
+    void rebuilt();
+    void refreshed();
+    unsigned int n_rebuilds() const;
+    unsigned int n_refreshes() const;
+
+  private:
+    bool         rebuild_requested;
+    double       active_set_threshold, iteration_factor;
+    // active set change accumulated since the last rebuild
+    double       accumulated_change;
+    // iterations of the first solve after a rebuild (0 = not known yet)
+    unsigned int baseline_iterations;
+    unsigned int n_builds, n_updates;
+  };
+
+
+  inline
+  PreconditionerReusePolicy::PreconditionerReusePolicy()
+  :
+  rebuild_requested(true),
+  active_set_threshold(0.05),
+  iteration_factor(2.0),
+  accumulated_change(0),
+  baseline_iterations(0),
+  n_builds(0),
+  n_updates(0)
+  {}  // eom
+
+
+  inline
+  void PreconditionerReusePolicy::set_thresholds(const double active_set_fraction,
+                                                 const double iteration_factor_)
+  {
+    active_set_threshold = active_set_fraction;
+    iteration_factor = iteration_factor_;
+  }  // eom
+
+
+  inline
+  void PreconditionerReusePolicy::force_rebuild()
+  {
+    rebuild_requested = true;
+  }  // eom
+
+
+  inline
+  void PreconditionerReusePolicy::
+  register_active_set_change(const double changed_fraction)
+  {
+    accumulated_change += changed_fraction;
+    if (accumulated_change > active_set_threshold)
+      rebuild_requested = true;
+  }  // eom
+
+
+  inline
+  void PreconditionerReusePolicy::
+  register_iterations(const unsigned int n_iterations)
+  {
+    if (baseline_iterations == 0)
+      baseline_iterations = std::max(n_iterations, 1u);
+    else if (n_iterations > iteration_factor*baseline_iterations)
+      rebuild_requested = true;
+  }  // eom
+
+
+  inline
+  bool PreconditionerReusePolicy::needs_rebuild() const
+  {
+    return rebuild_requested;
+  }  // eom
+
+
+  inline
+  void PreconditionerReusePolicy::rebuilt()
+  {
+    rebuild_requested = false;
+    accumulated_change = 0;
+    baseline_iterations = 0;
+    n_builds++;
+  }  // eom
+
+
+  inline
+  void PreconditionerReusePolicy::refreshed()
+  {
+    n_updates++;
+  }  // eom
+
+
+  inline
+  unsigned int PreconditionerReusePolicy::n_rebuilds() const
+  {
+    return n_builds;
+  }  // eom
+
+
+  inline
+  unsigned int PreconditionerReusePolicy::n_refreshes() const
+  {
+    return n_updates;
+  }  // eom
+
+}  // end of namespace
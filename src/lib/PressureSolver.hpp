@@ -26,7 +26,13 @@
 #include <deal.II/fe/fe_system.h>
 #include <deal.II/lac/sparsity_tools.h>
 
+#include <AssemblyData.hpp>
+#include <FieldCache.hpp>
+#include <ForcingTerm.hpp>
+#include <PreconditionerReuse.hpp>
+#include <ScalarSetupCache.hpp>
 #include <SinglePhaseData.hpp>
+#include <WellSources.hpp>
 
 
 namespace FluidSolvers
@@ -49,17 +55,52 @@ namespace FluidSolvers
 		void assemble_system(const TrilinosWrappers::MPI::BlockVector &solution_solid,
 												 const TrilinosWrappers::MPI::BlockVector &old_solution_solid,
                          const TrilinosWrappers::MPI::BlockVector &solution_width,
-												 const double time_step);
+												 const double time_step,
+												 // interval of the solid change (0 = time_step),
+												 // longer when subcycling
+												 const double solid_time_step = 0);
 		const DoFHandler<dim> &get_dof_handler();
 		const FESystem<dim>   &get_fe();
+		// take phi, div u and width from the cache while it is valid
+		void set_field_cache(const Assembly::FieldCache<dim> &field_cache_);
+		// share index sets, constraints and sparsity with the width solver
+		void set_setup_cache(DofUtilities::ScalarSetupCache<dim> &setup_cache_);
 		const ConstraintMatrix &get_constraint_matrix();
 		unsigned int solve();
+		// lumped-mass L2 norm of the pressure increment over the mesh area
 		double 	solution_increment_norm(
 			const TrilinosWrappers::MPI::BlockVector &linearization_point_relevant,
 			const TrilinosWrappers::MPI::BlockVector &old_iter_solution_relevant);
 
 
 	private:
+		// per-thread data for the cell loop of assemble_system
+		struct AssemblyScratchData
+		{
+			AssemblyScratchData(const FiniteElement<dim> &fe,
+			                    const FiniteElement<dim> &fe_solid,
+			                    const FiniteElement<dim> &fe_width,
+			                    const Quadrature<dim>    &quadrature);
+			AssemblyScratchData(const AssemblyScratchData &scratch);
+
+			FEValues<dim>                fe_values, fe_values_solid, fe_values_width;
+			std::vector<double>          phi_values, p_values, old_p_values,
+			                             div_u_values, div_old_u_values, width_values;
+			std::vector<double>          xi_p;
+			std::vector< Tensor<1,dim> > grad_xi_p;
+			std::vector<double>          source_values;
+		};
+
+		void local_assemble_cell(const typename DoFHandler<dim>::active_cell_iterator &,
+		                         AssemblyScratchData &,
+		                         Assembly::CopyData &,
+		                         const TrilinosWrappers::MPI::BlockVector &,
+		                         const TrilinosWrappers::MPI::BlockVector &,
+		                         const TrilinosWrappers::MPI::BlockVector &,
+		                         const double,
+		                         const double);
+		void setup_increment_weights();
+
 		// these guys are passed at initialization
 		MPI_Comm 																	&mpi_communicator;
 		parallel::distributed::Triangulation<dim> &triangulation;
@@ -69,6 +110,8 @@ namespace FluidSolvers
 		// these are set by method set_coupling
 		const DoFHandler<dim>            					&dof_handler_solid;
 		const DoFHandler<dim>            					&dof_handler_width;
+		const Assembly::FieldCache<dim>           *field_cache;
+		DofUtilities::ScalarSetupCache<dim>       *setup_cache;
 		// auxilary objects
 		ConditionalOStream 												&pcout;
 		TimerOutput 			 												&computing_timer;
@@ -79,8 +122,20 @@ namespace FluidSolvers
 
 		TrilinosWrappers::MPI::BlockVector  rhs_vector;
 		TrilinosWrappers::BlockSparseMatrix system_matrix;
+		TrilinosWrappers::PreconditionAMG   preconditioner;
+		LinearSolvers::PreconditionerReusePolicy amg_policy;
+		// well sources on the current mesh (built in the first assembly)
+		RHS::WellSources<dim>               well_sources;
+		// per-mesh weights of solution_increment_norm (rebuilt when the
+		// dofs change) and its owned work vectors
+		TrilinosWrappers::MPI::BlockVector  increment_weights,
+		                                    increment_owned, old_increment_owned;
+		double                              mesh_area;
 
 	public:
+		// CG tolerance relative to the residual of the last iterate
+		// (reset at the start of every FSS loop)
+		LinearSolvers::ForcingTerm forcing_term;
 		TrilinosWrappers::MPI::BlockVector solution, relevant_solution;
 		TrilinosWrappers::MPI::BlockVector old_solution;
 		std::vector<IndexSet> owned_partitioning, relevant_partitioning;
@@ -103,10 +158,13 @@ namespace FluidSolvers
   dof_handler(triangulation_),
 	dof_handler_solid(dof_handler_solid_),
 	dof_handler_width(dof_handler_width_),
+	field_cache(NULL),
+	setup_cache(NULL),
   pcout(pcout_),
   computing_timer(computing_timer_),
   fe(FE_Q<dim>(1), 1), // one linear pressure component
-	init_pressure(0.0)
+	init_pressure(0.0),
+	mesh_area(0)
 	{}  // eom
 
 
@@ -117,22 +175,55 @@ namespace FluidSolvers
 	}  // eom
 
 
+	template <int dim> void
+	PressureSolver<dim>::
+	set_field_cache(const Assembly::FieldCache<dim> &field_cache_)
+	{
+		field_cache = &field_cache_;
+	}  // eom
+
+
+	template <int dim> void
+	PressureSolver<dim>::
+	set_setup_cache(DofUtilities::ScalarSetupCache<dim> &setup_cache_)
+	{
+		setup_cache = &setup_cache_;
+	}  // eom
+
+
 	template <int dim> void
 	PressureSolver<dim>::setup_dofs()
 	{
+		computing_timer.enter_section("Setup pressure dofs");
 		dof_handler.distribute_dofs(fe);
+		well_sources.clear();
+		computing_timer.exit_section("Setup pressure dofs");
+		if (setup_cache != NULL)
+		{
+			computing_timer.enter_section("Setup shared scalar data");
+			setup_cache->reinit(dof_handler);
+			computing_timer.exit_section("Setup shared scalar data");
+		}
 
-		IndexSet locally_owned_dofs, locally_relevant_dofs;
-		locally_owned_dofs = dof_handler.locally_owned_dofs();
-    DoFTools::extract_locally_relevant_dofs(dof_handler,
-                                            locally_relevant_dofs);
-
-		owned_partitioning.clear();
-		relevant_partitioning.clear();
-		owned_partitioning.push_back(locally_owned_dofs);
-		relevant_partitioning.push_back(locally_relevant_dofs);
+		computing_timer.enter_section("Setup pressure constraints");
+		if (setup_cache != NULL)
+		{ // same dofs as the width solver
+			owned_partitioning = setup_cache->owned_partitioning();
+			relevant_partitioning = setup_cache->relevant_partitioning();
+			setup_cache->make_constraints(constraints, data.init_pressure);
+		}
+		else
+		{
+			IndexSet locally_owned_dofs, locally_relevant_dofs;
+			locally_owned_dofs = dof_handler.locally_owned_dofs();
+	    DoFTools::extract_locally_relevant_dofs(dof_handler,
+	                                            locally_relevant_dofs);
+
+			owned_partitioning.clear();
+			relevant_partitioning.clear();
+			owned_partitioning.push_back(locally_owned_dofs);
+			relevant_partitioning.push_back(locally_relevant_dofs);
 
-		{ // Constraints
 			// only hanging nodes
       ConstraintMatrix hanging_node_constraints;
       hanging_node_constraints.clear();
@@ -153,275 +244,325 @@ namespace FluidSolvers
            constraints, fe.component_mask(pressure_mask));
     	constraints.close();
 		}
+		computing_timer.exit_section("Setup pressure constraints");
 
+		computing_timer.enter_section("Setup pressure sparsity");
 		{ // system matrix
+	    preconditioner.clear();
 	    system_matrix.clear();
-	    TrilinosWrappers::BlockSparsityPattern sp(owned_partitioning,
-	                                              owned_partitioning,
-	                                              relevant_partitioning,
-	                                              mpi_communicator);
-	    DoFTools::make_sparsity_pattern(dof_handler, sp, constraints,
-	                                    /*  keep_constrained_dofs = */ false,
-	                                    Utilities::MPI::this_mpi_process(mpi_communicator));
-	    sp.compress();
-	    system_matrix.reinit(sp);
+	    if (setup_cache != NULL)
+	      system_matrix.reinit(setup_cache->sparsity_pattern());
+	    else
+	    {
+	      TrilinosWrappers::BlockSparsityPattern sp(owned_partitioning,
+	                                                owned_partitioning,
+	                                                relevant_partitioning,
+	                                                mpi_communicator);
+	      DoFTools::make_sparsity_pattern(dof_handler, sp, constraints,
+	                                      /*  keep_constrained_dofs = */ false,
+	                                      Utilities::MPI::this_mpi_process(mpi_communicator));
+	      sp.compress();
+	      system_matrix.reinit(sp);
+	    }
+	    // new sparsity pattern: the AMG hierarchy must be rebuilt
+	    amg_policy.set_thresholds(data.amg_rebuild_active_set_fraction,
+	                              data.amg_rebuild_iteration_factor);
+	    amg_policy.force_rebuild();
+	    // the FSS error is not a residual norm: no terminal safeguard
+	    forcing_term.set_parameters(data.linear_solver_forcing,
+	                                data.linear_solver_tolerance,
+	                                data.max_forcing_term,
+	                                /* nonlinear_tolerance = */ 0);
 		}
+		computing_timer.exit_section("Setup pressure sparsity");
+
+		computing_timer.enter_section("Setup pressure vectors");
 		{ // vectors
 			solution.reinit(owned_partitioning, mpi_communicator);
 			relevant_solution.reinit(relevant_partitioning, mpi_communicator);
 			old_solution.reinit(relevant_partitioning, mpi_communicator);
+			// weights of solution_increment_norm
+			increment_weights.reinit(0);
 	    rhs_vector.reinit(owned_partitioning, relevant_partitioning,
 	                      mpi_communicator, /* omit-zeros=*/ true);
 		}
+		computing_timer.exit_section("Setup pressure vectors");
 	}  // eom
 
+	template <int dim>
+	PressureSolver<dim>::AssemblyScratchData::
+	AssemblyScratchData(const FiniteElement<dim> &fe,
+	                    const FiniteElement<dim> &fe_solid,
+	                    const FiniteElement<dim> &fe_width,
+	                    const Quadrature<dim>    &quadrature)
+	:
+	fe_values(fe, quadrature,
+	          update_values | update_gradients |
+	          update_JxW_values),
+	fe_values_solid(fe_solid, quadrature,
+	                update_values | update_gradients),
+	fe_values_width(fe_width, quadrature, update_values),
+	phi_values(quadrature.size()),
+	p_values(quadrature.size()),
+	old_p_values(quadrature.size()),
+	div_u_values(quadrature.size()),
+	div_old_u_values(quadrature.size()),
+	width_values(quadrature.size()),
+	xi_p(fe.dofs_per_cell),
+	grad_xi_p(fe.dofs_per_cell),
+	source_values(quadrature.size())
+	{}  // eom
+
+
+	template <int dim>
+	PressureSolver<dim>::AssemblyScratchData::
+	AssemblyScratchData(const AssemblyScratchData &scratch)
+	:
+	fe_values(scratch.fe_values.get_fe(),
+	          scratch.fe_values.get_quadrature(),
+	          scratch.fe_values.get_update_flags()),
+	fe_values_solid(scratch.fe_values_solid.get_fe(),
+	                scratch.fe_values_solid.get_quadrature(),
+	                scratch.fe_values_solid.get_update_flags()),
+	fe_values_width(scratch.fe_values_width.get_fe(),
+	                scratch.fe_values_width.get_quadrature(),
+	                scratch.fe_values_width.get_update_flags()),
+	phi_values(scratch.phi_values),
+	p_values(scratch.p_values),
+	old_p_values(scratch.old_p_values),
+	div_u_values(scratch.div_u_values),
+	div_old_u_values(scratch.div_old_u_values),
+	width_values(scratch.width_values),
+	xi_p(scratch.xi_p),
+	grad_xi_p(scratch.grad_xi_p),
+	source_values(scratch.source_values)
+	{}  // eom
+
+
 	template <int dim> void
 	PressureSolver<dim>::
 	assemble_system(const TrilinosWrappers::MPI::BlockVector &solution_solid,
 									const TrilinosWrappers::MPI::BlockVector &old_solution_solid,
 									const TrilinosWrappers::MPI::BlockVector &solution_width,
-									const double                       time_step)
+									const double                       time_step,
+									const double                       solid_time_step)
 	{
     computing_timer.enter_section("Assemble pressure system");
-
-    const auto & fe_solid = dof_handler_solid.get_fe();
-    const auto & fe_width = dof_handler_width.get_fe();
+    const double solid_dt = (solid_time_step > 0) ? solid_time_step : time_step;
 
   	const QGauss<dim> quadrature_formula(fe.degree+2);
-  	FEValues<dim> fe_values(fe, quadrature_formula,
-                          	update_values | update_gradients |
-                          	update_quadrature_points |
-                          	update_JxW_values);
-  	FEValues<dim> fe_values_solid(fe_solid, quadrature_formula,
-                          				update_values | update_gradients |
-																	update_quadrature_points);
-  	FEValues<dim> fe_values_width(fe_width, quadrature_formula,
-                          				update_values);
+		typedef typename DoFHandler<dim>::active_cell_iterator cell_iterator;
+
+		system_matrix = 0;
+		rhs_vector = 0;
+
+		if (!well_sources.is_initialized())
+			well_sources.reinit(dof_handler, quadrature_formula, data.wells);
+
+		WorkStream::
+			run(Assembly::begin_owned(dof_handler),
+			    Assembly::end_owned(dof_handler),
+			    [this, &solution_solid, &old_solution_solid, &solution_width,
+			     time_step, solid_dt]
+			    (const cell_iterator &cell,
+			     AssemblyScratchData &scratch,
+			     Assembly::CopyData  &copy_data)
+			    {
+			      this->local_assemble_cell(cell, scratch, copy_data,
+			                                solution_solid, old_solution_solid,
+			                                solution_width, time_step, solid_dt);
+			    },
+			    [this](const Assembly::CopyData &copy_data)
+			    {
+			      constraints.distribute_local_to_global(copy_data.local_matrix,
+			                                             copy_data.local_rhs,
+			                                             copy_data.local_dof_indices,
+			                                             system_matrix,
+			                                             rhs_vector);
+			    },
+			    AssemblyScratchData(fe, dof_handler_solid.get_fe(),
+			                        dof_handler_width.get_fe(), quadrature_formula),
+			    Assembly::CopyData(fe.dofs_per_cell));
+
+    system_matrix.compress(VectorOperation::add);
+    rhs_vector.compress(VectorOperation::add);
+
+		computing_timer.exit_section();
+	}  // eom
+
 
+	template <int dim> void
+	PressureSolver<dim>::
+	local_assemble_cell(const typename DoFHandler<dim>::active_cell_iterator &cell,
+	                    AssemblyScratchData                      &scratch,
+	                    Assembly::CopyData                       &copy_data,
+	                    const TrilinosWrappers::MPI::BlockVector &solution_solid,
+	                    const TrilinosWrappers::MPI::BlockVector &old_solution_solid,
+	                    const TrilinosWrappers::MPI::BlockVector &solution_width,
+	                    const double                              time_step,
+	                    const double                              solid_time_step)
+	{
 		const FEValuesExtractors::Vector displacement(0);
 		const FEValuesExtractors::Scalar phase_field(dim);
 		const FEValuesExtractors::Scalar pressure(0);
 
+		FEValues<dim> &fe_values = scratch.fe_values;
+		FEValues<dim> &fe_values_solid = scratch.fe_values_solid;
+		FEValues<dim> &fe_values_width = scratch.fe_values_width;
+
 	  const unsigned int dofs_per_cell = fe.dofs_per_cell;
-	  const unsigned int n_q_points    = quadrature_formula.size();
+	  const unsigned int n_q_points    = fe_values.n_quadrature_points;
 
-	  FullMatrix<double>   local_matrix(dofs_per_cell, dofs_per_cell);
-	  Vector<double>       local_rhs(dofs_per_cell);
+	  FullMatrix<double>   &local_matrix = copy_data.local_matrix;
+	  Vector<double>       &local_rhs = copy_data.local_rhs;
 
-  	std::vector<double>  				 phi_values(n_q_points);
-  	std::vector<double>  				 p_values(n_q_points);
-  	std::vector<double>  				 old_p_values(n_q_points);
-		std::vector< Tensor<1,dim> > u_values(n_q_points);
-		std::vector<double>  				 div_u_values(n_q_points);
-		std::vector<double>  				 div_old_u_values(n_q_points);
-  	std::vector<double>  				 width_values(n_q_points);
-		// std::vector< Tensor<1,dim> > old_u_values(n_q_points);
+  	std::vector<double>  				 &phi_values = scratch.phi_values;
+  	std::vector<double>  				 &p_values = scratch.p_values;
+  	std::vector<double>  				 &old_p_values = scratch.old_p_values;
+		std::vector<double>  				 &div_u_values = scratch.div_u_values;
+		std::vector<double>  				 &div_old_u_values = scratch.div_old_u_values;
+  	std::vector<double>  				 &width_values = scratch.width_values;
+  	std::vector<double>  				 &source_values = scratch.source_values;
 
 		// shape functions
-		std::vector<double>  				 xi_p(dofs_per_cell);
-  	std::vector< Tensor<1,dim> > grad_xi_p(dofs_per_cell);
+		std::vector<double>  				 &xi_p = scratch.xi_p;
+  	std::vector< Tensor<1,dim> > &grad_xi_p = scratch.grad_xi_p;
 
-  	std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
+		// same cell in the solid and width dof handlers
+		const typename DoFHandler<dim>::active_cell_iterator
+			cell_solid = Assembly::same_cell(cell, dof_handler_solid),
+			cell_width = Assembly::same_cell(cell, dof_handler_width);
 
-    // Just checking how the source term function performs
-    // double total_flux = 0;
+		local_matrix = 0;
+		local_rhs = 0;
 
-		system_matrix = 0;
-		rhs_vector = 0;
-
-    double test_flow_rate = 0.0;
+		fe_values.reinit(cell);
 
-	  typename DoFHandler<dim>::active_cell_iterator
-		  cell = dof_handler.begin_active(),
-		  cell_solid = dof_handler_solid.begin_active(),
-		  cell_width = dof_handler_width.begin_active(),
-		  endc = dof_handler.end();
-
-	  for (; cell!=endc; ++cell, ++cell_solid, ++cell_width)
-	    if (cell->is_locally_owned())
+		// extract solution values
+		const unsigned int cell_index = cell->active_cell_index();
+		if (field_cache != NULL && field_cache->width_valid() &&
+		    field_cache->n_quadrature_points() == n_q_points)
+			for (unsigned int q=0; q<n_q_points; ++q)
 			{
-				local_matrix = 0;
-				local_rhs = 0;
-
-				fe_values.reinit(cell);
-				fe_values_solid.reinit(cell_solid);
-				fe_values_width.reinit(cell_width);
-
-				// extract solution values
-	      fe_values_solid[phase_field].get_function_values(solution_solid, phi_values);
-	      fe_values_solid[displacement].get_function_values(solution_solid, u_values);
-	      fe_values_solid[displacement].get_function_divergences(solution_solid,
-                                         								  	 	 div_u_values);
-	      fe_values_solid[displacement].get_function_divergences(old_solution_solid,
-                                         								  		 div_old_u_values);
-	      fe_values[pressure].get_function_values(relevant_solution, p_values);
-	      fe_values[pressure].get_function_values(old_solution, old_p_values);
-        fe_values_width.get_function_values(solution_width, width_values);
-
-
-				// compute poroelastic coefficients
-	      double E = data.get_young_modulus->value(cell_solid->center(), 0);
-				double nu = data.get_poisson_ratio->value(cell_solid->center(), 0);
-				double bulk_modulus = E/3.0/(1.0-2.0*nu);
-
-				// reciprocal poroelastic modulus M
-				double recM =
-					(data.biot_coef - data.porosity)*
-					(1.0-data.biot_coef)/bulk_modulus
-					+
-					data.porosity*data.fluid_compressibility;
-				// pcout << "recM " << recM << std::endl;
-
-				/* optimal FSS comvergence coefficient
-				ref: Convergence of iterative coupling for coupledflow and geomechanics
-				Mikelic, Wheeler, 2012 */
-				// this is for 3D
-        // double beta = 0.5*data.biot_coef*data.biot_coef/bulk_modulus;
-				// this works good for 2D
-        double beta = 0.25*data.biot_coef*data.biot_coef/bulk_modulus;
-
-        // double source_term = 0;
-        // for (unsigned int k=0; k<data.wells.size(); ++k)
-        //   source_term += data.wells[k]->value(cell->center(), 0) /
-        //     cell->measure(); // / dofs_per_cell;
-        const auto & q_points = fe_values.get_quadrature_points();
+				phi_values[q] = field_cache->phi(cell_index, q);
+				div_u_values[q] = field_cache->div_u(cell_index, q);
+				div_old_u_values[q] = field_cache->div_old_u(cell_index, q);
+				width_values[q] = field_cache->width(cell_index, q);
+			}
+		else
+		{
+			fe_values_solid.reinit(cell_solid);
+			fe_values_width.reinit(cell_width);
+	    fe_values_solid[phase_field].get_function_values(solution_solid, phi_values);
+	    fe_values_solid[displacement].get_function_divergences(solution_solid,
+	                                   								  	 	 div_u_values);
+	    fe_values_solid[displacement].get_function_divergences(old_solution_solid,
+	                                   								  		 div_old_u_values);
+	    fe_values_width.get_function_values(solution_width, width_values);
+		}
+    fe_values[pressure].get_function_values(relevant_solution, p_values);
+    fe_values[pressure].get_function_values(old_solution, old_p_values);
+
+		// compute poroelastic coefficients
+		double bulk_modulus =
+			data.cell_properties.bulk_modulus(cell->active_cell_index());
+
+		// reciprocal poroelastic modulus M
+		double recM =
+			(data.biot_coef - data.porosity)*
+			(1.0-data.biot_coef)/bulk_modulus
+			+
+			data.porosity*data.fluid_compressibility;
+
+		/* optimal FSS comvergence coefficient
+		ref: Convergence of iterative coupling for coupledflow and geomechanics
+		Mikelic, Wheeler, 2012 */
+		// this is for 3D
+    // double beta = 0.5*data.biot_coef*data.biot_coef/bulk_modulus;
+		// this works good for 2D
+    double beta = 0.25*data.biot_coef*data.biot_coef/bulk_modulus;
+
+		// Wellbore
+		const bool source_cell = well_sources.has_sources(cell->active_cell_index());
+		if (source_cell)
+			well_sources.get_source_values(cell->active_cell_index(), data.wells,
+			                               source_values);
+
+		for (unsigned int q=0; q<n_q_points; ++q)
+		{
+      const double source_term = (source_cell) ? source_values[q] : 0.0;
+
+			// Indicator functions of the fracture and reservoir zones
+			const double xi_f =
+				Assembly::FieldCache<dim>::fracture_indicator(phi_values[q]);
+			const double xi_r = 1.0 - xi_f;
+
+			// interpolate pereability
+      const double perm_eff =
+				Assembly::FieldCache<dim>::effective_permeability(phi_values[q],
+				                                                  width_values[q],
+				                                                  data.perm_res);
+			const double K_eff = perm_eff/data.fluid_viscosity;
+
+			// compute shape functions
+      for (unsigned int k=0; k<dofs_per_cell; ++k)
+			{
+				xi_p[k] = fe_values[pressure].value(k, q);
+				grad_xi_p[k] = fe_values[pressure].gradient(k, q);
+			}  // end k loop
 
-				for (unsigned int q=0; q<n_q_points; ++q)
+      for (unsigned int i=0; i<dofs_per_cell; ++i)
+			{
+      	for (unsigned int j=0; j<dofs_per_cell; ++j)
 				{
-          // Wellbore
-          double source_term = 0;
-          for (unsigned int k=0; k<data.wells.size(); ++k)
-            source_term += data.wells[k]->value(q_points[q], 0);
-          //
-          test_flow_rate += source_term*fe_values.JxW(q);
-					// values that separate fracture, reservoir, and cake zone
-					double cx = 0.1;
-					double c1 = 0.5 - cx;
-					double c2 = 0.5 + cx;
-					// Indicator functions
-					double xi_f = (c2 - phi_values[q])/(c2 - c1);
-					double xi_r = (phi_values[q] - c1)/(c2 - c1);
-					if (phi_values[q] <= c1)
-					{
-						xi_f = 1.0;
-						xi_r = 0.0;
-					}
-					if (phi_values[q] >= c2)
-					{
-						xi_f = 0.0;
-						xi_r = 1.0;
-					}
-
-					// compute perm
-					// this is a simplistic way to compute frac width but is good for now
-					// double w = 2*u_values[q].norm();  // absolute value
-					double w = std::max(width_values[q], 0.0);  // absolute value
-					double perm_f = 1.0/12.0*w*w;   // fracture perm from lubrication theory
-					// perm_f = 10*data.perm_res;
-					// perm_f = 1e-11;
-					// perm_f = std::max(1e3*data.perm_res, perm_f);
-					perm_f = std::max(1e-11, perm_f);
-					// perm_f = std::max(data.perm_res, perm_f);
-
-					// interpolate pereability
-          const double perm_eff = data.perm_res + xi_f*(perm_f - data.perm_res);
-					const double K_eff = perm_eff/data.fluid_viscosity;
-
-					// K_eff = std::max(data.perm_res/data.fluid_viscosity, K_eff);
-
-					// if (source_term > 0)
-					// 	pcout << "source " << source_term << std::endl;
-
-					// if (phi_values[q] > 0.1 && phi_values[q] < 0.5)
-					// {
-					// 	pcout << "phi " << phi_values[q] << std::endl;
-					// pcout << "xi_f " << xi_f << std::endl;
-					// pcout << "xi_r " << xi_r << std::endl;
-					// 	pcout << "K_r " << data.perm_res << std::endl;
-					// 	pcout << "K_f " << perm_f << std::endl;
-					// 	pcout << "K_eff " << K_eff*data.fluid_viscosity << std::endl;
-					// }
-
-					// compute shape functions
-	        for (unsigned int k=0; k<dofs_per_cell; ++k)
-					{
-						xi_p[k] = fe_values[pressure].value(k, q);
-						grad_xi_p[k] = fe_values[pressure].gradient(k, q);
-						// pcout << "xi_p " << xi_p[k] << std::endl;
-					}  // end k loop
-
-	        for (unsigned int i=0; i<dofs_per_cell; ++i)
-					{
-	        	for (unsigned int j=0; j<dofs_per_cell; ++j)
-						{
-							double m_r =
-								(recM + beta) *
-								xi_p[j]/time_step*xi_p[i]
-								+
-								K_eff*grad_xi_p[j]*grad_xi_p[i]
-								;
-
-							double m_f =
-								data.fluid_compressibility *
-								xi_p[j]/time_step*xi_p[i]
-								+
-								K_eff*grad_xi_p[j]*grad_xi_p[i]
-								;
-
-							local_matrix(i, j) += (xi_r*m_r + xi_f*m_f)*fe_values.JxW(q);
-						}  // end j loop
-
-						// pcout <<
-						// 	(1./modulus_M + data.biot_coef*data.biot_coef/bulk_modulus)
-						// 	// * old_p_values[q]/time_step
-						// 	<< std::endl;
-
-						double rhs_r =
-							(recM + beta) *
-							old_p_values[q]/time_step*xi_p[i]
-							-
-							data.biot_coef *
-							(div_u_values[q] - div_old_u_values[q])/time_step*xi_p[i]
-							// +
-							// K_eff*data.fluid_density*g_vector*grad_xi_p[i]
-							+
-							beta*(p_values[q] - old_p_values[q])/time_step*xi_p[i]
-							+
-							source_term*xi_p[i]
-							;
-
-						double rhs_f =
-							data.fluid_compressibility *
-							old_p_values[q]/time_step*xi_p[i]
-							// +
-							// Keff *
-							// data.fluid_density*g_vector*grad_xi_p[i]
-							+
-							source_term*xi_p[i]
-							// +
-							// leakoff term
-							;
-
-							local_rhs[i] += (xi_r*rhs_r + xi_f*rhs_f)*fe_values.JxW(q);
-					}  // end i loop
-				}  // end q-point loop
-
-	      cell->get_dof_indices(local_dof_indices);
-	      constraints.distribute_local_to_global(local_matrix,
-	                                             local_rhs,
-	                                             local_dof_indices,
-	                                             system_matrix,
-	                                             rhs_vector);
-			}  // end cell loop
+					double m_r =
+						(recM + beta) *
+						xi_p[j]/time_step*xi_p[i]
+						+
+						K_eff*grad_xi_p[j]*grad_xi_p[i]
+						;
+
+					double m_f =
+						data.fluid_compressibility *
+						xi_p[j]/time_step*xi_p[i]
+						+
+						K_eff*grad_xi_p[j]*grad_xi_p[i]
+						;
+
+					local_matrix(i, j) += (xi_r*m_r + xi_f*m_f)*fe_values.JxW(q);
+				}  // end j loop
+
+				double rhs_r =
+					(recM + beta) *
+					old_p_values[q]/time_step*xi_p[i]
+					-
+					data.biot_coef *
+					(div_u_values[q] - div_old_u_values[q])/solid_time_step*xi_p[i]
+					// +
+					// K_eff*data.fluid_density*g_vector*grad_xi_p[i]
+					+
+					beta*(p_values[q] - old_p_values[q])/time_step*xi_p[i]
+					+
+					source_term*xi_p[i]
+					;
+
+				double rhs_f =
+					data.fluid_compressibility *
+					old_p_values[q]/time_step*xi_p[i]
+					// +
+					// Keff *
+					// data.fluid_density*g_vector*grad_xi_p[i]
+					+
+					source_term*xi_p[i]
+					// +
+					// leakoff term
+					;
 
-    system_matrix.compress(VectorOperation::add);
-    rhs_vector.compress(VectorOperation::add);
-    // Just checking
-    test_flow_rate = Utilities::MPI::sum(test_flow_rate, mpi_communicator);
-    // pcout << "Total flux " << test_flow_rate << std::endl;
-		// pcout << "norm " << rhs_vector.l2_norm() << std::endl;
+					local_rhs[i] += (xi_r*rhs_r + xi_f*rhs_f)*fe_values.JxW(q);
+			}  // end i loop
+		}  // end q-point loop
 
-		computing_timer.exit_section();
+    cell->get_dof_indices(copy_data.local_dof_indices);
 	}  // eom
 
 
@@ -450,24 +591,66 @@ namespace FluidSolvers
 	template <int dim> unsigned int
 	PressureSolver<dim>::solve()
 	{
+		// same lifecycle as the phase-field preconditioners:
+		// full setup only after mesh changes or when CG convergence degrades
+		if (amg_policy.needs_rebuild())
+		{
+			computing_timer.enter_section("Build pressure AMG");
+			TrilinosWrappers::PreconditionAMG::AdditionalData data;
+	    // data.constant_modes = constant_modes;
+	    data.elliptic = true;
+	    data.smoother_sweeps = 2;
+	    data.aggregation_threshold = 0.02;
+			preconditioner.initialize(system_matrix.block(0, 0), data);
+			amg_policy.rebuilt();
+			computing_timer.exit_section();
+		}
+		else
+		{
+			computing_timer.enter_section("Refresh pressure AMG");
+			preconditioner.reinit();
+			amg_policy.refreshed();
+			computing_timer.exit_section();
+		}
+
   	computing_timer.enter_section("Solve pressure system");
-  	const unsigned int max_iter = system_matrix.m();
-		const double tol = 1e-10 + 1e-10*rhs_vector.l2_norm();
+  	const unsigned int max_iter = (data.max_linear_iterations > 0) ?
+  	                              data.max_linear_iterations : system_matrix.m();
+		double tol = 1e-10 + 1e-10*rhs_vector.l2_norm();
+		// the residual of the last iterate measures how far the coupled
+		// iteration is from convergence
+		double residual_norm = 0;
+		if (forcing_term.is_adaptive())
+		{
+			TrilinosWrappers::MPI::Vector tmp(rhs_vector.block(0));
+			residual_norm =
+				system_matrix.block(0, 0).residual(tmp, solution.block(0),
+				                                   rhs_vector.block(0));
+		}
+		const double eta = forcing_term.update(residual_norm);
+		if (forcing_term.is_adaptive())
+			tol = std::max(tol, eta*residual_norm);
 		SolverControl solver_control(max_iter, tol);
 		TrilinosWrappers::SolverCG solver(solver_control);
 
-		TrilinosWrappers::PreconditionAMG preconditioner;
-		TrilinosWrappers::PreconditionAMG::AdditionalData data;
-    // data.constant_modes = constant_modes;
-    data.elliptic = true;
-    data.smoother_sweeps = 2;
-    data.aggregation_threshold = 0.02;
-		preconditioner.initialize(system_matrix.block(0, 0), data);
-
-		solver.solve(system_matrix.block(0, 0), solution.block(0),
-								 rhs_vector.block(0), preconditioner);
+		bool converged = true;
+		try
+		{
+			solver.solve(system_matrix.block(0, 0), solution.block(0),
+									 rhs_vector.block(0), preconditioner);
+		}
+		catch (SolverControl::NoConvergence &exc)
+		{
+			// with adaptive forcing one unconverged solve per FSS loop is
+			// kept; the drivers cut the time step after a second one
+			if (!forcing_term.accept_unconverged())
+				throw;
+			converged = false;
+		}
 
 		constraints.distribute(solution);
+		amg_policy.register_iterations(solver_control.last_step());
+		forcing_term.register_iterations(solver_control.last_step(), converged);
 		// relevant_solution = solution;
 
   	computing_timer.exit_section();
@@ -476,59 +659,78 @@ namespace FluidSolvers
 	}  // eom
 
 
-	template <int dim> double
-	PressureSolver<dim>::
-	solution_increment_norm(
-		const TrilinosWrappers::MPI::BlockVector &linearization_point_relevant,
-		const TrilinosWrappers::MPI::BlockVector &old_iter_solution_relevant)
+	template <int dim> void
+	PressureSolver<dim>::setup_increment_weights()
 	{
-  	const QGauss<dim> quadrature_formula(fe.degree+2);
-  	FEValues<dim> fe_values(fe, quadrature_formula,
-                          	update_values |
-                          	update_quadrature_points |
-                          	update_JxW_values);
-
-		const FEValuesExtractors::Scalar pressure(0);
-
-	  const unsigned int dofs_per_cell = fe.dofs_per_cell;
-	  const unsigned int n_q_points    = quadrature_formula.size();
-
-  	std::vector<double>  				 p_values(n_q_points);
-  	std::vector<double>  				 old_p_values(n_q_points);
-
-  	std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
-
-		double error = 0;
+		// lumped mass of each dof: int phi_i dx, condensed so that hanging
+		// and boundary dofs get no weight (their values are not free)
+		const QGauss<dim> quadrature_formula(fe.degree+1);
+		FEValues<dim> fe_values(fe, quadrature_formula,
+		                        update_values | update_JxW_values);
+
+		const unsigned int dofs_per_cell = fe.dofs_per_cell;
+		const unsigned int n_q_points    = quadrature_formula.size();
+		Vector<double> cell_weights(dofs_per_cell);
+		std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
+
+		TrilinosWrappers::MPI::BlockVector
+			weights(owned_partitioning, relevant_partitioning,
+			        mpi_communicator, /* omit-zeros=*/ true);
 		double area = 0;
-
-	  typename DoFHandler<dim>::active_cell_iterator
-		  cell = dof_handler.begin_active(),
-		  endc = dof_handler.end();
-
-	  for (; cell!=endc; ++cell)
-	    if (cell->is_locally_owned())
+		typename DoFHandler<dim>::active_cell_iterator
+			cell = dof_handler.begin_active(),
+			endc = dof_handler.end();
+		for (; cell!=endc; ++cell)
+			if (cell->is_locally_owned())
 			{
 				fe_values.reinit(cell);
-				double d = cell->diameter();
+				const double d = cell->diameter();
 				area += d*d;
+				cell_weights = 0;
+				for (unsigned int q=0; q<n_q_points; ++q)
+					for (unsigned int i=0; i<dofs_per_cell; ++i)
+						cell_weights[i] += fe_values.shape_value(i, q)*fe_values.JxW(q);
+				cell->get_dof_indices(local_dof_indices);
+				constraints.distribute_local_to_global(cell_weights, local_dof_indices,
+				                                       weights);
+			}  // end cell loop
+		weights.compress(VectorOperation::add);
+
+		increment_weights.reinit(owned_partitioning, mpi_communicator);
+		increment_weights = weights;
+		increment_owned.reinit(owned_partitioning, mpi_communicator);
+		old_increment_owned.reinit(owned_partitioning, mpi_communicator);
+		mesh_area = Utilities::MPI::sum(area, mpi_communicator);
+	}  // eom
 
-				fe_values[pressure].get_function_values(
-					linearization_point_relevant, p_values);
-				fe_values[pressure].get_function_values(
-					old_iter_solution_relevant, old_p_values);
 
-					for (unsigned int q=0; q<n_q_points; ++q)
-					{
-						double dp = p_values[q] - old_p_values[q];
-						error += dp*dp*fe_values.JxW(q);
-					}  // end q_point loop
-			} // end cell loop
+	template <int dim> double
+	PressureSolver<dim>::
+	solution_increment_norm(
+		const TrilinosWrappers::MPI::BlockVector &linearization_point_relevant,
+		const TrilinosWrappers::MPI::BlockVector &old_iter_solution_relevant)
+	{
+		// the weights only depend on the mesh
+		if (increment_weights.size() != dof_handler.n_dofs())
+			setup_increment_weights();
 
-			error = Utilities::MPI::sum(error, mpi_communicator);
-			area = Utilities::MPI::sum(area, mpi_communicator);
-			error = std::sqrt(error)/area;
-			// pcout << "area " << area << std::endl;
-			return error;
+		// owned parts only, no ghost exchange
+		increment_owned = linearization_point_relevant;
+		old_increment_owned = old_iter_solution_relevant;
 
+		// lumped-mass L2 norm of the increment, constrained dofs have zero
+		// weight; a single reduction
+		double error = 0;
+		const double *p = increment_owned.block(0).begin(),
+		             *old_p = old_increment_owned.block(0).begin(),
+		             *w = increment_weights.block(0).begin();
+		const unsigned int n_local = increment_owned.block(0).local_size();
+		for (unsigned int i=0; i<n_local; ++i)
+		{
+			const double dp = p[i] - old_p[i];
+			error += w[i]*dp*dp;
+		}
+		error = Utilities::MPI::sum(error, mpi_communicator);
+		return std::sqrt(error)/mesh_area;
 	} // eom
 }  // end of namespace
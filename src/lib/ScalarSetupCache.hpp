@@ -0,0 +1,191 @@
+#pragma once
+
+#include <deal.II/base/index_set.h>
+#include <deal.II/distributed/tria.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/dofs/dof_tools.h>
+#include <deal.II/fe/fe.h>
+#include <deal.II/lac/constraint_matrix.h>
+#include <deal.II/lac/trilinos_block_sparse_matrix.h>
+#include <deal.II/lac/trilinos_sparsity_pattern.h>
+
+#include <boost/signals2/connection.hpp>
+#include <vector>
+
+
+namespace DofUtilities
+{
+  using namespace dealii;
+
+  /*
+    Mesh dependent setup data shared by the scalar solvers that sit on the
+    same triangulation with the same (linear) element, e.g. the pressure
+    and the width solver: their dofs are numbered in the same way, so the
+    owned and relevant index sets, the hanging node constraints, the list
+    of boundary dofs and the sparsity pattern (all boundary dofs
+    constrained) are computed once per mesh by the first solver and
+    reused by the others. The cache invalidates itself when the
+    triangulation changes (Triangulation::signals.any_change).
+   */
+  template <int dim>
+  class ScalarSetupCache
+  {
+  public:
+    ScalarSetupCache(const parallel::distributed::Triangulation<dim> &triangulation_,
+                     MPI_Comm                                        &mpi_communicator_);
+    ~ScalarSetupCache();
+    // build the data unless it is valid for dof_handler
+    void reinit(const DoFHandler<dim> &dof_handler);
+    bool is_valid(const DoFHandler<dim> &dof_handler) const;
+    // hanging nodes + the boundary dofs with the given (constant) value
+    void make_constraints(ConstraintMatrix &constraints,
+                          const double      boundary_value) const;
+
+    const std::vector<IndexSet> & owned_partitioning() const;
+    const std::vector<IndexSet> & relevant_partitioning() const;
+    const TrilinosWrappers::BlockSparsityPattern & sparsity_pattern() const;
+    unsigned int n_reuses() const;
+
+  private:
+    const parallel::distributed::Triangulation<dim> &triangulation;
+    MPI_Comm                                        &mpi_communicator;
+    boost::signals2::connection                     tria_listener;
+    bool                                            valid;
+    unsigned int                                    dofs_per_cell, n_reused;
+    std::vector<IndexSet>                           owned, relevant;
+    IndexSet                                        boundary_dofs;
+    ConstraintMatrix                                hanging_node_constraints;
+    TrilinosWrappers::BlockSparsityPattern          sp;
+  };
+
+
+  template <int dim>
+  ScalarSetupCache<dim>::
+  ScalarSetupCache(const parallel::distributed::Triangulation<dim> &triangulation_,
+                   MPI_Comm                                        &mpi_communicator_)
+  :
+  triangulation(triangulation_),
+  mpi_communicator(mpi_communicator_),
+  valid(false),
+  dofs_per_cell(0),
+  n_reused(0)
+  {
+    tria_listener =
+      triangulation.signals.any_change.connect([this](){this->valid = false;});
+  }  // eom
+
+
+  template <int dim>
+  ScalarSetupCache<dim>::~ScalarSetupCache()
+  {
+    tria_listener.disconnect();
+  }  // eom
+
+
+  template <int dim>
+  bool ScalarSetupCache<dim>::is_valid(const DoFHandler<dim> &dof_handler) const
+  {
+    // same dof distribution: one dof per vertex and the same owned dofs
+    return (valid &&
+            dof_handler.get_fe().dofs_per_vertex == 1 &&
+            dof_handler.get_fe().dofs_per_cell == dofs_per_cell &&
+            dof_handler.n_dofs() == owned[0].size() &&
+            dof_handler.locally_owned_dofs() == owned[0]);
+  }  // eom
+
+
+  template <int dim>
+  void ScalarSetupCache<dim>::reinit(const DoFHandler<dim> &dof_handler)
+  {
+    if (is_valid(dof_handler))
+    {
+      n_reused++;
+      return;
+    }
+
+    Assert(dof_handler.get_fe().dofs_per_vertex == 1 &&
+           dof_handler.get_fe().n_components() == 1,
+           ExcMessage("ScalarSetupCache needs a scalar linear element"));
+
+    dofs_per_cell = dof_handler.get_fe().dofs_per_cell;
+    owned.resize(1);
+    relevant.resize(1);
+    owned[0] = dof_handler.locally_owned_dofs();
+    DoFTools::extract_locally_relevant_dofs(dof_handler, relevant[0]);
+
+    hanging_node_constraints.clear();
+    hanging_node_constraints.reinit(relevant[0]);
+    DoFTools::make_hanging_node_constraints(dof_handler,
+                                            hanging_node_constraints);
+    hanging_node_constraints.close();
+
+    // all boundary ids
+    DoFTools::extract_boundary_dofs(dof_handler, ComponentMask(),
+                                    boundary_dofs);
+
+    // the pattern only depends on which dofs are constrained
+    ConstraintMatrix constraints;
+    make_constraints(constraints, 0.0);
+    sp.reinit(owned, owned, relevant, mpi_communicator);
+    DoFTools::make_sparsity_pattern(dof_handler, sp, constraints,
+                                    /*  keep_constrained_dofs = */ false,
+                                    Utilities::MPI::this_mpi_process(mpi_communicator));
+    sp.compress();
+
+    valid = true;
+  }  // eom
+
+
+  template <int dim>
+  void ScalarSetupCache<dim>::make_constraints(ConstraintMatrix &constraints,
+                                               const double      boundary_value) const
+  {
+    Assert(valid, ExcNotInitialized());
+    constraints.clear();
+    constraints.reinit(relevant[0]);
+    constraints.merge(hanging_node_constraints);
+    // as interpolate_boundary_values: hanging dofs keep their constraint
+    for (IndexSet::ElementIterator it = boundary_dofs.begin();
+         it != boundary_dofs.end(); ++it)
+      if (!constraints.is_constrained(*it))
+      {
+        constraints.add_line(*it);
+        if (boundary_value != 0)
+          constraints.set_inhomogeneity(*it, boundary_value);
+      }
+    constraints.close();
+  }  // eom
+
+
+  template <int dim>
+  const std::vector<IndexSet> &
+  ScalarSetupCache<dim>::owned_partitioning() const
+  {
+    return owned;
+  }  // eom
+
+
+  template <int dim>
+  const std::vector<IndexSet> &
+  ScalarSetupCache<dim>::relevant_partitioning() const
+  {
+    return relevant;
+  }  // eom
+
+
+  template <int dim>
+  const TrilinosWrappers::BlockSparsityPattern &
+  ScalarSetupCache<dim>::sparsity_pattern() const
+  {
+    Assert(valid, ExcNotInitialized());
+    return sp;
+  }  // eom
+
+
+  template <int dim>
+  unsigned int ScalarSetupCache<dim>::n_reuses() const
+  {
+    return n_reused;
+  }  // eom
+
+}  // end of namespace
@@ -2,14 +2,28 @@
 
 #include<Well.hpp>
 
+#include <algorithm>    // std::upper_bound
+#include <limits>       // std::numeric_limits
+#include <map>
+#include <string>
+#include <vector>
+
 namespace RHS
 {
 	using namespace dealii;
 
+	/*
+	  Well schedule. The lines of the schedule table are sorted into
+	  per-well arrays of times and controls when they are added, so that
+	  get_well_controls is a binary search per well (no string lookups).
+	  A well keeps the control of its last line with time <= t; wells
+	  without such a line are rate wells with zero rate.
+	 */
 	template <int dim>
 	class Scheduler
 	{
 	public:
+		Scheduler();
 		std::vector<RHS::WellControl> get_well_controls(const double time) const;
 		void add_well(const unsigned int idx, const std::string &name);
 		void set_schedule(const std::vector<double>       &times,
@@ -23,17 +37,32 @@ namespace RHS
 	unsigned int get_well_index(const std::string &wname) const;
 
   private:
-		std::vector<double> times, values;
-		std::vector<std::string> schedule_well_names;
-		std::vector<unsigned int> control_values;
+		double last_time;
+		unsigned int n_lines;
 		std::map<std::string, unsigned int> indexing;
+		// [well][line of the well]
+		std::vector< std::vector<double> > well_times;
+		std::vector< std::vector<RHS::WellControl> > well_controls;
 	};
 
 
+	template <int dim>
+	Scheduler<dim>::Scheduler()
+	:
+	last_time(-std::numeric_limits<double>::max()),
+	n_lines(0)
+	{} // eom
+
+
 	template <int dim> void
 	Scheduler<dim>::add_well(const unsigned int idx, const std::string &name)
 	{
 		indexing[name] = idx;
+		if (well_times.size() <= idx)
+		{
+			well_times.resize(idx + 1);
+			well_controls.resize(idx + 1);
+		}
 	} // eom
 
 
@@ -43,47 +72,49 @@ namespace RHS
 													 const unsigned int control_value,
 													 const double       value)
   {
-		if (times.size() > 0)
-			AssertThrow(time >= times.back(),
-				ExcMessage("Schedule should be in an ascending order"));
-
-		times.push_back(time);
-		schedule_well_names.push_back(well_name);
-		control_values.push_back(control_value);
-		values.push_back(value);
+		AssertThrow(time >= last_time,
+			ExcMessage("Schedule should be in an ascending order"));
+		last_time = time;
+
+		const unsigned int idx = get_well_index(well_name);
+		RHS::WellControl control;
+		control.control_value = control_value;
+		control.value = value;
+		well_times[idx].push_back(time);
+		well_controls[idx].push_back(control);
+		n_lines++;
 	} // eom
 
 	template <int dim> unsigned int
 	Scheduler<dim>::get_well_index(const std::string &wname) const
 	{
-		// std::cout << "Well: " << wname << std::endl;
-		// std::cout << "ind: " << indexing.find(wname)->second << std::endl;
-		return indexing.find(wname)->second;
+		const auto it = indexing.find(wname);
+		AssertThrow(it != indexing.end(),
+			ExcMessage("Well " + wname + " in the schedule is not defined"));
+		return it->second;
 	}
 
 	template <int dim> std::vector<RHS::WellControl>
 	Scheduler<dim>::get_well_controls(const double time) const
 	{
-		AssertThrow(times.size() > 0, ExcMessage("Schedule is empty"));
-
-		// std::cout << schedule_well_names[0] << "aaa" << std::endl;
-		get_well_index(this->schedule_well_names[0]);
+		AssertThrow(n_lines > 0, ExcMessage("Schedule is empty"));
 
-		unsigned int n_wells = indexing.size();
+		const unsigned int n_wells = indexing.size();
 		std::vector<RHS::WellControl> controls(n_wells);
-		for (unsigned int i=0; i<times.size(); ++i)
+		for (unsigned int w=0; w<n_wells; ++w)
 		{
-			double t = this->times[i];
-			if (t > time)
-				break;
+			// last line of the well with t <= time
+			const std::vector<double> &t = well_times[w];
+			const unsigned int k =
+				std::upper_bound(t.begin(), t.end(), time) - t.begin();
+			if (k > 0)
+				controls[w] = well_controls[w][k-1];
 			else
 			{
-				unsigned int idx = get_well_index(schedule_well_names[i]);
-				controls[idx].control_value = control_values[i];
-				controls[idx].value = values[i];
-
+				controls[w].control_value = 0;
+				controls[w].value = 0;
 			}
-		}  // end loop though schedule table
+		}  // end well loop
 
 		return controls;
 	} // eom
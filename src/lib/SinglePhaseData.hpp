@@ -16,7 +16,10 @@ namespace InputData
 		~SinglePhaseData();
     virtual void read_input_file(std::string);
 		virtual void update_well_controlls(const double time);
+		// "Subsection/Entry = value" entries set after reading the input file
+		void set_parameter_overrides(const std::vector<std::string> &overrides);
 	private:
+		void apply_parameter_override(const std::string &override);
 		virtual void assign_parameters();
 		virtual void declare_parameters();
 
@@ -31,7 +34,25 @@ namespace InputData
                                       init_pressure, constant_level_set,
                                       penalty_theta;
     unsigned int                      max_fss_steps;
-
+    // width problem only around the fracture, 0 = whole mesh; 1 = the
+    // dofs of the fracture cells, every further layer adds the dofs of
+    // the cells that touch them
+    unsigned int                      width_halo_layers;
+    // multirate stepping: pressure substeps per phase-field step (maximum
+    // if the tolerance on the relative pressure change is > 0) and the
+    // phi change below which a phase-field solve may be skipped
+    unsigned int                      pressure_subcycles;
+    double                            pressure_subcycle_tolerance,
+                                      phase_field_skip_threshold;
+    // temperature substeps (maximum with a tolerance > 0) in the acid driver
+    unsigned int                      temperature_subcycles;
+    double                            temperature_subcycle_tolerance;
+    // acceleration of the fixed-stress split (FixedPointAccelerator.hpp)
+    std::string                       fss_acceleration;
+    unsigned int                      fss_acceleration_depth;
+    double                            fss_relaxation;
+
+    std::vector<std::string>      parameter_overrides;
     std::vector< RHS::Well<dim>*> wells;  // needs to be deleted in the end
 		RHS::Scheduler<dim>           schedule;
 	};
@@ -71,6 +92,12 @@ namespace InputData
       // this->prm.declare_entry("Local refinement steps", "0", Patterns::Integer(0, 100));
       this->prm.declare_entry("Adaptive steps", "0", Patterns::Integer(0, 100));
       this->prm.declare_entry("Adaptive phi value", "0", Patterns::Double(0, 1));
+      this->prm.declare_entry("Adaptive coarsening phi value", "0", Patterns::Double(0, 1));
+      this->prm.declare_entry("Adaptive refinement halo", "0", Patterns::Integer(0, 10));
+      this->prm.declare_entry("Maximum active cells", "0", Patterns::Integer(0));
+      this->prm.declare_entry("Fracture cell weight", "4", Patterns::Double(0));
+      this->prm.declare_entry("Load balancing interval", "0", Patterns::Integer(0));
+      this->prm.declare_entry("Load imbalance tolerance", "1.2", Patterns::Double(1));
       this->prm.declare_entry("Local refinement region", "",
                         Patterns::List(Patterns::Double()));
       this->prm.leave_subsection();
@@ -153,17 +180,58 @@ namespace InputData
       this->prm.declare_entry("T max", "1", Patterns::Double());
       this->prm.declare_entry("Time stepping table", "(0, 1e-5)", Patterns::Anything());
       this->prm.declare_entry("Minimum time step", "1e-9", Patterns::Double());
+      this->prm.declare_entry("Target Newton steps", "0", Patterns::Double(0));
+      this->prm.declare_entry("Target Newton contraction", "0", Patterns::Double(0, 1));
+      this->prm.declare_entry("Time step growth factor", "2", Patterns::Double(1));
+      this->prm.declare_entry("Time step cut factor", "0.1", Patterns::Double(0, 1));
+      this->prm.declare_entry("Extrapolate initial guess", "false", Patterns::Bool());
       this->prm.declare_entry("Newton tolerance", "1e-9", Patterns::Double());
       this->prm.declare_entry("Max PDS steps", "100", Patterns::Integer());
       this->prm.declare_entry("Max FSS steps", "100", Patterns::Integer());
+      this->prm.declare_entry("Linear solver forcing", "constant",
+                              Patterns::Selection("constant|eisenstat-walker"));
+      this->prm.declare_entry("Linear solver tolerance", "1e-10", Patterns::Double(0));
+      this->prm.declare_entry("Maximum forcing term", "0.1", Patterns::Double(0, 1));
+      this->prm.declare_entry("GMRES restart", "30", Patterns::Integer(1));
+      this->prm.declare_entry("Max linear iterations", "0", Patterns::Integer(0));
+      this->prm.declare_entry("Preconditioner precision", "double",
+                              Patterns::Selection("double|single"));
+      this->prm.declare_entry("Single precision fallback iterations", "200",
+                              Patterns::Integer(1));
+      this->prm.declare_entry("Single precision check iterations", "10",
+                              Patterns::Integer(0));
+      this->prm.declare_entry("FSS acceleration", "none",
+                              Patterns::Selection("none|aitken|anderson"));
+      this->prm.declare_entry("FSS acceleration depth", "5", Patterns::Integer(1));
+      this->prm.declare_entry("FSS relaxation", "1", Patterns::Double(0));
       this->prm.declare_entry("Level set constant", "0.1", Patterns::Double());
       this->prm.declare_entry("Penalty theta", "1000", Patterns::Double());
+      this->prm.declare_entry("Width halo layers", "0", Patterns::Integer(0),
+                              "0 = whole mesh, 1 = dofs of the fracture cells, "
+                              "n = n-1 more layers of cells around them");
+      this->prm.declare_entry("Pressure subcycles", "1", Patterns::Integer(1));
+      this->prm.declare_entry("Pressure subcycle tolerance", "0", Patterns::Double(0));
+      this->prm.declare_entry("Phase field skip threshold", "0", Patterns::Double(0));
+      this->prm.declare_entry("Temperature subcycles", "1", Patterns::Integer(1));
+      this->prm.declare_entry("Temperature subcycle tolerance", "0", Patterns::Double(0));
+      this->prm.declare_entry("Number of threads", "1", Patterns::Integer(1));
+      this->prm.declare_entry("AMG rebuild active set fraction", "0.05", Patterns::Double(0));
+      this->prm.declare_entry("AMG rebuild iteration factor", "2", Patterns::Double(1));
       this->prm.leave_subsection();
     }
     {
       this->prm.enter_subsection("Postprocessing");
       this->prm.declare_entry("Functions", "", Patterns::Anything());
       this->prm.declare_entry("Arguments", "", Patterns::Anything());
+      this->prm.declare_entry("Checkpoint interval", "0", Patterns::Integer(0));
+      this->prm.declare_entry("Output format", "vtu",
+                              Patterns::Selection("vtu|parallel vtu|hdf5"));
+      this->prm.declare_entry("Output interval", "1", Patterns::Integer(0));
+      this->prm.declare_entry("Output time interval", "0", Patterns::Double(0));
+      this->prm.declare_entry("Output fields", "", Patterns::Anything());
+      this->prm.declare_entry("Asynchronous output", "true", Patterns::Bool());
+      this->prm.declare_entry("Output compression", "speed",
+                              Patterns::Selection("none|speed|best|default"));
       this->prm.leave_subsection();
     }
   }  // eom
@@ -173,12 +241,45 @@ namespace InputData
   void SinglePhaseData<dim>::read_input_file(std::string file_name)
   {
     this->prm.read_input(file_name);
+    for (const auto & override : parameter_overrides)
+      apply_parameter_override(override);
     assign_parameters();
     this->compute_runtime_parameters();
     // check_input();
   }  // eom
 
 
+  template <int dim>
+  void SinglePhaseData<dim>::
+  set_parameter_overrides(const std::vector<std::string> &overrides)
+  {
+    parameter_overrides = overrides;
+  }  // eom
+
+
+  template <int dim>
+  void SinglePhaseData<dim>::
+  apply_parameter_override(const std::string &override)
+  {
+    const std::size_t eq = override.find('=');
+    AssertThrow(eq != std::string::npos,
+                ExcMessage("Parameter override without value: " + override));
+    const std::string value = Utilities::trim(override.substr(eq+1));
+    // subsections separated by '/', the entry comes last
+    std::vector<std::string> path =
+      Utilities::split_string_list(override.substr(0, eq), '/');
+    AssertThrow(path.size() > 0 && !path.back().empty(),
+                ExcMessage("Parameter override without entry: " + override));
+
+    for (unsigned int i=0; i+1<path.size(); ++i)
+      this->prm.enter_subsection(path[i]);
+    this->prm.set(path.back(), value);
+    for (unsigned int i=0; i+1<path.size(); ++i)
+      this->prm.leave_subsection();
+    this->pcout << "Parameter override: " << override << std::endl;
+  }  // eom
+
+
 	template <int dim>
 	void SinglePhaseData<dim>::assign_parameters()
 	{
@@ -189,6 +290,16 @@ namespace InputData
 	    // this->n_prerefinement_steps = this->prm.get_integer("Local refinement steps");
 	    this->n_adaptive_steps = this->prm.get_integer("Adaptive steps");
 	    this->phi_refinement_value = this->prm.get_double("Adaptive phi value");
+	    this->phi_coarsening_value = this->prm.get_double("Adaptive coarsening phi value");
+	    this->refinement_halo = this->prm.get_integer("Adaptive refinement halo");
+	    this->max_active_cells = this->prm.get_integer("Maximum active cells");
+	    this->fracture_cell_weight = this->prm.get_double("Fracture cell weight");
+	    this->load_balancing_interval = this->prm.get_integer("Load balancing interval");
+	    this->load_imbalance_tolerance = this->prm.get_double("Load imbalance tolerance");
+	    AssertThrow(this->phi_coarsening_value == 0 ||
+	                this->phi_coarsening_value > this->phi_refinement_value,
+	                ExcMessage("Adaptive coarsening phi value should be larger "
+	                           "than Adaptive phi value"));
 	    std::vector<double> tmp =
 	      Parsers::parse_string_list<double>(this->prm.get("Local refinement region"));
 	    this->local_prerefinement_region.resize(dim);
@@ -299,17 +410,58 @@ namespace InputData
 	      this->timestep_table[row[0]] = row[1];
 
 	    this->minimum_time_step = this->prm.get_double("Minimum time step");
+	    this->target_newton_steps = this->prm.get_double("Target Newton steps");
+	    this->target_newton_contraction =
+	      this->prm.get_double("Target Newton contraction");
+	    this->time_step_growth_factor = this->prm.get_double("Time step growth factor");
+	    this->time_step_cut_factor = this->prm.get_double("Time step cut factor");
+	    this->extrapolate_initial_guess = this->prm.get_bool("Extrapolate initial guess");
 	    this->newton_tolerance = this->prm.get_double("Newton tolerance");
 	    this->max_newton_iter = this->prm.get_integer("Max PDS steps");
 	    this->max_fss_steps = this->prm.get_integer("Max FSS steps");
+	    this->linear_solver_forcing = this->prm.get("Linear solver forcing");
+	    this->linear_solver_tolerance = this->prm.get_double("Linear solver tolerance");
+	    this->max_forcing_term = this->prm.get_double("Maximum forcing term");
+	    this->gmres_restart = this->prm.get_integer("GMRES restart");
+	    this->max_linear_iterations = this->prm.get_integer("Max linear iterations");
+	    this->preconditioner_precision = this->prm.get("Preconditioner precision");
+	    this->single_precision_fallback_iterations =
+	      this->prm.get_integer("Single precision fallback iterations");
+	    this->single_precision_check_iterations =
+	      this->prm.get_integer("Single precision check iterations");
+	    this->fss_acceleration = this->prm.get("FSS acceleration");
+	    this->fss_acceleration_depth = this->prm.get_integer("FSS acceleration depth");
+	    this->fss_relaxation = this->prm.get_double("FSS relaxation");
       this->constant_level_set = this->prm.get_double("Level set constant");
       AssertThrow(this->constant_level_set < this->phi_refinement_value,
         ExcMessage("Level set constant should be > phi refinement constant"));
       this->penalty_theta = this->prm.get_integer("Penalty theta");
+      this->width_halo_layers = this->prm.get_integer("Width halo layers");
+      this->pressure_subcycles = this->prm.get_integer("Pressure subcycles");
+      this->pressure_subcycle_tolerance =
+        this->prm.get_double("Pressure subcycle tolerance");
+      this->phase_field_skip_threshold =
+        this->prm.get_double("Phase field skip threshold");
+      this->temperature_subcycles = this->prm.get_integer("Temperature subcycles");
+      this->temperature_subcycle_tolerance =
+        this->prm.get_double("Temperature subcycle tolerance");
+      this->n_threads = this->prm.get_integer("Number of threads");
+      this->amg_rebuild_active_set_fraction =
+        this->prm.get_double("AMG rebuild active set fraction");
+      this->amg_rebuild_iteration_factor =
+        this->prm.get_double("AMG rebuild iteration factor");
 	    this->prm.leave_subsection();
 	  }
 	  { // Postprocessing
 	    this->prm.enter_subsection("Postprocessing");
+	    this->checkpoint_interval = this->prm.get_integer("Checkpoint interval");
+	    this->output_format = this->prm.get("Output format");
+	    this->output_compression = this->prm.get("Output compression");
+	    this->output_interval = this->prm.get_integer("Output interval");
+	    this->output_time_interval = this->prm.get_double("Output time interval");
+	    this->output_fields =
+	        Parsers::parse_string_list<std::string>(this->prm.get("Output fields"));
+	    this->asynchronous_output = this->prm.get_bool("Asynchronous output");
 	    this->postprocessing_function_names =
 	        Parsers::parse_string_list<std::string>(this->prm.get("Functions"));
 
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <deal.II/base/exceptions.h>
+#include <deal.II/base/subscriptor.h>
+#include <deal.II/lac/dynamic_sparsity_pattern.h>
+#include <deal.II/lac/solver_control.h>
+#include <deal.II/lac/sparse_ilu.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/sparsity_pattern.h>
+#include <deal.II/lac/trilinos_sparse_matrix.h>
+#include <deal.II/lac/trilinos_vector.h>
+#include <deal.II/lac/vector.h>
+
+#include <algorithm>    // std::copy
+#include <cmath>        // std::log
+
+
+namespace LinearSolvers
+{
+  using namespace dealii;
+
+  /*
+    Block Jacobi ILU(0) preconditioner stored and applied in single
+    precision: every process factorizes the coupling of its locally owned
+    rows and columns of a Trilinos matrix into a SparseILU<float>.
+    The factors take half the memory of a double ILU, and vmult converts
+    the local part of the (double) vectors on the fly, so the outer
+    Krylov solver stays in double precision. The values are copied at
+    initialize: call it again after the matrix has changed.
+   */
+  class PreconditionFloatILU : public Subscriptor
+  {
+  public:
+    PreconditionFloatILU();
+    void initialize(const TrilinosWrappers::SparseMatrix &matrix);
+    void clear();
+    bool empty() const;
+    void vmult(TrilinosWrappers::MPI::Vector       &dst,
+               const TrilinosWrappers::MPI::Vector &src) const;
+
+  private:
+    // the factors keep a pointer to the pattern
+    SparsityPattern          sparsity_pattern;
+    SparseILU<float>         ilu;
+    mutable Vector<float>    tmp_src, tmp_dst;
+    bool                     initialized;
+  };
+
+
+  inline
+  PreconditionFloatILU::PreconditionFloatILU()
+  :
+  initialized(false)
+  {}  // eom
+
+
+  inline
+  void PreconditionFloatILU::clear()
+  {
+    ilu.clear();
+    sparsity_pattern.reinit(0, 0, 0);
+    tmp_src.reinit(0);
+    tmp_dst.reinit(0);
+    initialized = false;
+  }  // eom
+
+
+  inline
+  bool PreconditionFloatILU::empty() const
+  {
+    return !initialized;
+  }  // eom
+
+
+  inline
+  void PreconditionFloatILU::initialize(const TrilinosWrappers::SparseMatrix &matrix)
+  {
+    typedef TrilinosWrappers::SparseMatrix::size_type size_type;
+    clear();
+
+    const std::pair<size_type, size_type> range = matrix.local_range();
+    const size_type n_local = range.second - range.first;
+    AssertThrow(n_local == matrix.local_size(),
+                ExcMessage("Locally owned rows must be contiguous"));
+
+    // local diagonal block
+    DynamicSparsityPattern dsp(n_local, n_local);
+    for (size_type row=range.first; row<range.second; ++row)
+      for (TrilinosWrappers::SparseMatrix::const_iterator
+           entry = matrix.begin(row); entry != matrix.end(row); ++entry)
+        if (entry->column() >= range.first && entry->column() < range.second)
+          dsp.add(row - range.first, entry->column() - range.first);
+    sparsity_pattern.copy_from(dsp);
+
+    SparseMatrix<float> local_matrix(sparsity_pattern);
+    for (size_type row=range.first; row<range.second; ++row)
+      for (TrilinosWrappers::SparseMatrix::const_iterator
+           entry = matrix.begin(row); entry != matrix.end(row); ++entry)
+        if (entry->column() >= range.first && entry->column() < range.second)
+          local_matrix.set(row - range.first, entry->column() - range.first,
+                           static_cast<float>(entry->value()));
+
+    if (n_local > 0)
+      ilu.initialize(local_matrix);
+    tmp_src.reinit(n_local);
+    tmp_dst.reinit(n_local);
+    initialized = true;
+  }  // eom
+
+
+  inline
+  void PreconditionFloatILU::vmult(TrilinosWrappers::MPI::Vector       &dst,
+                                   const TrilinosWrappers::MPI::Vector &src) const
+  {
+    Assert(!empty(), ExcNotInitialized());
+    Assert(src.local_size() == tmp_src.size(),
+           ExcDimensionMismatch(src.local_size(), tmp_src.size()));
+    if (tmp_src.size() == 0)
+      return;
+    std::copy(src.begin(), src.end(), tmp_src.begin());
+    ilu.vmult(tmp_dst, tmp_src);
+    std::copy(tmp_dst.begin(), tmp_dst.end(), dst.begin());
+  }  // eom
+
+
+  /*
+    SolverControl that gives up early when the convergence rate is too
+    slow: every check_interval steps the number of steps to reach the
+    tolerance is extrapolated from the reduction so far,
+      n = step*log(tolerance/initial)/log(value/initial),
+    and the solve fails if n exceeds max_steps. Thus a preconditioner
+    that doesn't converge within max_steps usually costs check_interval
+    steps instead of max_steps.
+   */
+  class ConvergenceRateControl : public SolverControl
+  {
+  public:
+    ConvergenceRateControl(const unsigned int max_steps,
+                           const double       tolerance,
+                           const unsigned int check_interval_);
+    virtual State check(const unsigned int step,
+                        const double       check_value);
+    // true if the solve stopped on the extrapolation
+    bool too_slow() const;
+
+  private:
+    unsigned int check_interval;
+    bool         slow;
+  };
+
+
+  inline
+  ConvergenceRateControl::ConvergenceRateControl(const unsigned int max_steps,
+                                                 const double       tolerance,
+                                                 const unsigned int check_interval_)
+  :
+  SolverControl(max_steps, tolerance),
+  check_interval(check_interval_),
+  slow(false)
+  {}  // eom
+
+
+  inline
+  SolverControl::State
+  ConvergenceRateControl::check(const unsigned int step,
+                                const double       check_value)
+  {
+    const State state = SolverControl::check(step, check_value);
+    if (state != iterate || step == 0 || check_interval == 0 ||
+        step % check_interval != 0 || initial_value() <= 0)
+      return state;
+
+    const double reduction = check_value/initial_value();
+    const double target = tolerance()/initial_value();
+    if (reduction >= 1 ||
+        step*std::log(target)/std::log(reduction) > max_steps())
+    {
+      slow = true;
+      return failure;
+    }
+    return state;
+  }  // eom
+
+
+  inline
+  bool ConvergenceRateControl::too_slow() const
+  {
+    return slow;
+  }  // eom
+
+}  // end of namespace
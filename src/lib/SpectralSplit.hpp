@@ -0,0 +1,293 @@
+#pragma once
+
+#include <deal.II/base/aligned_vector.h>
+#include <deal.II/base/tensor.h>
+#include <deal.II/base/vectorization.h>
+
+#include <algorithm>    // std::max
+#include <cmath>        // std::sqrt, std::abs
+#include <limits>       // std::numeric_limits
+#include <vector>
+
+#include <ConstitutiveModel.hpp>
+
+
+namespace ConstitutiveModel
+{
+  using namespace dealii;
+
+  /*
+    Closed form of the 2d spectral split eps = sum_i lambda_i n_i x n_i.
+    with m = tr(eps)/2, D = eps - m I, s = sqrt(D:D/2) (lambda = m +- s)
+    and N = D/s:
+      eps_plus = a I + r D,
+      a = (<lambda_1> + <lambda_2>)/2,
+      r = (<lambda_1> - <lambda_2>)/(lambda_1 - lambda_2)
+        = 1/2 + m/(2 max(s, |m|))
+    and the derivative in direction E (t = tr(E)/2, c = N:E/2)
+      d eps_plus = alpha I + beta N + r (E - t I),
+      alpha = (H_1 (t+c) + H_2 (t-c))/2,
+      beta  = (H_1 (t+c) - H_2 (t-c))/2 - r c.
+    No eigenvectors are needed. For equal eigenvalues r becomes H(m) and
+    N = 0, which yields d eps_plus = H(m) E without a special case.
+    The Heaviside function is 1 at 0 (an unstrained point is treated as in
+    tension, as the fallback of the eigenvector version did).
+    The kernels are written for double and VectorizedArray<double>.
+   */
+  namespace SpectralSplitKernels
+  {
+    template <typename Number>
+    inline Number heaviside(const Number &x)
+    {
+      const double tiny = std::numeric_limits<double>::min();
+      return 0.5 + 0.5*(x + tiny)/(std::abs(x) + tiny);
+    }  // eom
+
+
+    template <typename Number>
+    inline Number positive_part(const Number &x)
+    {
+      return 0.5*(x + std::abs(x));
+    }  // eom
+
+
+    // per-point data of the split needed for the derivatives
+    template <typename Number>
+    struct Coefficients
+    {
+      Number n00, n01;  // N = [n00 n01; n01 -n00]
+      Number h1, h2, r, h_trace;
+    };
+
+
+    template <typename Number>
+    inline void
+    split(const Number         &e00,
+          const Number         &e01,
+          const Number         &e11,
+          Number               (&eps_plus)[3],  // 00, 01, 11
+          Number               &trace_plus,
+          Coefficients<Number> &coefficients)
+    {
+      const double tiny = std::numeric_limits<double>::min();
+      const Number m = 0.5*(e00 + e11);
+      const Number d = 0.5*(e00 - e11);
+      const Number s = std::sqrt(d*d + e01*e01);
+      const Number lambda_1 = m + s, lambda_2 = m - s;
+
+      // N = D/s, zero if eps is isotropic (then D = 0)
+      const Number inv_s = 1.0/(s + tiny);
+      coefficients.n00 = d*inv_s;
+      coefficients.n01 = e01*inv_s;
+      coefficients.h1 = heaviside(lambda_1);
+      coefficients.h2 = heaviside(lambda_2);
+      coefficients.r = 0.5 + 0.5*(m + tiny)/(std::max(s, std::abs(m)) + tiny);
+      coefficients.h_trace = heaviside(2.0*m);
+
+      const Number a = 0.5*(positive_part(lambda_1) + positive_part(lambda_2));
+      eps_plus[0] = a + coefficients.r*d;
+      eps_plus[1] = coefficients.r*e01;
+      eps_plus[2] = a - coefficients.r*d;
+      trace_plus = positive_part(2.0*m);
+    }  // eom
+
+
+    template <typename Number>
+    inline void
+    split_derivative(const Coefficients<Number> &c,
+                     const Number               &E00,
+                     const Number               &E01,
+                     const Number               &E11,
+                     Number                     (&eps_plus_du)[3])
+    {
+      const Number t = 0.5*(E00 + E11);
+      const Number cn = 0.5*(c.n00*(E00 - E11)) + c.n01*E01;
+      const Number alpha = 0.5*(c.h1*(t + cn) + c.h2*(t - cn));
+      const Number beta = 0.5*(c.h1*(t + cn) - c.h2*(t - cn)) - c.r*cn;
+      eps_plus_du[0] = alpha + beta*c.n00 + c.r*(E00 - t);
+      eps_plus_du[1] = beta*c.n01 + c.r*E01;
+      eps_plus_du[2] = alpha - beta*c.n00 + c.r*(E11 - t);
+    }  // eom
+  }  // end of namespace
+
+
+  /*
+    Spectral stress split of all quadrature points of a cell.
+    evaluate() computes the split stresses of a cell and keeps the data
+    needed by derivative(), which returns the split of the stress
+    derivative in the direction eps_u (one call per dof and q point).
+    The general version calls EnergySpectralDecomposition point by point;
+    the 2d version evaluates the closed-form kernel on
+    VectorizedArray<double>::n_array_elements points at a time.
+   */
+  template <int dim>
+  class BatchedSpectralSplit
+  {
+  public:
+    void evaluate(const std::vector< Tensor<2,dim> > &strains,
+                  const double                        lame_constant,
+                  const double                        shear_modulus,
+                  std::vector< Tensor<2,dim> >       &stress_plus,
+                  std::vector< Tensor<2,dim> >       &stress_minus);
+
+    void derivative(const unsigned int   q,
+                    const Tensor<2,dim> &eps_u,
+                    Tensor<2,dim>       &sigma_u_plus,
+                    Tensor<2,dim>       &sigma_u_minus);
+
+  private:
+    std::vector< Tensor<2,dim> >     strains;
+    double                           lame_constant, shear_modulus;
+    EnergySpectralDecomposition<dim> decomposition;
+  };
+
+
+  template <int dim>
+  void BatchedSpectralSplit<dim>::
+  evaluate(const std::vector< Tensor<2,dim> > &strains_,
+           const double                        lame_constant_,
+           const double                        shear_modulus_,
+           std::vector< Tensor<2,dim> >       &stress_plus,
+           std::vector< Tensor<2,dim> >       &stress_minus)
+  {
+    strains = strains_;
+    lame_constant = lame_constant_;
+    shear_modulus = shear_modulus_;
+    for (unsigned int q=0; q<strains.size(); ++q)
+      decomposition.stress_spectral_decomposition(strains[q],
+                                                  lame_constant, shear_modulus,
+                                                  stress_plus[q], stress_minus[q]);
+  }  // eom
+
+
+  template <int dim>
+  void BatchedSpectralSplit<dim>::
+  derivative(const unsigned int   q,
+             const Tensor<2,dim> &eps_u,
+             Tensor<2,dim>       &sigma_u_plus,
+             Tensor<2,dim>       &sigma_u_minus)
+  {
+    decomposition.stress_spectral_decomposition_derivatives
+      (strains[q], eps_u, lame_constant, shear_modulus,
+       sigma_u_plus, sigma_u_minus);
+  }  // eom
+
+
+  template <>
+  class BatchedSpectralSplit<2>
+  {
+  public:
+    void evaluate(const std::vector< Tensor<2,2> > &strains,
+                  const double                      lame_constant,
+                  const double                      shear_modulus,
+                  std::vector< Tensor<2,2> >       &stress_plus,
+                  std::vector< Tensor<2,2> >       &stress_minus);
+
+    void derivative(const unsigned int q,
+                    const Tensor<2,2> &eps_u,
+                    Tensor<2,2>       &sigma_u_plus,
+                    Tensor<2,2>       &sigma_u_minus);
+
+  private:
+    // structure of arrays, one entry per batch of quadrature points
+    AlignedVector< SpectralSplitKernels::Coefficients< VectorizedArray<double> > >
+                 coefficients;
+    double       lame_constant, shear_modulus;
+  };
+
+
+  inline
+  void BatchedSpectralSplit<2>::
+  evaluate(const std::vector< Tensor<2,2> > &strains,
+           const double                      lame_constant_,
+           const double                      shear_modulus_,
+           std::vector< Tensor<2,2> >       &stress_plus,
+           std::vector< Tensor<2,2> >       &stress_minus)
+  {
+    typedef VectorizedArray<double> Number;
+    const unsigned int width = Number::n_array_elements;
+    const unsigned int n_points = strains.size();
+    const unsigned int n_batches = (n_points + width - 1)/width;
+
+    lame_constant = lame_constant_;
+    shear_modulus = shear_modulus_;
+    coefficients.resize(n_batches);
+
+    for (unsigned int b=0; b<n_batches; ++b)
+    {
+      // gather strains; the last batch is padded with zero strains
+      Number e00, e01, e11;
+      e00 = 0;
+      e01 = 0;
+      e11 = 0;
+      for (unsigned int v=0; v<width && b*width+v<n_points; ++v)
+      {
+        const Tensor<2,2> &eps = strains[b*width + v];
+        e00[v] = eps[0][0];
+        e01[v] = eps[0][1];
+        e11[v] = eps[1][1];
+      }
+
+      Number eps_plus[3], trace_plus;
+      SpectralSplitKernels::split(e00, e01, e11, eps_plus, trace_plus,
+                                  coefficients[b]);
+
+      const Number trace_minus = (e00 + e11) - trace_plus;
+      const Number p0 = lame_constant*trace_plus, m0 = lame_constant*trace_minus;
+      const double mu2 = 2*shear_modulus;
+
+      // scatter stresses
+      for (unsigned int v=0; v<width && b*width+v<n_points; ++v)
+      {
+        Tensor<2,2> &sp = stress_plus[b*width + v];
+        Tensor<2,2> &sm = stress_minus[b*width + v];
+        sp[0][0] = p0[v] + mu2*eps_plus[0][v];
+        sp[1][1] = p0[v] + mu2*eps_plus[2][v];
+        sp[0][1] = sp[1][0] = mu2*eps_plus[1][v];
+        sm[0][0] = m0[v] + mu2*(e00[v] - eps_plus[0][v]);
+        sm[1][1] = m0[v] + mu2*(e11[v] - eps_plus[2][v]);
+        sm[0][1] = sm[1][0] = mu2*(e01[v] - eps_plus[1][v]);
+      }
+    }  // end batch loop
+  }  // eom
+
+
+  inline
+  void BatchedSpectralSplit<2>::
+  derivative(const unsigned int q,
+             const Tensor<2,2> &eps_u,
+             Tensor<2,2>       &sigma_u_plus,
+             Tensor<2,2>       &sigma_u_minus)
+  {
+    const unsigned int width = VectorizedArray<double>::n_array_elements;
+    const SpectralSplitKernels::Coefficients< VectorizedArray<double> >
+      &batch = coefficients[q/width];
+    const unsigned int v = q%width;
+
+    SpectralSplitKernels::Coefficients<double> c;
+    c.n00 = batch.n00[v];
+    c.n01 = batch.n01[v];
+    c.h1 = batch.h1[v];
+    c.h2 = batch.h2[v];
+    c.r = batch.r[v];
+    c.h_trace = batch.h_trace[v];
+
+    double eps_plus_du[3];
+    SpectralSplitKernels::split_derivative(c, eps_u[0][0], eps_u[0][1],
+                                           eps_u[1][1], eps_plus_du);
+
+    const double trace_u = eps_u[0][0] + eps_u[1][1];
+    const double p0 = lame_constant*c.h_trace*trace_u;
+    const double m0 = lame_constant*trace_u - p0;
+    const double mu2 = 2*shear_modulus;
+
+    sigma_u_plus[0][0] = p0 + mu2*eps_plus_du[0];
+    sigma_u_plus[1][1] = p0 + mu2*eps_plus_du[2];
+    sigma_u_plus[0][1] = sigma_u_plus[1][0] = mu2*eps_plus_du[1];
+    sigma_u_minus[0][0] = m0 + mu2*(eps_u[0][0] - eps_plus_du[0]);
+    sigma_u_minus[1][1] = m0 + mu2*(eps_u[1][1] - eps_plus_du[2]);
+    sigma_u_minus[0][1] = sigma_u_minus[1][0] =
+      mu2*(0.5*(eps_u[0][1] + eps_u[1][0]) - eps_plus_du[1]);
+  }  // eom
+
+}  // end of namespace
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <deal.II/base/numbers.h>
+#include <deal.II/base/tensor.h>
+
+#include <ConstitutiveModel.hpp>
+#include <SpectralSplit.hpp>
+
+
+namespace ConstitutiveModel
+{
+  using namespace dealii;
+
+  /*
+    Stress split models as compile-time policies of the assembly kernels.
+    Each policy provides
+      stress     - split stresses in one point; undefined results
+                   (nans in the first time step) fall back to a simpler split
+      derivative - split of the stress derivative in direction eps_u at
+                   quadrature point q
+    Policies with batched = true evaluate all quadrature points of a cell
+    with BatchedSpectralSplit::evaluate before the point loop, and their
+    derivative reads the data stored there.
+    The id is the value of the decompose_stress parameter.
+   */
+  template <int dim>
+  struct NoSplit
+  {
+    static const int  id = 0;
+    static const bool batched = false;
+
+    static void stress(EnergySpectralDecomposition<dim> &decomposition,
+                       const Tensor<2,dim>              &strain,
+                       const double                      lame_constant,
+                       const double                      shear_modulus,
+                       Tensor<2,dim>                    &stress_plus,
+                       Tensor<2,dim>                    &stress_minus)
+    {
+      decomposition.get_stress(strain, lame_constant, shear_modulus,
+                               stress_plus);
+      stress_minus = 0;
+    }
+
+    static void derivative(EnergySpectralDecomposition<dim> &decomposition,
+                           BatchedSpectralSplit<dim>        &,
+                           const unsigned int                ,
+                           const Tensor<2,dim>              &,
+                           const Tensor<2,dim>              &eps_u,
+                           const double                      lame_constant,
+                           const double                      shear_modulus,
+                           Tensor<2,dim>                    &sigma_u_plus,
+                           Tensor<2,dim>                    &sigma_u_minus)
+    {
+      decomposition.get_stress(eps_u, lame_constant, shear_modulus,
+                               sigma_u_plus);
+      sigma_u_minus = 0;
+    }
+  };
+
+
+  template <int dim>
+  struct SimpleSplit
+  {
+    static const int  id = 1;
+    static const bool batched = false;
+
+    static void stress(EnergySpectralDecomposition<dim> &decomposition,
+                       const Tensor<2,dim>              &strain,
+                       const double                      lame_constant,
+                       const double                      shear_modulus,
+                       Tensor<2,dim>                    &stress_plus,
+                       Tensor<2,dim>                    &stress_minus)
+    {
+      decomposition.get_stress_decomposition(strain, lame_constant,
+                                             shear_modulus,
+                                             stress_plus, stress_minus);
+    }
+
+    static void derivative(EnergySpectralDecomposition<dim> &decomposition,
+                           BatchedSpectralSplit<dim>        &,
+                           const unsigned int                ,
+                           const Tensor<2,dim>              &strain,
+                           const Tensor<2,dim>              &eps_u,
+                           const double                      lame_constant,
+                           const double                      shear_modulus,
+                           Tensor<2,dim>                    &sigma_u_plus,
+                           Tensor<2,dim>                    &sigma_u_minus)
+    {
+      decomposition.get_stress_decomposition_derivatives
+        (strain, eps_u, lame_constant, shear_modulus,
+         sigma_u_plus, sigma_u_minus);
+    }
+  };
+
+
+  template <int dim>
+  struct SpectralSplit
+  {
+    static const int  id = 2;
+    static const bool batched = true;
+
+    static void stress(EnergySpectralDecomposition<dim> &decomposition,
+                       const Tensor<2,dim>              &strain,
+                       const double                      lame_constant,
+                       const double                      shear_modulus,
+                       Tensor<2,dim>                    &stress_plus,
+                       Tensor<2,dim>                    &stress_minus)
+    {
+      decomposition.stress_spectral_decomposition(strain, lame_constant,
+                                                  shear_modulus,
+                                                  stress_plus, stress_minus);
+      if (!numbers::is_finite(trace(stress_plus)))
+        decomposition.get_stress_decomposition(strain, lame_constant,
+                                               shear_modulus,
+                                               stress_plus, stress_minus);
+    }
+
+    static void derivative(EnergySpectralDecomposition<dim> &,
+                           BatchedSpectralSplit<dim>        &batched_split,
+                           const unsigned int                q,
+                           const Tensor<2,dim>              &,
+                           const Tensor<2,dim>              &eps_u,
+                           const double                      ,
+                           const double                      ,
+                           Tensor<2,dim>                    &sigma_u_plus,
+                           Tensor<2,dim>                    &sigma_u_minus)
+    {
+      batched_split.derivative(q, eps_u, sigma_u_plus, sigma_u_minus);
+    }
+  };
+
+}  // end of namespace
@@ -1,8 +1,12 @@
 #pragma once
 
 #include <deal.II/dofs/dof_handler.h>
+#include <AssemblyData.hpp>
+#include <FieldCache.hpp>
 #include <SinglePhaseData.hpp>
 
+#include <limits>       // std::numeric_limits
+
 namespace FluidSolvers
 {
   using namespace dealii;
@@ -24,13 +28,40 @@ namespace FluidSolvers
     void assemble_system(const double time_step);
     void impose_temperature_values(TrilinosWrappers::MPI::BlockVector &solid_relevant_solution);
     unsigned int solve();
+    // n_substeps steps of time_step/n_substeps, the fracture temperature
+    // imposed in each; returns the linear iterations
+    unsigned int advance(TrilinosWrappers::MPI::BlockVector &solid_relevant_solution,
+                         const double                        time_step,
+                         const unsigned int                  n_substeps);
+    // relative temperature change of the last advance per unit time
+    double change_rate() const;
 		const DoFHandler<dim> &get_dof_handler();
+    // take the cell mean of phi from the cache while it is valid
+    void set_field_cache(const Assembly::FieldCache<dim> &field_cache_);
 
 		std::vector<IndexSet> owned_partitioning, relevant_partitioning;
 		TrilinosWrappers::MPI::BlockVector solution, relevant_solution;
 		// TrilinosWrappers::MPI::BlockVector old_solution;
 
   private:
+    // per-thread data for the cell loop of assemble_system
+    struct AssemblyScratchData
+    {
+      AssemblyScratchData(const FiniteElement<dim> &fe,
+                          const Quadrature<dim>    &quadrature);
+      AssemblyScratchData(const AssemblyScratchData &scratch);
+
+      FEValues<dim>                fe_values;
+      std::vector<double>          xi;
+      std::vector< Tensor<1,dim> > grad_xi;
+      std::vector<double>          temp_values;
+    };
+
+    void local_assemble_cell(const typename DoFHandler<dim>::active_cell_iterator &,
+                             AssemblyScratchData &,
+                             Assembly::CopyData &,
+                             const double);
+
     // these guys are passed at initialization
     MPI_Comm 																	&mpi_communicator;
     parallel::distributed::Triangulation<dim> &triangulation;
@@ -41,12 +72,15 @@ namespace FluidSolvers
     // auxilary objects
 		const DoFHandler<dim>            					&dof_handler_solid;
 		const FESystem<dim> 						 					&fe_solid;
+    const Assembly::FieldCache<dim>           *field_cache;
 
     ConditionalOStream 												&pcout;
     TimerOutput 			 												&computing_timer;
 
 		FESystem<dim>                       fe;
 		double                              init_temperature;
+		// unknown before the first advance
+		double                              last_change_rate;
 		ConstraintMatrix                    constraints;
 
 		TrilinosWrappers::MPI::BlockVector  rhs_vector;
@@ -69,10 +103,12 @@ namespace FluidSolvers
     dof_handler(triangulation_),
     dof_handler_solid(dof_handler_solid_),
     fe_solid(fe_solid_),
+    field_cache(NULL),
     pcout(pcout_),
     computing_timer(computing_timer_),
     fe(FE_Q<dim>(1), 1),
-    init_temperature(0.0)
+    init_temperature(0.0),
+    last_change_rate(std::numeric_limits<double>::max())
   {}
 
   template<int dim>
@@ -82,6 +118,14 @@ namespace FluidSolvers
   }  // eom
 
 
+  template <int dim> void
+  TemperatureSolver<dim>::
+  set_field_cache(const Assembly::FieldCache<dim> &field_cache_)
+  {
+    field_cache = &field_cache_;
+  }  // eom
+
+
   template <int dim> void
 	TemperatureSolver<dim>::setup_dofs()
   {
@@ -151,20 +195,26 @@ namespace FluidSolvers
       if (!cell->is_artificial())
       {
         cell->get_dof_indices(local_dof_indices);
-        cell_solid->get_dof_indices(local_dof_indices_solid);
-        // take average of phi values
+        // take average of phi values (the cell mean equals the mean of
+        // the nodal values for linear elements)
         double phi_avg = 0;
-        double counter = 0;
-        for (unsigned int i=0; i<dofs_per_cell_solid; ++i)
+        if (field_cache != NULL && field_cache->solid_valid())
+          phi_avg = field_cache->cell_phi(cell->active_cell_index());
+        else
         {
-          const int component = fe_solid.system_to_component_index(i).first;
-          if (component == dim)
+          cell_solid->get_dof_indices(local_dof_indices_solid);
+          double counter = 0;
+          for (unsigned int i=0; i<dofs_per_cell_solid; ++i)
           {
-            phi_avg += solid_relevant_solution[local_dof_indices_solid[i]];
-            counter += 1;
+            const int component = fe_solid.system_to_component_index(i).first;
+            if (component == dim)
+            {
+              phi_avg += solid_relevant_solution[local_dof_indices_solid[i]];
+              counter += 1;
+            }
           }
+          phi_avg /= counter;
         }
-        phi_avg /= counter;
 
         for (unsigned int i=0; i<dofs_per_cell; ++i)
         {
@@ -210,79 +260,161 @@ namespace FluidSolvers
   }  // eom
 
 
+  template <int dim>
+  unsigned int
+	TemperatureSolver<dim>::
+  advance(TrilinosWrappers::MPI::BlockVector &solid_relevant_solution,
+          const double                        time_step,
+          const unsigned int                  n_substeps)
+  {
+    /*
+      Multirate: the temperature takes n_substeps steps inside one
+      phase-field step with the phase field frozen at the end of the
+      step
+     */
+    Assert(n_substeps > 0, ExcInternalError());
+    TrilinosWrappers::MPI::BlockVector increment(solution);
+    const double substep = time_step/n_substeps;
+    unsigned int n_iterations = 0;
+    for (unsigned int s=0; s<n_substeps; ++s)
+    {
+      impose_temperature_values(solid_relevant_solution);
+      assemble_system(substep);
+      n_iterations += solve();
+      relevant_solution = solution;
+    }
+
+    increment -= solution;
+    const double norm = solution.l2_norm();
+    last_change_rate = (norm > 0 && time_step > 0) ?
+                       increment.l2_norm()/norm/time_step : 0;
+    return n_iterations;
+  }  // eom
+
+
+  template <int dim>
+  double
+	TemperatureSolver<dim>::change_rate() const
+  {
+    return last_change_rate;
+  }  // eom
+
+
   template <int dim> void
 	TemperatureSolver<dim>::assemble_system(const double time_step)
   {
     computing_timer.enter_section("Assemble temperature system");
 
   	const QGauss<dim> quadrature_formula(fe.degree+2);
-  	FEValues<dim> fe_values(fe, quadrature_formula,
-                          	update_values | update_gradients |
-                          	update_JxW_values);
-		const FEValuesExtractors::Scalar temperature(0);
-
-    const unsigned int dofs_per_cell = fe.dofs_per_cell;
-	  const unsigned int n_q_points    = quadrature_formula.size();
-
-	  FullMatrix<double>           local_matrix(dofs_per_cell, dofs_per_cell);
-	  Vector<double>               local_rhs(dofs_per_cell);
-		std::vector<double>  				 xi(dofs_per_cell);
-  	std::vector< Tensor<1,dim> > grad_xi(dofs_per_cell);
-  	std::vector<double>  				 temp_values(n_q_points);
-
-  	std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
+    typedef typename DoFHandler<dim>::active_cell_iterator cell_iterator;
 
     relevant_solution = solution;
 		system_matrix = 0;
 		rhs_vector = 0;
 
-    const double diffusivity = 1;
+    WorkStream::
+      run(Assembly::begin_owned(dof_handler),
+          Assembly::end_owned(dof_handler),
+          [this, time_step](const cell_iterator &cell,
+                            AssemblyScratchData &scratch,
+                            Assembly::CopyData  &copy_data)
+          {
+            this->local_assemble_cell(cell, scratch, copy_data, time_step);
+          },
+          [this](const Assembly::CopyData &copy_data)
+          {
+            constraints.distribute_local_to_global(copy_data.local_matrix,
+                                                   copy_data.local_rhs,
+                                                   copy_data.local_dof_indices,
+                                                   system_matrix, rhs_vector);
+          },
+          AssemblyScratchData(fe, quadrature_formula),
+          Assembly::CopyData(fe.dofs_per_cell));
 
-	  typename DoFHandler<dim>::active_cell_iterator
-		  cell = dof_handler.begin_active(),
-		  endc = dof_handler.end();
+    system_matrix.compress(VectorOperation::add);
+    rhs_vector.compress(VectorOperation::add);
 
-    for (; cell!=endc; ++cell)
-      if (cell->is_locally_owned())
-      {
-				local_matrix = 0;
-				local_rhs = 0;
+		computing_timer.exit_section();
+  }  // eom
 
-				fe_values.reinit(cell);
 
-        fe_values[temperature].get_function_values(relevant_solution,
-                                                   temp_values);
+  template <int dim>
+  TemperatureSolver<dim>::AssemblyScratchData::
+  AssemblyScratchData(const FiniteElement<dim> &fe,
+                      const Quadrature<dim>    &quadrature)
+  :
+  fe_values(fe, quadrature,
+            update_values | update_gradients |
+            update_JxW_values),
+  xi(fe.dofs_per_cell),
+  grad_xi(fe.dofs_per_cell),
+  temp_values(quadrature.size())
+  {}  // eom
 
-				for (unsigned int q=0; q<n_q_points; ++q)
-        {
-          // compute shape functions
-          for (unsigned int k=0; k<dofs_per_cell; ++k)
-          {
-            xi[k] = fe_values[temperature].value(k, q);
-            grad_xi[k] = fe_values[temperature].gradient(k, q);
-          }  // end k loop
 
-	        for (unsigned int i=0; i<dofs_per_cell; ++i)
-          {
-            for (unsigned int j=0; j<dofs_per_cell; ++j)
-              local_matrix(i, j) +=
-                (xi[j]/time_step*xi[i]
-                 + diffusivity*grad_xi[j]*grad_xi[i])*fe_values.JxW(q);
+  template <int dim>
+  TemperatureSolver<dim>::AssemblyScratchData::
+  AssemblyScratchData(const AssemblyScratchData &scratch)
+  :
+  fe_values(scratch.fe_values.get_fe(),
+            scratch.fe_values.get_quadrature(),
+            scratch.fe_values.get_update_flags()),
+  xi(scratch.xi),
+  grad_xi(scratch.grad_xi),
+  temp_values(scratch.temp_values)
+  {}  // eom
 
-            local_rhs[i] += temp_values[q]/time_step*xi[i]*fe_values.JxW(q);
-          }
-        }  // end q point loop
 
-	      cell->get_dof_indices(local_dof_indices);
-	      constraints.distribute_local_to_global(local_matrix, local_rhs,
-	                                             local_dof_indices,
-	                                             system_matrix, rhs_vector);
-      }  // end cell loop
+  template <int dim> void
+	TemperatureSolver<dim>::
+  local_assemble_cell(const typename DoFHandler<dim>::active_cell_iterator &cell,
+                      AssemblyScratchData &scratch,
+                      Assembly::CopyData  &copy_data,
+                      const double         time_step)
+  {
+    FEValues<dim> &fe_values = scratch.fe_values;
+		const FEValuesExtractors::Scalar temperature(0);
 
-    system_matrix.compress(VectorOperation::add);
-    rhs_vector.compress(VectorOperation::add);
+    const unsigned int dofs_per_cell = fe.dofs_per_cell;
+	  const unsigned int n_q_points    = fe_values.n_quadrature_points;
 
-		computing_timer.exit_section();
+	  FullMatrix<double>           &local_matrix = copy_data.local_matrix;
+	  Vector<double>               &local_rhs = copy_data.local_rhs;
+		std::vector<double>  				 &xi = scratch.xi;
+  	std::vector< Tensor<1,dim> > &grad_xi = scratch.grad_xi;
+  	std::vector<double>  				 &temp_values = scratch.temp_values;
+
+    const double diffusivity = 1;
+
+		local_matrix = 0;
+		local_rhs = 0;
+
+		fe_values.reinit(cell);
+
+    fe_values[temperature].get_function_values(relevant_solution,
+                                               temp_values);
+
+		for (unsigned int q=0; q<n_q_points; ++q)
+    {
+      // compute shape functions
+      for (unsigned int k=0; k<dofs_per_cell; ++k)
+      {
+        xi[k] = fe_values[temperature].value(k, q);
+        grad_xi[k] = fe_values[temperature].gradient(k, q);
+      }  // end k loop
+
+      for (unsigned int i=0; i<dofs_per_cell; ++i)
+      {
+        for (unsigned int j=0; j<dofs_per_cell; ++j)
+          local_matrix(i, j) +=
+            (xi[j]/time_step*xi[i]
+             + diffusivity*grad_xi[j]*grad_xi[i])*fe_values.JxW(q);
+
+        local_rhs[i] += temp_values[q]/time_step*xi[i]*fe_values.JxW(q);
+      }
+    }  // end q point loop
+
+    cell->get_dof_indices(copy_data.local_dof_indices);
   }  // eom
 
 	template <int dim>
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <deal.II/base/conditional_ostream.h>
+#include <deal.II/lac/trilinos_block_vector.h>
+
+#include <algorithm>    // std::min, std::max
+#include <cmath>        // std::pow
+#include <limits>       // std::numeric_limits
+
+
+namespace TimeStepping
+{
+  using namespace dealii;
+
+  /*
+    Time-step control of the drivers.
+    The Time stepping table gives the largest step. After a converged
+    step the next one is scaled with target/n, n = the largest number
+    of Newton steps of one Newton solve in the step (the FSS drivers
+    run one solve per FSS iteration). With a target contraction the
+    factor is also limited by target/rate, rate = the worst mean
+    residual reduction per Newton step of the solves:
+    (r_last/r_first)^(1/(m-1)) over the m residuals of a solve.
+    The factor is limited to [1/growth, growth]; with both targets = 0
+    the step only grows back to the table value by the growth factor
+    after a cut. A failed step is repeated with the step times the cut
+    factor. Rejected attempts and their Newton steps are counted as
+    wasted work.
+    Drivers call begin_attempt at the start of every attempt,
+    newton_residual for each residual norm of a Newton solve and
+    end_solve after it.
+
+    initial_guess extrapolates the displacement (block 0) linearly from the
+    last two time steps; the phase field starts from the old value, which
+    keeps the irreversibility constraint satisfied.
+   */
+  class TimeStepController
+  {
+  public:
+    TimeStepController();
+    void set_parameters(const double target_newton_steps_,
+                        const double target_contraction_,
+                        const double growth_factor_,
+                        const double cut_factor_,
+                        const bool   extrapolate_);
+    // step for this time level; table_time_step is the maximum
+    double next_time_step(const double table_time_step);
+    // statistics of the Newton solves of an attempt
+    void begin_attempt();
+    void newton_residual(const double residual_norm);
+    void end_solve(const unsigned int newton_steps);
+    // converged step
+    void accept(const double time_step);
+    // failed attempt, returns the step of the next attempt
+    double reject(const double       time_step,
+                  const unsigned int wasted_newton_steps);
+    void initial_guess(TrilinosWrappers::MPI::BlockVector       &solution,
+                       const TrilinosWrappers::MPI::BlockVector &old_solution,
+                       const TrilinosWrappers::MPI::BlockVector &old_old_solution,
+                       const double                              time_step,
+                       const double                              old_time_step) const;
+    void print_statistics(ConditionalOStream &pcout) const;
+    // checkpointed state: step proposed for the next time level
+    // (0 if nothing was proposed yet)
+    double proposed_time_step() const;
+    void restore(const double proposed_time_step_);
+
+  private:
+    double       target_newton_steps, target_contraction,
+                 growth_factor, cut_factor;
+    bool         extrapolate;
+    // step proposed by the last accepted or rejected step
+    double       controlled_time_step;
+    // current solve: first and last residual norm, number of residuals
+    double       first_residual, last_residual;
+    unsigned int n_residuals;
+    // current attempt: most Newton steps of a solve, worst contraction
+    unsigned int max_solve_newton_steps;
+    double       worst_contraction;
+    unsigned int n_accepted, n_rejected, n_wasted_newton_steps;
+  };
+
+
+  inline
+  TimeStepController::TimeStepController()
+  :
+  target_newton_steps(0),
+  target_contraction(0),
+  growth_factor(2),
+  cut_factor(0.1),
+  extrapolate(false),
+  controlled_time_step(std::numeric_limits<double>::max()),
+  first_residual(0),
+  last_residual(0),
+  n_residuals(0),
+  max_solve_newton_steps(0),
+  worst_contraction(0),
+  n_accepted(0),
+  n_rejected(0),
+  n_wasted_newton_steps(0)
+  {}  // eom
+
+
+  inline
+  void TimeStepController::set_parameters(const double target_newton_steps_,
+                                          const double target_contraction_,
+                                          const double growth_factor_,
+                                          const double cut_factor_,
+                                          const bool   extrapolate_)
+  {
+    target_newton_steps = target_newton_steps_;
+    target_contraction = target_contraction_;
+    growth_factor = growth_factor_;
+    cut_factor = cut_factor_;
+    extrapolate = extrapolate_;
+  }  // eom
+
+
+  inline
+  double TimeStepController::next_time_step(const double table_time_step)
+  {
+    controlled_time_step = std::min(controlled_time_step, table_time_step);
+    return controlled_time_step;
+  }  // eom
+
+
+  inline
+  void TimeStepController::begin_attempt()
+  {
+    n_residuals = 0;
+    max_solve_newton_steps = 0;
+    worst_contraction = 0;
+  }  // eom
+
+
+  inline
+  void TimeStepController::newton_residual(const double residual_norm)
+  {
+    if (n_residuals == 0)
+      first_residual = residual_norm;
+    last_residual = residual_norm;
+    n_residuals++;
+  }  // eom
+
+
+  inline
+  void TimeStepController::end_solve(const unsigned int newton_steps)
+  {
+    max_solve_newton_steps = std::max(max_solve_newton_steps, newton_steps);
+    if (n_residuals > 1 && first_residual > 0)
+      worst_contraction =
+        std::max(worst_contraction,
+                 std::pow(last_residual/first_residual, 1./(n_residuals - 1)));
+    n_residuals = 0;
+  }  // eom
+
+
+  inline
+  void TimeStepController::accept(const double time_step)
+  {
+    n_accepted++;
+    double factor = growth_factor;
+    if (target_newton_steps > 0 && max_solve_newton_steps > 0)
+      factor = std::min(factor, target_newton_steps/max_solve_newton_steps);
+    if (target_contraction > 0 && worst_contraction > 0)
+      factor = std::min(factor, target_contraction/worst_contraction);
+    factor = std::max(factor, 1./growth_factor);
+    controlled_time_step = time_step*factor;
+  }  // eom
+
+
+  inline
+  double TimeStepController::reject(const double       time_step,
+                                    const unsigned int wasted_newton_steps)
+  {
+    n_rejected++;
+    n_wasted_newton_steps += wasted_newton_steps;
+    controlled_time_step = time_step*cut_factor;
+    return controlled_time_step;
+  }  // eom
+
+
+  inline
+  void TimeStepController::
+  initial_guess(TrilinosWrappers::MPI::BlockVector       &solution,
+                const TrilinosWrappers::MPI::BlockVector &old_solution,
+                const TrilinosWrappers::MPI::BlockVector &old_old_solution,
+                const double                              time_step,
+                const double                              old_time_step) const
+  {
+    solution = old_solution;
+    if (!extrapolate || old_time_step <= 0)
+      return;
+    // u = (1+r)*u_old - r*u_old_old; old vectors are ghosted, so the
+    // update goes through an owned copy
+    const double ratio = time_step/old_time_step;
+    TrilinosWrappers::MPI::BlockVector owned_old_old(solution);
+    owned_old_old = old_old_solution;
+    solution.block(0).sadd(1 + ratio, -ratio, owned_old_old.block(0));
+  }  // eom
+
+
+  inline
+  double TimeStepController::proposed_time_step() const
+  {
+    if (controlled_time_step == std::numeric_limits<double>::max())
+      return 0;
+    return controlled_time_step;
+  }  // eom
+
+
+  inline
+  void TimeStepController::restore(const double proposed_time_step_)
+  {
+    // old checkpoints carry no proposed step
+    if (proposed_time_step_ > 0)
+      controlled_time_step = proposed_time_step_;
+  }  // eom
+
+
+  inline
+  void TimeStepController::print_statistics(ConditionalOStream &pcout) const
+  {
+    pcout << "Time steps: " << n_accepted << " accepted, "
+          << n_rejected << " rejected ("
+          << n_wasted_newton_steps << " wasted Newton steps)"
+          << std::endl;
+  }  // eom
+
+}  // end of namespace
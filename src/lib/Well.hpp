@@ -2,6 +2,8 @@
 
 #include<cmath>
 
+#include <PointLocator.hpp>
+
 namespace RHS
 {
 	using namespace dealii;
@@ -37,9 +39,19 @@ namespace RHS
 
     void set_location_radius(const double lr);
 
+		// source per unit flow rate (value = flow rate * source_density)
+		double source_density(const Point<dim> &p) const;
+		// the source vanishes (or is negligible) farther than support_radius
+		// from source_center
+		const Point<dim> & source_center() const;
+		double support_radius() const;
+		double get_flow_rate() const;
+
 		// set_control(const double value, const int control);
-		void locate(const DoFHandler<dim>  &dof_handler,
-								MPI_Comm 				       &mpi_communicator);
+		// put the source into the given cell center if this process owns
+		// the cell closest to the well (see locate_wells)
+		void locate(const Point<dim> &cell_center,
+								const bool        owner);
 
 		void set_control(const WellControl &control);
 
@@ -77,61 +89,20 @@ namespace RHS
 	}  // eom
 
 	template <int dim> void
-	Well<dim>::locate(const DoFHandler<dim>  &dof_handler,
-										MPI_Comm 				 			 &mpi_communicator)
-	{ // in this function we find the coordinates of the cell center that
-		// is closest to the well location
-		double min_distance = std::numeric_limits<double>::max();
-		Point<dim> best_cell(std::numeric_limits<double>::max(),
-												 std::numeric_limits<double>::max());
-
-		typename DoFHandler<dim>::active_cell_iterator
-	    cell = dof_handler.begin_active(),
-	    endc = dof_handler.end();
-
-	  for (; cell != endc; ++cell)
-      if (cell->is_locally_owned())
-			{
-				auto const &p = cell->center();
-				const double d = true_location.distance(p);
-				if (d < min_distance)
-				{
-					min_distance = d;
-					best_cell = p;
-				}
-			}  // end cell loop
-
-    const double overall_min_distance =
-			Utilities::MPI::min(min_distance, mpi_communicator);
-
+	Well<dim>::locate(const Point<dim> &cell_center,
+										const bool        owner)
+	{
 		/* several processors can actually have cells at the same distance from
-			the true source location.
-			The following trick should let only one processor (with the minimum number)
-			to set the source.
-			if we sum the processor number and minimum distance this should be enough
-			to uniquely set the well
+			the true source location. Only one of them (the one with the
+			minimum number) sets the source, the others place it far away
 		*/
-		const unsigned int this_mpi_process =
-			Utilities::MPI::this_mpi_process(mpi_communicator);
-
-		const double magic_number =
-			min_distance + static_cast<double>(this_mpi_process);
-
-		const double min_magic_number =
-			Utilities::MPI::min(magic_number, mpi_communicator);
-
 		const	double large_num = std::numeric_limits<double>::max();
 
-		if (min_distance == overall_min_distance &&
-				magic_number == min_magic_number)
-		{
-			closest_cell_center = best_cell;
-		}
+		if (owner)
+			closest_cell_center = cell_center;
 		else  // assign to some cell far away
-		{
 			for (int i=0; i<dim; ++i)
 				closest_cell_center[i] = large_num;
-		}
 
 		location_radius = 1e-10;
 
@@ -140,7 +111,75 @@ namespace RHS
 							<< ")"
 							<< std::endl;
     located = true;
-			// std::cout << "loc " << loc << std::endl;
+	}  // eom
+
+
+	template <int dim> void
+	locate_wells(std::vector<Well<dim>*>   &wells,
+							 Mesher::PointLocator<dim> &point_locator,
+							 MPI_Comm                  &mpi_communicator)
+	{ // find the coordinates of the cell centers that are closest to the
+		// well locations: one search and one reduction for all wells
+		std::vector< Point<dim> > points(wells.size());
+		for (unsigned int w=0; w<wells.size(); ++w)
+			points[w] = wells[w]->true_location;
+
+		std::vector<typename Mesher::PointLocator<dim>::CellIterator> cells;
+		std::vector<double> min_distances;
+		point_locator.closest_cell_centers(points, cells, min_distances);
+		const std::vector<bool> owners =
+			Mesher::closest_owners(min_distances, mpi_communicator);
+
+		for (unsigned int w=0; w<wells.size(); ++w)
+			wells[w]->locate(owners[w] ? cells[w]->center() : points[w],
+											 owners[w]);
+	}  // eom
+
+
+	template <int dim>
+	double Well<dim>::source_density(const Point<dim> &p) const
+  {
+    if (located)
+    {
+      if (closest_cell_center.distance(p) < location_radius)
+        return 1.0;
+      else
+        return 0.0;
+    }
+    else
+    {
+      // This is a gaussian source
+      // intensity of gauss spot
+      const double I = 2.0/(PI*location_radius*location_radius);
+      const double r = true_location.distance(p);
+      return I*std::exp(-2.0*r*r/(location_radius*location_radius));
+    }
+	}  // eom
+
+
+	template <int dim>
+	const Point<dim> & Well<dim>::source_center() const
+  {
+    if (located)
+      return closest_cell_center;
+    return true_location;
+	}  // eom
+
+
+	template <int dim>
+	double Well<dim>::support_radius() const
+  {
+    if (located)
+      return location_radius;
+    // exp(-2 r^2/R^2) < 1e-16 beyond r = 4.3 R
+    return 4.3*location_radius;
+	}  // eom
+
+
+	template <int dim>
+	double Well<dim>::get_flow_rate() const
+  {
+    return flow_rate;
 	}  // eom
 
 
@@ -149,23 +188,7 @@ namespace RHS
 													const unsigned int component) const
   {
 		if (component == 0)
-		{
-      if (located)
-      {
-        if (closest_cell_center.distance(p) < location_radius)
-          return flow_rate;
-        else
-          return 0.0;
-      }
-      else
-      {
-        // This is a gaussian source
-        // intensity of gauss spot
-        const double I = 2*flow_rate/(PI*location_radius*location_radius);
-        const double r = true_location.distance(p);
-        return I*std::exp(-2.0*r*r/(location_radius*location_radius));
-      }
-		}
+			return flow_rate*source_density(p);
 		else
 			return 0.0;
 	}  // eom
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <deal.II/base/quadrature.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/fe/fe_values.h>
+
+#include <algorithm>    // std::fill
+#include <vector>
+
+#include <Well.hpp>
+
+
+namespace RHS
+{
+  using namespace dealii;
+
+  /*
+    Well source terms resolved on the mesh: for every locally owned cell the
+    list of (well, quadrature point, source per unit rate) with a nonzero
+    source, so that the pressure assembly evaluates
+      source(q) = sum over the entries of the cell of rate(well)*weight
+    instead of calling Well::value for every well in every quadrature point.
+    The weights only depend on the mesh and the well locations; the rates
+    are taken from the wells at assembly time (schedule changes don't need
+    a rebuild). clear() after mesh changes and after relocating the wells.
+    Entries are stored in CSR format, cells indexed with
+    cell->active_cell_index().
+   */
+  template <int dim>
+  class WellSources
+  {
+  public:
+    struct Entry
+    {
+      unsigned int well, q_point;
+      double       weight;
+    };
+
+    WellSources();
+    void clear();
+    bool is_initialized() const;
+    void reinit(const DoFHandler<dim>          &dof_handler,
+                const Quadrature<dim>          &quadrature,
+                const std::vector<Well<dim>*>  &wells);
+
+    bool has_sources(const unsigned int cell_index) const;
+    // source values in the quadrature points of the cell with the current
+    // well rates
+    void get_source_values(const unsigned int             cell_index,
+                           const std::vector<Well<dim>*> &wells,
+                           std::vector<double>           &values) const;
+
+  private:
+    bool                      initialized;
+    std::vector<unsigned int> offsets;
+    std::vector<Entry>        entries;
+  };
+
+
+  template <int dim>
+  WellSources<dim>::WellSources()
+  :
+  initialized(false)
+  {}  // eom
+
+
+  template <int dim>
+  void WellSources<dim>::clear()
+  {
+    initialized = false;
+    offsets.clear();
+    entries.clear();
+  }  // eom
+
+
+  template <int dim>
+  bool WellSources<dim>::is_initialized() const
+  {
+    return initialized;
+  }  // eom
+
+
+  template <int dim>
+  void WellSources<dim>::reinit(const DoFHandler<dim>          &dof_handler,
+                                const Quadrature<dim>          &quadrature,
+                                const std::vector<Well<dim>*>  &wells)
+  {
+    clear();
+    const unsigned int n_cells = dof_handler.get_triangulation().n_active_cells();
+    offsets.assign(n_cells + 1, 0);
+
+    FEValues<dim> fe_values(dof_handler.get_fe(), quadrature,
+                            update_quadrature_points);
+    const unsigned int n_q_points = quadrature.size();
+
+    // active cells are visited in the order of their index
+    typename DoFHandler<dim>::active_cell_iterator
+      cell = dof_handler.begin_active(),
+      endc = dof_handler.end();
+    for (; cell!=endc; ++cell)
+    {
+      const unsigned int c = cell->active_cell_index();
+      offsets[c] = entries.size();
+      if (!cell->is_locally_owned())
+        continue;
+
+      bool values_computed = false;
+      for (unsigned int w=0; w<wells.size(); ++w)
+      {
+        // skip cells outside of the support of the well
+        const double reach = wells[w]->support_radius() + 0.5*cell->diameter();
+        if (cell->center().distance(wells[w]->source_center()) > reach)
+          continue;
+
+        if (!values_computed)
+        {
+          fe_values.reinit(cell);
+          values_computed = true;
+        }
+        for (unsigned int q=0; q<n_q_points; ++q)
+        {
+          const double weight =
+            wells[w]->source_density(fe_values.quadrature_point(q));
+          if (weight != 0)
+          {
+            const Entry entry = {w, q, weight};
+            entries.push_back(entry);
+          }
+        }
+      }  // end well loop
+    }  // end cell loop
+
+    offsets[n_cells] = entries.size();
+
+    initialized = true;
+  }  // eom
+
+
+  template <int dim>
+  inline
+  bool WellSources<dim>::has_sources(const unsigned int cell_index) const
+  {
+    return offsets[cell_index+1] > offsets[cell_index];
+  }  // eom
+
+
+  template <int dim>
+  inline
+  void WellSources<dim>::
+  get_source_values(const unsigned int             cell_index,
+                    const std::vector<Well<dim>*> &wells,
+                    std::vector<double>           &values) const
+  {
+    std::fill(values.begin(), values.end(), 0.0);
+    for (unsigned int e=offsets[cell_index]; e<offsets[cell_index+1]; ++e)
+      values[entries[e].q_point] +=
+        wells[entries[e].well]->get_flow_rate()*entries[e].weight;
+  }  // eom
+
+}  // end of namespace
@@ -5,9 +5,18 @@
 #include <deal.II/fe/fe_system.h>
 #include <deal.II/base/timer.h>
 #include <deal.II/lac/constraint_matrix.h>
+#include <deal.II/lac/trilinos_sparse_matrix.h>
+#include <deal.II/lac/trilinos_sparsity_pattern.h>
+#include <deal.II/lac/trilinos_vector.h>
+
+#include <algorithm>    // std::sort, std::unique
+#include <vector>
 // custom modules
+#include <AssemblyData.hpp>
+#include <FieldCache.hpp>
 #include <SinglePhaseData.hpp>
 #include <PhaseFieldSolver.hpp>
+#include <ScalarSetupCache.hpp>
 
 /*
   This class computes the fracture using the strategy explained in:
@@ -20,6 +29,16 @@
 
   For the level set calculation we use the Formulation 4.
 
+  With "Width halo layers" > 0 the width problem is only assembled and
+  solved around the fracture: layer 1 are the dofs of the fracture cells
+  (no halo), every further layer adds the dofs of the cells that touch
+  the previous ones. The dofs of the assembled cells are numbered
+  consecutively over the processes, so the matrix, the vectors and the
+  AMG of the system only have the size of the subdomain. The solution
+  is copied back into the vectors of the whole mesh, so the width can be
+  evaluated on any cell (zero away from the fracture). The subdomain is
+  only rebuilt when the fracture cells change.
+
   A similar code for material ids for the fracture and reservoir domains +
   crack boundary integral are explained in step-46 of the deal.ii tutorial.
  */
@@ -49,6 +68,10 @@ namespace PhaseField
                          &relevant_solution_solid);
     unsigned int solve_system();
     const DoFHandler<dim> & get_dof_handler();
+    // take the phase field of the cell from the cache while it is valid
+    void set_field_cache(const Assembly::FieldCache<dim> &field_cache_);
+    // share index sets, constraints and sparsity with the pressure solver
+    void set_setup_cache(DofUtilities::ScalarSetupCache<dim> &setup_cache_);
 
   // private:
   private:
@@ -58,6 +81,46 @@ namespace PhaseField
     cell_in_reservoir (const typename DoFHandler<dim>::cell_iterator &cell);
     static bool cell_in_fracture(const std::vector<double> &phi_values,
                                  const double level_set_value);
+    bool restricted() const;
+    bool cell_in_subdomain(const typename DoFHandler<dim>::active_cell_iterator &cell) const;
+    // recompute the dofs of the width subdomain if the fracture cells
+    // have changed, returns true if so
+    bool update_subdomain(const TrilinosWrappers::MPI::BlockVector
+                          &relevant_solution_solid);
+    // hanging nodes and boundary
+    void make_constraints();
+    // matrix of the whole mesh
+    void setup_system();
+    // numbering, constraints and matrix of the subdomain system
+    void setup_subdomain_system();
+    // subdomain numbers of the dofs of an assembled cell
+    void get_subdomain_dof_indices(const typename DoFHandler<dim>::active_cell_iterator &cell,
+                                   std::vector<types::global_dof_index>               &indices) const;
+    unsigned int solve_cg(const TrilinosWrappers::SparseMatrix &matrix,
+                          TrilinosWrappers::MPI::Vector        &x,
+                          const TrilinosWrappers::MPI::Vector  &rhs);
+
+    // per-thread data for the cell loop of assemble_system
+    struct AssemblyScratchData
+    {
+      AssemblyScratchData(const FiniteElement<dim> &fe,
+                          const FiniteElement<dim> &fe_solid);
+      AssemblyScratchData(const AssemblyScratchData &scratch);
+
+      FEValues<dim>                 fe_values, fe_values_solid,
+                                    fe_values_neighbor_solid;
+      FEFaceValues<dim>             fe_face_values, fe_face_values_solid;
+      std::vector<double>           xi;
+      std::vector< Tensor<1,dim> >  grad_xi;
+      std::vector<double>           phi_values;
+      std::vector< Tensor<1,dim> >  u_values, grad_phi_values;
+      std::vector<double>           phi_values_neighbor;
+    };
+
+    void local_assemble_cell(const typename DoFHandler<dim>::active_cell_iterator &,
+                             AssemblyScratchData &,
+                             Assembly::CopyData &,
+                             const TrilinosWrappers::MPI::BlockVector &);
 
     // Fields
   public:
@@ -71,12 +134,30 @@ namespace PhaseField
     parallel::distributed::Triangulation<dim> &triangulation;
     DoFHandler<dim>                           dof_handler;
     const DoFHandler<dim>                     &dof_handler_solid;
+    const Assembly::FieldCache<dim>           *field_cache;
+    DofUtilities::ScalarSetupCache<dim>       *setup_cache;
     const InputData::SinglePhaseData<dim>     &data;
 		FE_Q<dim>                                 fe;
 		ConditionalOStream 										    &pcout;
 		TimerOutput 			 										    &computing_timer;
 
 		ConstraintMatrix                      constraints;
+    // subdomain of the width problem: locally relevant dofs solved for
+    IndexSet                              subdomain_dofs;
+    // marks while the subdomain is spread, then the subdomain number + 1
+    // of the locally relevant dofs (0 = not in the subdomain system)
+    TrilinosWrappers::MPI::Vector         subdomain_marks, relevant_subdomain_marks;
+    bool                                  subdomain_initialized;
+    // fracture cells of the last update (by active cell index)
+    std::vector<char>                     fracture_cells;
+    // locally owned cells that are assembled
+    std::vector<typename DoFHandler<dim>::active_cell_iterator> subdomain_cells;
+    // owned dofs of the subdomain system in the order of their numbers
+    std::vector<types::global_dof_index>  owned_subdomain_dofs;
+    IndexSet                              subdomain_owned, subdomain_relevant;
+    ConstraintMatrix                      subdomain_constraints;
+    TrilinosWrappers::SparseMatrix        subdomain_matrix;
+    TrilinosWrappers::MPI::Vector         subdomain_rhs, subdomain_solution;
     enum {reservoir_domain_id, fracture_domain_id};
   }; // eod
 
@@ -93,11 +174,14 @@ namespace PhaseField
     triangulation(triangulation_),
     dof_handler(triangulation_),
     dof_handler_solid(dof_handler_solid_),
+    field_cache(NULL),
+    setup_cache(NULL),
     data(data_),
     // fe(FE_Q<dim>(1), 1), // one linear width component
     fe(1),
     pcout(pcout_),
-    computing_timer(computing_timer_)
+    computing_timer(computing_timer_),
+    subdomain_initialized(false)
   {}  // eom
 
 
@@ -108,51 +192,72 @@ namespace PhaseField
 	}  // eom
 
 
+	template <int dim> void
+	WidthSolver<dim>::
+	set_field_cache(const Assembly::FieldCache<dim> &field_cache_)
+	{
+		field_cache = &field_cache_;
+	}  // eom
+
+
+	template <int dim> void
+	WidthSolver<dim>::
+	set_setup_cache(DofUtilities::ScalarSetupCache<dim> &setup_cache_)
+	{
+		setup_cache = &setup_cache_;
+	}  // eom
+
+
 	template <int dim> void
 	WidthSolver<dim>::setup_dofs()
 	{
   	computing_timer.enter_section("Setup width system");
     dof_handler.distribute_dofs(fe);
 
-		IndexSet locally_owned_dofs, locally_relevant_dofs;
-		locally_owned_dofs = dof_handler.locally_owned_dofs();
-    DoFTools::extract_locally_relevant_dofs(dof_handler,
-                                            locally_relevant_dofs);
-
-		owned_partitioning.clear();
-		relevant_partitioning.clear();
-		owned_partitioning.push_back(locally_owned_dofs);
-		relevant_partitioning.push_back(locally_relevant_dofs);
-
-		{ // Constraints
-			// only hanging nodes
-      // make constant pressure boundary conditions
-			constraints.clear();
-			constraints.reinit(locally_relevant_dofs);
-	    DoFTools::make_hanging_node_constraints(dof_handler,
-                                              constraints);
-      // const FEValuesExtractors::Scalar pressure_mask(0);
-      const auto & boundary_ids = triangulation.get_boundary_ids();
-      for (unsigned int i=0; i<boundary_ids.size(); i++)
-        VectorTools::interpolate_boundary_values
-          (dof_handler, boundary_ids[i],
-           ConstantFunction<dim>(0.0, 1),
-           constraints);
-    	constraints.close();
+		if (setup_cache != NULL)
+		{ // same dofs as the pressure solver
+			computing_timer.enter_section("Setup shared scalar data");
+			setup_cache->reinit(dof_handler);
+			computing_timer.exit_section("Setup shared scalar data");
+			owned_partitioning = setup_cache->owned_partitioning();
+			relevant_partitioning = setup_cache->relevant_partitioning();
 		}
-
-		{ // system matrix
+		else
+		{
+			IndexSet locally_owned_dofs, locally_relevant_dofs;
+			locally_owned_dofs = dof_handler.locally_owned_dofs();
+	    DoFTools::extract_locally_relevant_dofs(dof_handler,
+	                                            locally_relevant_dofs);
+
+			owned_partitioning.clear();
+			relevant_partitioning.clear();
+			owned_partitioning.push_back(locally_owned_dofs);
+			relevant_partitioning.push_back(locally_relevant_dofs);
+		}
+		const IndexSet &locally_owned_dofs = owned_partitioning[0],
+		               &locally_relevant_dofs = relevant_partitioning[0];
+
+		// the subdomain system is set up when the phase field is known
+		subdomain_initialized = false;
+		subdomain_dofs.clear();
+		if (restricted())
+		{
 	    system_matrix.clear();
-	    TrilinosWrappers::BlockSparsityPattern sp(owned_partitioning,
-	                                              owned_partitioning,
-	                                              relevant_partitioning,
-	                                              mpi_communicator);
-	    DoFTools::make_sparsity_pattern(dof_handler, sp, constraints,
-	                                    /*  keep_constrained_dofs = */ false,
-	                                    Utilities::MPI::this_mpi_process(mpi_communicator));
-	    sp.compress();
-	    system_matrix.reinit(sp);
+	    subdomain_matrix.clear();
+	    subdomain_cells.clear();
+	    owned_subdomain_dofs.clear();
+	    fracture_cells.clear();
+			computing_timer.enter_section("Setup width constraints");
+			make_constraints();
+			computing_timer.exit_section("Setup width constraints");
+			subdomain_marks.reinit(locally_owned_dofs, locally_relevant_dofs,
+			                       mpi_communicator, /* writable = */ true);
+			relevant_subdomain_marks.reinit(locally_owned_dofs, locally_relevant_dofs,
+			                                mpi_communicator);
 		}
+		else
+			setup_system();
+
 		{ // vectors
 			solution.reinit(owned_partitioning, mpi_communicator);
 			relevant_solution.reinit(relevant_partitioning, mpi_communicator);
@@ -164,6 +269,354 @@ namespace PhaseField
 	}  // eom
 
 
+	template <int dim> void
+	WidthSolver<dim>::make_constraints()
+	{
+		// hanging nodes and zero width on the boundary
+		constraints.clear();
+		constraints.reinit(relevant_partitioning[0]);
+		if (setup_cache != NULL)
+		{
+			ConstraintMatrix boundary_constraints;
+			setup_cache->make_constraints(boundary_constraints, 0.0);
+			constraints.merge(boundary_constraints);
+		}
+		else
+		{
+	    DoFTools::make_hanging_node_constraints(dof_handler,
+	                                            constraints);
+	    const auto & boundary_ids = triangulation.get_boundary_ids();
+	    for (unsigned int i=0; i<boundary_ids.size(); i++)
+	      VectorTools::interpolate_boundary_values
+	        (dof_handler, boundary_ids[i],
+	         ConstantFunction<dim>(0.0, 1),
+	         constraints);
+		}
+  	constraints.close();
+	}  // eom
+
+
+	template <int dim> void
+	WidthSolver<dim>::setup_system()
+	{
+		computing_timer.enter_section("Setup width constraints");
+		make_constraints();
+		computing_timer.exit_section("Setup width constraints");
+
+		computing_timer.enter_section("Setup width sparsity");
+    system_matrix.clear();
+    if (setup_cache != NULL)
+    {
+      system_matrix.reinit(setup_cache->sparsity_pattern());
+      computing_timer.exit_section("Setup width sparsity");
+      return;
+    }
+
+    TrilinosWrappers::BlockSparsityPattern sp(owned_partitioning,
+                                              owned_partitioning,
+                                              relevant_partitioning,
+                                              mpi_communicator);
+    DoFTools::make_sparsity_pattern(dof_handler, sp, constraints,
+                                    /*  keep_constrained_dofs = */ false,
+                                    Utilities::MPI::this_mpi_process(mpi_communicator));
+    sp.compress();
+    system_matrix.reinit(sp);
+		computing_timer.exit_section("Setup width sparsity");
+	}  // eom
+
+
+  template <int dim>
+  inline bool
+  WidthSolver<dim>::restricted() const
+  {
+    return (data.width_halo_layers > 0);
+  }  // eom
+
+
+  template <int dim>
+  inline bool
+  WidthSolver<dim>::
+  cell_in_subdomain(const typename DoFHandler<dim>::active_cell_iterator &cell) const
+  {
+    // cells with a dof that is solved for
+    std::vector<types::global_dof_index> local_dof_indices(fe.dofs_per_cell);
+    cell->get_dof_indices(local_dof_indices);
+    for (unsigned int i=0; i<local_dof_indices.size(); ++i)
+      if (subdomain_dofs.is_element(local_dof_indices[i]))
+        return true;
+    return false;
+  }  // eom
+
+
+	template <int dim> bool
+	WidthSolver<dim>::
+  update_subdomain(const TrilinosWrappers::MPI::BlockVector &relevant_solution_solid)
+  {
+    /*
+      Marks are spread over dofs so that all processes agree on the
+      subdomain: layer 1 are the dofs of the fracture cells, every further
+      layer adds the dofs of the cells that touch a marked dof. The dofs
+      of the last layer are solved for; the cells touching them are
+      assembled, and the remaining dofs of these cells bound the subdomain
+      with zero width (the penalty faces of the fracture lie inside).
+      Nothing is spread unless the fracture cells have changed on some
+      process.
+     */
+    const unsigned int dofs_per_cell = fe.dofs_per_cell;
+    std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
+    const std::vector<double> ones(dofs_per_cell, 1.0);
+
+    // the fracture criterion of the assembly, phi from the cache if valid
+    const FEValuesExtractors::Scalar phase_field(dim);
+    FEValues<dim> fe_values_solid(dof_handler_solid.get_fe(), QGauss<dim>(1),
+                                  update_values);
+    std::vector<double> phi_values(1);
+    const unsigned int n_q_points = QGauss<dim>(fe.degree + 2).size();
+    const bool use_cache = (field_cache != NULL && field_cache->solid_valid() &&
+                            field_cache->n_quadrature_points() == n_q_points);
+    std::vector<double> cached_phi_values(n_q_points);
+
+    std::vector<char> new_fracture_cells(triangulation.n_active_cells(), 0);
+    typename DoFHandler<dim>::active_cell_iterator
+      cell = dof_handler.begin_active(),
+      endc = dof_handler.end();
+    for (; cell!=endc; ++cell)
+      if (cell->is_locally_owned())
+      {
+        bool in_fracture;
+        if (use_cache)
+        {
+          for (unsigned int q=0; q<n_q_points; ++q)
+            cached_phi_values[q] = field_cache->phi(cell->active_cell_index(), q);
+          in_fracture = cell_in_fracture(cached_phi_values, data.constant_level_set);
+        }
+        else
+        {
+          fe_values_solid.reinit(Assembly::same_cell(cell, dof_handler_solid));
+          fe_values_solid[phase_field].get_function_values(relevant_solution_solid,
+                                                           phi_values);
+          in_fracture = cell_in_fracture(phi_values, data.constant_level_set);
+        }
+        new_fracture_cells[cell->active_cell_index()] = in_fracture;
+      }
+
+    const bool first = !subdomain_initialized;
+    const bool changed =
+      Utilities::MPI::max((first || new_fracture_cells != fracture_cells) ? 1 : 0,
+                          mpi_communicator) == 1;
+    if (!changed)
+      return false;
+    fracture_cells.swap(new_fracture_cells);
+
+    subdomain_marks = 0;
+    for (cell = dof_handler.begin_active(); cell!=endc; ++cell)
+      if (cell->is_locally_owned() && fracture_cells[cell->active_cell_index()])
+      {
+        cell->get_dof_indices(local_dof_indices);
+        subdomain_marks.add(local_dof_indices, ones);
+      }
+    subdomain_marks.compress(VectorOperation::add);
+    relevant_subdomain_marks = subdomain_marks;
+
+    for (unsigned int layer=1; layer<data.width_halo_layers; ++layer)
+    {
+      subdomain_marks = 0;
+      for (cell = dof_handler.begin_active(); cell!=endc; ++cell)
+        if (cell->is_locally_owned())
+        {
+          cell->get_dof_indices(local_dof_indices);
+          for (unsigned int i=0; i<dofs_per_cell; ++i)
+            if (relevant_subdomain_marks(local_dof_indices[i]) > 0)
+            {
+              subdomain_marks.add(local_dof_indices, ones);
+              break;
+            }
+        }
+      subdomain_marks.compress(VectorOperation::add);
+      relevant_subdomain_marks = subdomain_marks;
+    }  // end layer loop
+
+    const IndexSet &locally_relevant_dofs = relevant_partitioning[0];
+    IndexSet new_subdomain_dofs(dof_handler.n_dofs());
+    for (IndexSet::ElementIterator it = locally_relevant_dofs.begin();
+         it != locally_relevant_dofs.end(); ++it)
+      if (relevant_subdomain_marks(*it) > 0)
+        new_subdomain_dofs.add_index(*it);
+    new_subdomain_dofs.compress();
+    subdomain_dofs = new_subdomain_dofs;
+    subdomain_initialized = true;
+
+    // values restored from a checkpoint can lie anywhere
+    if (first)
+      solution = 0;
+    return true;
+  }  // eom
+
+
+	template <int dim> void
+	WidthSolver<dim>::setup_subdomain_system()
+	{
+		/*
+		  The system has the dofs of the assembled cells and the masters of
+		  their hanging nodes. The owner of each of these dofs gives it the
+		  next number (consecutive over the processes, in the order of the
+		  ranks), and the numbers are read back through the ghost layer.
+		  The dofs that aren't in subdomain_dofs are zero in the system.
+		 */
+		computing_timer.enter_section("Setup width subdomain");
+		const unsigned int dofs_per_cell = fe.dofs_per_cell;
+		std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
+
+		// the old subdomain is zero from now on
+		for (unsigned int i=0; i<owned_subdomain_dofs.size(); ++i)
+			solution.block(0)(owned_subdomain_dofs[i]) = 0;
+		solution.compress(VectorOperation::insert);
+
+		// dofs of the system that this process knows of
+		subdomain_cells.clear();
+		std::vector<types::global_dof_index> local_dofs;
+		typename DoFHandler<dim>::active_cell_iterator
+			cell = dof_handler.begin_active(),
+			endc = dof_handler.end();
+		for (; cell!=endc; ++cell)
+			if (cell->is_locally_owned() && cell_in_subdomain(cell))
+			{
+				subdomain_cells.push_back(cell);
+				cell->get_dof_indices(local_dof_indices);
+				for (unsigned int i=0; i<dofs_per_cell; ++i)
+				{
+					local_dofs.push_back(local_dof_indices[i]);
+					if (constraints.is_constrained(local_dof_indices[i]))
+					{
+						const std::vector< std::pair<types::global_dof_index,double> >
+							&entries = *constraints.get_constraint_entries(local_dof_indices[i]);
+						for (unsigned int e=0; e<entries.size(); ++e)
+							if (subdomain_dofs.is_element(entries[e].first))
+								local_dofs.push_back(entries[e].first);
+					}
+				}
+			}
+		std::sort(local_dofs.begin(), local_dofs.end());
+		local_dofs.erase(std::unique(local_dofs.begin(), local_dofs.end()),
+		                 local_dofs.end());
+
+		subdomain_marks = 0;
+		if (local_dofs.size() > 0)
+			subdomain_marks.add(local_dofs, std::vector<double>(local_dofs.size(), 1.0));
+		subdomain_marks.compress(VectorOperation::add);
+
+		// number the owned dofs
+		owned_subdomain_dofs.clear();
+		const IndexSet &locally_owned_dofs = owned_partitioning[0];
+		for (IndexSet::ElementIterator it = locally_owned_dofs.begin();
+		     it != locally_owned_dofs.end(); ++it)
+			if (subdomain_marks(*it) > 0)
+				owned_subdomain_dofs.push_back(*it);
+
+		unsigned long long n_local = owned_subdomain_dofs.size(), offset = 0;
+		MPI_Exscan(&n_local, &offset, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM,
+		           mpi_communicator);
+		if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
+			offset = 0;
+		const unsigned long long n_total = Utilities::MPI::sum(n_local, mpi_communicator);
+
+		subdomain_marks = 0;
+		for (unsigned int i=0; i<owned_subdomain_dofs.size(); ++i)
+			subdomain_marks(owned_subdomain_dofs[i]) = offset + i + 1;
+		subdomain_marks.compress(VectorOperation::insert);
+		relevant_subdomain_marks = subdomain_marks;
+
+		subdomain_owned.clear();
+		subdomain_owned.set_size(n_total);
+		subdomain_owned.add_range(offset, offset + n_local);
+		subdomain_owned.compress();
+
+		// the owned dofs and the ones this process writes to
+		std::vector<types::global_dof_index> local_numbers(local_dofs.size());
+		for (unsigned int i=0; i<local_dofs.size(); ++i)
+			local_numbers[i] =
+				static_cast<types::global_dof_index>(relevant_subdomain_marks(local_dofs[i])) - 1;
+		std::sort(local_numbers.begin(), local_numbers.end());
+		subdomain_relevant.clear();
+		subdomain_relevant.set_size(n_total);
+		subdomain_relevant.add_indices(local_numbers.begin(), local_numbers.end());
+		subdomain_relevant.add_range(offset, offset + n_local);
+		subdomain_relevant.compress();
+
+		// hanging nodes and boundary of the whole mesh, zero outside
+		subdomain_constraints.clear();
+		subdomain_constraints.reinit(subdomain_relevant);
+		local_dofs.insert(local_dofs.end(),
+		                  owned_subdomain_dofs.begin(), owned_subdomain_dofs.end());
+		for (unsigned int i=0; i<local_dofs.size(); ++i)
+		{
+			const types::global_dof_index dof = local_dofs[i];
+			const types::global_dof_index number =
+				static_cast<types::global_dof_index>(relevant_subdomain_marks(dof)) - 1;
+			if (subdomain_constraints.is_constrained(number))
+				continue;
+			if (!subdomain_dofs.is_element(dof))
+				subdomain_constraints.add_line(number);
+			else if (constraints.is_constrained(dof))
+			{
+				subdomain_constraints.add_line(number);
+				const std::vector< std::pair<types::global_dof_index,double> >
+					&entries = *constraints.get_constraint_entries(dof);
+				for (unsigned int e=0; e<entries.size(); ++e)
+					if (subdomain_dofs.is_element(entries[e].first))
+					{
+						const double master = relevant_subdomain_marks(entries[e].first);
+						Assert(master > 0, ExcInternalError());
+						subdomain_constraints.add_entry
+							(number, static_cast<types::global_dof_index>(master) - 1,
+							 entries[e].second);
+					}
+			}
+		}
+		subdomain_constraints.close();
+
+		pcout << "Width subdomain dofs = " << n_total
+		      << " of " << dof_handler.n_dofs() << std::endl;
+		subdomain_matrix.clear();
+		if (n_total == 0)
+		{ // no fracture: zero width
+			computing_timer.exit_section("Setup width subdomain");
+			return;
+		}
+
+		TrilinosWrappers::SparsityPattern sp(subdomain_owned, subdomain_owned,
+		                                     subdomain_relevant, mpi_communicator);
+		for (unsigned int c=0; c<subdomain_cells.size(); ++c)
+		{
+			get_subdomain_dof_indices(subdomain_cells[c], local_dof_indices);
+			subdomain_constraints.add_entries_local_to_global(local_dof_indices, sp,
+			                                                  /* keep_constrained_dofs = */ false);
+		}
+		sp.compress();
+		subdomain_matrix.reinit(sp);
+		subdomain_rhs.reinit(subdomain_owned, subdomain_relevant,
+		                     mpi_communicator, /* omit-zeros=*/ true);
+		subdomain_solution.reinit(subdomain_owned, mpi_communicator);
+		computing_timer.exit_section("Setup width subdomain");
+	}  // eom
+
+
+  template <int dim>
+  inline void
+  WidthSolver<dim>::
+  get_subdomain_dof_indices(const typename DoFHandler<dim>::active_cell_iterator &cell,
+                            std::vector<types::global_dof_index>               &indices) const
+  {
+    cell->get_dof_indices(indices);
+    for (unsigned int i=0; i<indices.size(); ++i)
+    {
+      const double number = relevant_subdomain_marks(indices[i]);
+      Assert(number > 0, ExcInternalError());
+      indices[i] = static_cast<types::global_dof_index>(number) - 1;
+    }
+  }  // eom
+
+
   template <int dim>
   inline bool
   WidthSolver<dim>::
@@ -241,29 +694,153 @@ namespace PhaseField
   }  // eom
 
 
+	template <int dim>
+	WidthSolver<dim>::AssemblyScratchData::
+	AssemblyScratchData(const FiniteElement<dim> &fe,
+	                    const FiniteElement<dim> &fe_solid)
+	:
+	fe_values(fe, QGauss<dim>(fe.degree + 2),
+	          update_values | update_gradients |
+	          update_JxW_values),
+	fe_values_solid(fe_solid, QGauss<dim>(fe.degree + 2),
+	                update_values),
+	fe_values_neighbor_solid(fe_solid, QGauss<dim>(1),
+	                         update_values),
+	fe_face_values(fe, QGauss<dim-1>(fe.degree + 1),
+	               update_values | update_JxW_values),
+	fe_face_values_solid(fe_solid, QGauss<dim-1>(fe.degree + 1),
+	                     update_values | update_gradients),
+	xi(fe.dofs_per_cell),
+	grad_xi(fe.dofs_per_cell),
+	phi_values(fe_values.n_quadrature_points),
+	u_values(fe_face_values.n_quadrature_points),
+	grad_phi_values(fe_face_values.n_quadrature_points),
+	phi_values_neighbor(fe_values_neighbor_solid.n_quadrature_points)
+	{}  // eom
+
+
+	template <int dim>
+	WidthSolver<dim>::AssemblyScratchData::
+	AssemblyScratchData(const AssemblyScratchData &scratch)
+	:
+	fe_values(scratch.fe_values.get_fe(),
+	          scratch.fe_values.get_quadrature(),
+	          scratch.fe_values.get_update_flags()),
+	fe_values_solid(scratch.fe_values_solid.get_fe(),
+	                scratch.fe_values_solid.get_quadrature(),
+	                scratch.fe_values_solid.get_update_flags()),
+	fe_values_neighbor_solid(scratch.fe_values_neighbor_solid.get_fe(),
+	                         scratch.fe_values_neighbor_solid.get_quadrature(),
+	                         scratch.fe_values_neighbor_solid.get_update_flags()),
+	fe_face_values(scratch.fe_face_values.get_fe(),
+	               scratch.fe_face_values.get_quadrature(),
+	               scratch.fe_face_values.get_update_flags()),
+	fe_face_values_solid(scratch.fe_face_values_solid.get_fe(),
+	                     scratch.fe_face_values_solid.get_quadrature(),
+	                     scratch.fe_face_values_solid.get_update_flags()),
+	xi(scratch.xi),
+	grad_xi(scratch.grad_xi),
+	phi_values(scratch.phi_values),
+	u_values(scratch.u_values),
+	grad_phi_values(scratch.grad_phi_values),
+	phi_values_neighbor(scratch.phi_values_neighbor)
+	{}  // eom
+
+
 	template <int dim> void
 	WidthSolver<dim>::
   assemble_system(const TrilinosWrappers::MPI::BlockVector &relevant_solution_solid)
   {
   	computing_timer.enter_section("Assemble width system");
 
-    const auto & fe_solid = dof_handler_solid.get_fe();
+    typedef typename DoFHandler<dim>::active_cell_iterator cell_iterator;
+
+    if (restricted())
+    { // only the subdomain cells, in the subdomain numbering
+      if (update_subdomain(relevant_solution_solid))
+        setup_subdomain_system();
+      if (subdomain_matrix.m() == 0)
+      { // no fracture
+      	computing_timer.exit_section();
+        return;
+      }
+
+      subdomain_matrix = 0;
+      subdomain_rhs = 0;
+
+      typedef typename std::vector<cell_iterator>::const_iterator subdomain_iterator;
+      const std::vector<cell_iterator> &cells = subdomain_cells;
+      WorkStream::
+        run(cells.begin(), cells.end(),
+            [this, &relevant_solution_solid]
+            (const subdomain_iterator  &cell,
+             AssemblyScratchData       &scratch,
+             Assembly::CopyData        &copy_data)
+            {
+              this->local_assemble_cell(*cell, scratch, copy_data,
+                                        relevant_solution_solid);
+              this->get_subdomain_dof_indices(*cell, copy_data.local_dof_indices);
+            },
+            [this](const Assembly::CopyData &copy_data)
+            {
+              subdomain_constraints.distribute_local_to_global(copy_data.local_matrix,
+                                                               copy_data.local_rhs,
+                                                               copy_data.local_dof_indices,
+                                                               subdomain_matrix,
+                                                               subdomain_rhs);
+            },
+            AssemblyScratchData(fe, dof_handler_solid.get_fe()),
+            Assembly::CopyData(fe.dofs_per_cell));
+
+      subdomain_matrix.compress(VectorOperation::add);
+      subdomain_rhs.compress(VectorOperation::add);
+    	computing_timer.exit_section();
+      return;
+    }
+
+    system_matrix = 0;
+    rhs_vector = 0;
+
+    WorkStream::
+      run(Assembly::begin_owned(dof_handler),
+          Assembly::end_owned(dof_handler),
+          [this, &relevant_solution_solid]
+          (const cell_iterator &cell,
+           AssemblyScratchData &scratch,
+           Assembly::CopyData  &copy_data)
+          {
+            this->local_assemble_cell(cell, scratch, copy_data,
+                                      relevant_solution_solid);
+          },
+          [this](const Assembly::CopyData &copy_data)
+          {
+            constraints.distribute_local_to_global(copy_data.local_matrix,
+                                                   copy_data.local_rhs,
+                                                   copy_data.local_dof_indices,
+                                                   system_matrix, rhs_vector);
+          },
+          AssemblyScratchData(fe, dof_handler_solid.get_fe()),
+          Assembly::CopyData(fe.dofs_per_cell));
 
-    const QGauss<dim> quadrature_formula(fe.degree + 2);
-    const QGauss<dim-1> face_quadrature_formula(fe.degree + 1);
-    const QGauss<dim> quadrature_neighbor(1);
-
-    FEValues<dim>     fe_values(fe, quadrature_formula,
-                                update_values | update_gradients |
-                                update_JxW_values);
-    FEValues<dim>     fe_values_solid(fe_solid, quadrature_formula,
-                                      update_values);
-    FEValues<dim>     fe_values_neighbor_solid(fe_solid, quadrature_neighbor,
-                                               update_values);
-    FEFaceValues<dim> fe_face_values(fe, face_quadrature_formula,
-                                     update_values | update_JxW_values);
-  	FEFaceValues<dim> fe_face_values_solid(fe_solid, face_quadrature_formula,
-                                           update_values | update_gradients);
+    system_matrix.compress(VectorOperation::add);
+    rhs_vector.compress(VectorOperation::add);
+
+  	computing_timer.exit_section();
+  }  // eom
+
+
+	template <int dim> void
+	WidthSolver<dim>::
+  local_assemble_cell(const typename DoFHandler<dim>::active_cell_iterator &cell,
+                      AssemblyScratchData                      &scratch,
+                      Assembly::CopyData                       &copy_data,
+                      const TrilinosWrappers::MPI::BlockVector &relevant_solution_solid)
+  {
+    FEValues<dim>     &fe_values = scratch.fe_values;
+    FEValues<dim>     &fe_values_solid = scratch.fe_values_solid;
+    FEValues<dim>     &fe_values_neighbor_solid = scratch.fe_values_neighbor_solid;
+    FEFaceValues<dim> &fe_face_values = scratch.fe_face_values;
+  	FEFaceValues<dim> &fe_face_values_solid = scratch.fe_face_values_solid;
 
     const FEValuesExtractors::Vector displacement(0);
     const FEValuesExtractors::Scalar phase_field(dim);
@@ -271,128 +848,101 @@ namespace PhaseField
     const unsigned int dofs_per_cell = fe.dofs_per_cell;
     const unsigned int n_q_points = fe_values.n_quadrature_points;
     const unsigned int n_q_face_points = fe_face_values.n_quadrature_points;
-    const unsigned int n_q_neighbor_points =
-      fe_values_neighbor_solid.n_quadrature_points;
 
-    std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
-    FullMatrix<double>            local_matrix(dofs_per_cell, dofs_per_cell);
-    Vector<double>                local_rhs(dofs_per_cell);
-		std::vector<double>  				  xi(dofs_per_cell);
-  	std::vector< Tensor<1,dim> >  grad_xi(dofs_per_cell);
+    FullMatrix<double>            &local_matrix = copy_data.local_matrix;
+    Vector<double>                &local_rhs = copy_data.local_rhs;
+		std::vector<double>  				  &xi = scratch.xi;
+  	std::vector< Tensor<1,dim> >  &grad_xi = scratch.grad_xi;
     // fe values containers
-    std::vector<double>           phi_values(n_q_points);
-    std::vector< Tensor<1, dim> > u_values(n_q_face_points);
-    std::vector< Tensor<1,dim> >  grad_phi_values(n_q_face_points);
-    std::vector<double>           phi_values_neighbor(n_q_neighbor_points);
+    std::vector<double>           &phi_values = scratch.phi_values;
+    std::vector< Tensor<1, dim> > &u_values = scratch.u_values;
+    std::vector< Tensor<1,dim> >  &grad_phi_values = scratch.grad_phi_values;
+    std::vector<double>           &phi_values_neighbor = scratch.phi_values_neighbor;
 
-    system_matrix = 0;
-    rhs_vector = 0;
+    const typename DoFHandler<dim>::active_cell_iterator
+      cell_solid = Assembly::same_cell(cell, dof_handler_solid);
 
-    typename DoFHandler<dim>::active_cell_iterator
-      cell = dof_handler.begin_active(),
-      cell_solid = dof_handler_solid.begin_active(),
-      endc = dof_handler.end();
+    local_rhs = 0;
+    local_matrix = 0;
+    fe_values.reinit(cell);
 
-    for (; cell!=endc; ++cell, ++cell_solid)
-      if (cell->is_locally_owned())
+    for (unsigned int q=0; q<n_q_points; ++q)
+    {
+      for (unsigned int k=0; k<dofs_per_cell; ++k)
       {
-        local_rhs = 0;
-        local_matrix = 0;
-        fe_values.reinit(cell);
-
-        for (unsigned int q=0; q<n_q_points; ++q)
+        xi[k] = fe_values.shape_value(k, q);
+        grad_xi[k] = fe_values.shape_grad(k ,q);
+      }
+
+      for (unsigned int i=0; i<dofs_per_cell; ++i)
+        for (unsigned int j=0; j<dofs_per_cell; ++j)
+          local_matrix(i, j) += grad_xi[j]*grad_xi[i]*fe_values.JxW(q);
+    }  // end q_point loop
+
+    if (field_cache != NULL && field_cache->solid_valid() &&
+        field_cache->n_quadrature_points() == n_q_points)
+      for (unsigned int q=0; q<n_q_points; ++q)
+        phi_values[q] = field_cache->phi(cell->active_cell_index(), q);
+    else
+    {
+      fe_values_solid.reinit(cell_solid);
+      fe_values_solid[phase_field].get_function_values(relevant_solution_solid,
+                                                       phi_values);
+    }
+
+    // if (cell_in_fracture(cell_solid))
+    if (!cell_in_fracture(phi_values, data.constant_level_set))
+    {
+      for (unsigned int f=0; f<GeometryInfo<dim>::faces_per_cell; ++f)
+        if (cell_solid->at_boundary(f) == false)
         {
-          for (unsigned int k=0; k<dofs_per_cell; ++k)
-          {
-            xi[k] = fe_values.shape_value(k, q);
-            grad_xi[k] = fe_values.shape_grad(k ,q);
-          }
+          fe_values_neighbor_solid.reinit(cell_solid->neighbor(f));
+          fe_values_neighbor_solid[phase_field].
+            get_function_values(relevant_solution_solid,
+                                phi_values_neighbor);
 
-          for (unsigned int i=0; i<dofs_per_cell; ++i)
-            for (unsigned int j=0; j<dofs_per_cell; ++j)
-              local_matrix(i, j) += grad_xi[j]*grad_xi[i]*fe_values.JxW(q);
-        }  // end q_point loop
+          // if (cell_in_reservoir(cell->neighbor(f)))
+          if (cell_in_fracture(phi_values_neighbor, data.constant_level_set))
+          {
+            fe_face_values.reinit(cell, f);
+            fe_face_values_solid.reinit(cell_solid, f);
 
-        fe_values_solid.reinit(cell_solid);
-        fe_values_solid[phase_field].get_function_values(relevant_solution_solid,
-                                                         phi_values);
+            fe_face_values_solid[displacement].
+              get_function_values(relevant_solution_solid, u_values);
+            fe_face_values_solid[phase_field].
+              get_function_gradients(relevant_solution_solid,
+                                      grad_phi_values);
 
-        // if (cell_in_fracture(cell_solid))
-        if (!cell_in_fracture(phi_values, data.constant_level_set))
-        {
-          // pcout << "cell in fracture" << std::endl;
-          for (unsigned int f=0; f<GeometryInfo<dim>::faces_per_cell; ++f)
-            if (cell_solid->at_boundary(f) == false)
-            {
-              // pcout << "cell not at boundary" << std::endl;
-              fe_values_neighbor_solid.reinit(cell_solid->neighbor(f));
-              fe_values_neighbor_solid[phase_field].
-                get_function_values(relevant_solution_solid,
-                                    phi_values_neighbor);
-              // pcout << "got neighbor fe values" << std::endl;
-
-              // if (cell_in_reservoir(cell->neighbor(f)))
-              if (cell_in_fracture(phi_values_neighbor, data.constant_level_set))
+            for (unsigned int q=0; q<n_q_face_points; ++q)
               {
-                pcout << "on interface" << std::endl;
-                fe_face_values.reinit(cell, f);
-                fe_face_values_solid.reinit(cell_solid, f);
-
-                fe_face_values_solid[displacement].
-                  get_function_values(relevant_solution_solid, u_values);
-                fe_face_values_solid[phase_field].
-                  get_function_gradients(relevant_solution_solid,
-                                          grad_phi_values);
-                // pcout << "got face fe values" << std::endl;
-
-                for (unsigned int q=0; q<n_q_face_points; ++q)
-                  {
-                    // width at the fracture boundary
-                    double w_d =
-                      +2.0*scalar_product(u_values[q], grad_phi_values[q]);
-                    // -2.0*scalar_product(u_values[q], grad_phi_values[q]);
-                    const double grad_phi_norm = grad_phi_values[q].norm();
-                    if (grad_phi_norm > 0)
-                      w_d /= grad_phi_norm;
-                    // if (w_d != 0.0)
-                    //   {
-                    //     pcout << "cell " << cell->center() << std::endl;
-                    //     pcout << "w_d " << w_d << std::endl;
-                    //     pcout << "u " << u_values[q] << std::endl;
-                    //     pcout << "grad_phi " << grad_phi_values[q] << std::endl;
-                    //     pcout << std::endl;
-                    //   }
-
-                    const double JxW = fe_face_values.JxW(q);
-
-                    for (unsigned int k=0; k<dofs_per_cell; ++k)
-                      xi[k] = fe_values.shape_value(k, q);
-
-                    for (unsigned int i=0; i<dofs_per_cell; ++i)
-                      {
-                        for (unsigned int j=0; j<dofs_per_cell; ++j)
-                          local_matrix(i, j) +=
-                            data.penalty_theta*xi[j]*xi[i]*JxW;
-
-                        local_rhs(i) +=
-                          data.penalty_theta*w_d*xi[i]*JxW;
-                      }  // end i loop
-                  }
-                }  // end if in fracture
-            }  // end face loop
-        }  // end cell in fracture
+                // width at the fracture boundary
+                double w_d =
+                  +2.0*scalar_product(u_values[q], grad_phi_values[q]);
+                // -2.0*scalar_product(u_values[q], grad_phi_values[q]);
+                const double grad_phi_norm = grad_phi_values[q].norm();
+                if (grad_phi_norm > 0)
+                  w_d /= grad_phi_norm;
 
-        cell->get_dof_indices(local_dof_indices);
-        constraints.distribute_local_to_global(local_matrix, local_rhs,
-                                               local_dof_indices,
-                                               system_matrix, rhs_vector);
-      }  // end cell loop
-
-    system_matrix.compress(VectorOperation::add);
-    rhs_vector.compress(VectorOperation::add);
+                const double JxW = fe_face_values.JxW(q);
 
+                for (unsigned int k=0; k<dofs_per_cell; ++k)
+                  xi[k] = fe_values.shape_value(k, q);
 
-  	computing_timer.exit_section();
+                for (unsigned int i=0; i<dofs_per_cell; ++i)
+                  {
+                    for (unsigned int j=0; j<dofs_per_cell; ++j)
+                      local_matrix(i, j) +=
+                        data.penalty_theta*xi[j]*xi[i]*JxW;
+
+                    local_rhs(i) +=
+                      data.penalty_theta*w_d*xi[i]*JxW;
+                  }  // end i loop
+              }
+            }  // end if in fracture
+        }  // end face loop
+    }  // end cell in fracture
+
+    cell->get_dof_indices(copy_data.local_dof_indices);
   }  // eom
 
 
@@ -417,12 +967,12 @@ namespace PhaseField
 
 
 	template <int dim> unsigned int
-	WidthSolver<dim>::solve_system()
+	WidthSolver<dim>::solve_cg(const TrilinosWrappers::SparseMatrix &matrix,
+	                           TrilinosWrappers::MPI::Vector        &x,
+	                           const TrilinosWrappers::MPI::Vector  &rhs)
   {
-  	computing_timer.enter_section("Solve width system");
-
-  	const unsigned int max_iter = system_matrix.m();
-		double tol = 1e-10*rhs_vector.l2_norm();
+  	const unsigned int max_iter = matrix.m();
+		double tol = 1e-10*rhs.l2_norm();
     if (tol == 0.0)
       tol = 1e-10;
     pcout << "Width tolerance = " << tol << std::endl;
@@ -434,17 +984,43 @@ namespace PhaseField
     data.elliptic = true;
     data.smoother_sweeps = 2;
     data.aggregation_threshold = 0.02;
-		preconditioner.initialize(system_matrix.block(0, 0), data);
+		preconditioner.initialize(matrix, data);
+
+		solver.solve(matrix, x, rhs, preconditioner);
+		return solver_control.last_step();
+  }  // eom
 
-		solver.solve(system_matrix.block(0, 0), solution.block(0),
-								 rhs_vector.block(0), preconditioner);
 
-		constraints.distribute(solution);
+	template <int dim> unsigned int
+	WidthSolver<dim>::solve_system()
+  {
+  	computing_timer.enter_section("Solve width system");
+
+		unsigned int n_iterations = 0;
+    if (restricted())
+    {
+      if (subdomain_matrix.m() > 0)
+      {
+        n_iterations = solve_cg(subdomain_matrix, subdomain_solution, subdomain_rhs);
+        subdomain_constraints.distribute(subdomain_solution);
+      }
+      // back to the vector of the whole mesh (zero outside)
+      const types::global_dof_index first = subdomain_solution.local_range().first;
+      for (unsigned int i=0; i<owned_subdomain_dofs.size(); ++i)
+        solution.block(0)(owned_subdomain_dofs[i]) = subdomain_solution(first + i);
+      solution.compress(VectorOperation::insert);
+    }
+    else
+    {
+      n_iterations = solve_cg(system_matrix.block(0, 0), solution.block(0),
+                              rhs_vector.block(0));
+      constraints.distribute(solution);
+    }
 		// relevant_solution = solution;
 
   	computing_timer.exit_section();
 
-		return solver_control.last_step();
+		return n_iterations;
   }  // eom
 
 